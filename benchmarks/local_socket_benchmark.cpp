@@ -0,0 +1,184 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+//  Compares loopback TCP with Unix domain sockets, on a filesystem path and
+//  in the abstract namespace, through the same TcpServer and TcpClient
+//  calls: the round trip time of small messages, and the throughput of a
+//  one way stream. Pass the stream size in megabytes as the first argument
+//  (default 1024).
+//
+//      make benchmarks file=local_socket_benchmark && ./build/benchmarks/local_socket_benchmark 2048
+
+#include "../src/tcp_client.h"
+#include "../src/tcp_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int PORT = 51600;
+
+LogSettings LOG_SETTINGS;
+
+/**
+ * A transport to time: the server and client protocol, and where to listen.
+ */
+struct Transport {
+    const char* name;
+    bool local;
+    std::string path;
+};
+
+/**
+ * Read exactly N_BYTES from SOCKET into BUFF. Returns false if it closed
+ * or failed first.
+ */
+bool ReadExactly(TcpClient& socket, char* buff, const std::size_t n_bytes) {
+    std::size_t done = 0;
+    while (done < n_bytes) {
+        const int n = socket.Read(buff + done, n_bytes - done);
+        if (n <= 0)
+            return false;
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Send all N_BYTES of BUFF on SOCKET. Returns false if it failed first.
+ */
+bool SendAll(TcpClient& socket, const char* buff, const std::size_t n_bytes) {
+    std::size_t done = 0;
+    while (done < n_bytes) {
+        const int n = socket.Send(buff + done, n_bytes - done);
+        if (n <= 0)
+            return false;
+        done += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Listen on TRANSPORT, connect a client, and run SERVE with the accepted
+ * socket on a thread while CLIENT runs with the client socket. Returns
+ * CLIENT's result in milliseconds, or a negative value if setting up
+ * failed.
+ */
+template < typename Serve, typename Client >
+double Run(const Transport& transport, Serve&& serve, Client&& client) {
+    TcpServer server(transport.local ? TcpServer::InternetProtocol::local : TcpServer::InternetProtocol::v4);
+    const bool listening = (transport.local ? server.StartListening(transport.path.c_str()) : server.StartListening(PORT));
+    if (!listening) {
+        std::fprintf(stderr, "%s: listening failed: %s\n", transport.name, server.ERR_MSG().c_str());
+        return -1;
+    }
+
+    TcpClient socket(transport.local ? TcpClient::InternetProtocol::local : TcpClient::InternetProtocol::v4);
+    const bool connected = (transport.local ? socket.Connect(transport.path.c_str()) : socket.Connect(PORT));
+    if (!connected) {
+        std::fprintf(stderr, "%s: connecting failed: %s\n", transport.name, socket.ERR_MSG().c_str());
+        return -1;
+    }
+
+    TcpClient accepted(server.NextConnection());
+    std::thread thread([&]() { serve(accepted); });
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = client(socket);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    socket.Close();
+    thread.join();
+    accepted.Close();
+    server.Shutdown();
+
+    if (!ok) {
+        std::fprintf(stderr, "%s: the transfer failed\n", transport.name);
+        return -1;
+    }
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_ERROR;
+
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    const std::size_t streamBytes = megabytes << 20;
+    const std::size_t chunkBytes = 64 * 1024;
+    const std::size_t messageBytes = 64;
+    const int roundTrips = 100000;
+    const int repeat = 3;
+
+    const std::vector<Transport> transports = {
+        { "tcp loopback", false, "" },
+        { "unix path", true, "/tmp/local_socket_benchmark_" + std::to_string(getpid()) + ".sock" },
+        { "unix abstract", true, "@local_socket_benchmark_" + std::to_string(getpid()) },
+    };
+
+    std::printf("Round trips: %d of %zu bytes, stream: %zu MB in %zu KB sends, best of %d\n\n",
+        roundTrips, messageBytes, megabytes, chunkBytes / 1024, repeat);
+    std::printf("%-14s %14s %10s %14s %10s\n", "transport", "round trip us", "speedup", "stream MB/s", "speedup");
+
+    double latencyBase = 0, throughputBase = 0;
+    for (const Transport& transport : transports) {
+        double latency = 0, throughput = 0;
+        for (int i = 0; i < repeat; i++) {
+            //  Each message is echoed back before the next is sent
+            const double pingMs = Run(transport,
+                [&](TcpClient& socket) {
+                    char buff[64];
+                    while (ReadExactly(socket, buff, messageBytes) && SendAll(socket, buff, messageBytes)) {}
+                },
+                [&](TcpClient& socket) {
+                    char buff[64] = {};
+                    for (int trip = 0; trip < roundTrips; trip++) {
+                        if (!SendAll(socket, buff, messageBytes) || !ReadExactly(socket, buff, messageBytes))
+                            return false;
+                    }
+                    return true;
+                });
+
+            //  Timed until the reader has every byte and says so
+            const double streamMs = Run(transport,
+                [&](TcpClient& socket) {
+                    std::vector<char> buff(chunkBytes);
+                    std::size_t received = 0;
+                    int n;
+                    while (received < streamBytes && (n = socket.Read(buff.data(), buff.size())) > 0)
+                        received += static_cast<std::size_t>(n);
+                    SendAll(socket, "k", 1);
+                },
+                [&](TcpClient& socket) {
+                    std::vector<char> buff(chunkBytes, 'x');
+                    for (std::size_t sent = 0; sent < streamBytes; sent += chunkBytes) {
+                        if (!SendAll(socket, buff.data(), std::min(chunkBytes, streamBytes - sent)))
+                            return false;
+                    }
+                    char done;
+                    return ReadExactly(socket, &done, 1);
+                });
+
+            if (pingMs < 0 || streamMs < 0)
+                return 1;
+            const double tripUs = pingMs * 1000 / roundTrips;
+            const double megabytesPerSecond = megabytes / (streamMs / 1000);
+            if (i == 0 || tripUs < latency)
+                latency = tripUs;
+            if (i == 0 || megabytesPerSecond > throughput)
+                throughput = megabytesPerSecond;
+        }
+
+        if (latencyBase == 0) {
+            latencyBase = latency;
+            throughputBase = throughput;
+        }
+        std::printf("%-14s %14.2f %9.2fx %14.0f %9.2fx\n", transport.name,
+            latency, latencyBase / latency, throughput, throughput / throughputBase);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+//  Times the ParallelString searches on a generated log buffer from 1 to 32
+//  threads. Pass the buffer size in megabytes as the first argument (default
+//  256).
+//
+//      make benchmarks && ./build/benchmarks/parallel_string_benchmark 512
+
+#include "../src/parallel_string.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+/**
+ * Build LENGTH bytes of log lines, with "ERROR" on roughly one line in 50.
+ */
+std::string MakeLog(const std::size_t length) {
+    const char* levels[] = {"INFO", "DEBUG", "WARN"};
+    std::mt19937 random(7);
+    std::string log;
+    log.reserve(length + 128);
+    while (log.size() < length) {
+        log += "2026-10-18 13:35:30.527 |";
+        log += (random() % 50 == 0) ? "ERROR" : levels[random() % 3];
+        log += "| worker ";
+        log += std::to_string(random() % 1000);
+        log += " handled request in ";
+        log += std::to_string(random() % 100000);
+        log += " us\n";
+    }
+    log.resize(length);
+    return log;
+}
+
+/**
+ * Run BODY REPEAT times and return the best time in milliseconds.
+ */
+template < typename Body >
+double BestMilliseconds(const int repeat, Body&& body) {
+    double best = 0;
+    for (int i = 0; i < repeat; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const std::string log = MakeLog(megabytes << 20);
+    const std::string_view source(log);
+    const int repeat = 3;
+
+    std::printf("Buffer: %zu MB, hardware threads: %u\n\n", megabytes, std::thread::hardware_concurrency());
+    std::printf("%-8s %12s %12s %12s %12s %12s %12s\n",
+        "threads", "count ms", "speedup", "split ms", "speedup", "contains ms", "speedup");
+
+    double countBase = 0, splitBase = 0, containsBase = 0;
+    std::size_t expectedCount = 0, expectedLines = 0;
+    for (const std::size_t threads : {1, 2, 4, 8, 16, 32}) {
+        std::size_t counted = 0, lines = 0;
+        bool found = false;
+        const double countMs = BestMilliseconds(repeat, [&]() { counted = ParallelString::count(source, "ERROR", threads); });
+        const double splitMs = BestMilliseconds(repeat, [&]() { lines = ParallelString::split(source, '\n', threads).size(); });
+        //  Not in the buffer, so every byte is searched
+        const double containsMs = BestMilliseconds(repeat, [&]() { found = ParallelString::contains(source, "FATAL", threads); });
+
+        if (threads == 1) {
+            countBase = countMs;
+            splitBase = splitMs;
+            containsBase = containsMs;
+            expectedCount = counted;
+            expectedLines = lines;
+        }
+        if (counted != expectedCount || lines != expectedLines || found) {
+            std::fprintf(stderr, "Results differ at %zu threads\n", threads);
+            return 1;
+        }
+
+        std::printf("%-8zu %12.2f %11.2fx %12.2f %11.2fx %12.2f %11.2fx\n", threads,
+            countMs, countBase / countMs, splitMs, splitBase / splitMs, containsMs, containsBase / containsMs);
+    }
+
+    std::printf("\n%zu matches of \"ERROR\", %zu lines\n", expectedCount, expectedLines);
+    return 0;
+}
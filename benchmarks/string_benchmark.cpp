@@ -0,0 +1,324 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+//  Times the String operations against the equivalent std::string and
+//  std::string_view code, for inputs from 8 bytes to 64 MB. Every result is
+//  one CSV line on stdout:
+//
+//      benchmark,implementation,bytes,iterations,ns_per_op,bytes_per_second
+//
+//  Options:
+//      --max-bytes=N       Skip inputs larger than N bytes (default 67108864).
+//      --min-time-ms=N     Time each case for at least N ms (default 100).
+//      --filter=TEXT       Only run benchmarks whose name contains TEXT.
+//      --json              Print one JSON object per line instead of CSV.
+//
+//      make benchmarks file=string_benchmark
+//      ./build/benchmarks/string_benchmark --max-bytes=1048576 > string.csv
+
+#include "../src/string.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The benchmark options, set from the command line.
+ */
+struct Options {
+    std::size_t _maxBytes = std::size_t(64) << 20;
+    double _minTimeMs = 100;
+    std::string _filter;
+    bool _json = false;
+};
+
+Options OPTIONS;
+
+/**
+ * Stop the compiler removing work whose result is otherwise unused.
+ */
+template < typename T >
+void Escape(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief   Time BODY and print one result line. BODY is called in batches of
+ *          doubling size until one batch takes at least the minimum time, and
+ *          the last batch gives the time per call.
+ *
+ * @param name      The operation, shared by every implementation of it.
+ * @param impl      "String", "std::string" or "std::string_view".
+ * @param bytes     The input size one call processes.
+ * @param body      One operation.
+ */
+template < typename Body >
+void Run(const char* name, const char* impl, const std::size_t bytes, Body&& body) {
+    if (!OPTIONS._filter.empty() && std::string_view(name).find(OPTIONS._filter) == std::string_view::npos)
+        return;
+
+    //  Warm up, so the first batch does not pay for page faults and cold caches
+    body();
+
+    std::size_t iterations = 1;
+    double elapsedNs = 0;
+    while (true) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; i++)
+            body();
+        elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (elapsedNs >= OPTIONS._minTimeMs * 1e6 || iterations >= (std::size_t(1) << 30))
+            break;
+        //  Jump straight to roughly the right batch size once a batch is measurable
+        const double scale = elapsedNs > 1e5 ? OPTIONS._minTimeMs * 1e6 / elapsedNs * 1.2 : 10;
+        iterations = static_cast<std::size_t>(iterations * std::max(2.0, std::min(scale, 100.0)));
+    }
+
+    const double nsPerOp = elapsedNs / iterations;
+    const double bytesPerSecond = bytes / nsPerOp * 1e9;
+    const char* line = OPTIONS._json
+        ? "{\"benchmark\":\"%s\",\"implementation\":\"%s\",\"bytes\":%zu,\"iterations\":%zu,"
+          "\"ns_per_op\":%.2f,\"bytes_per_second\":%.0f}\n"
+        : "%s,%s,%zu,%zu,%.2f,%.0f\n";
+    std::printf(line, name, impl, bytes, iterations, nsPerOp, bytesPerSecond);
+    std::fflush(stdout);
+}
+
+/**
+ * Build LENGTH bytes of comma separated words on short lines, with padding
+ * at both ends for the trim benchmarks.
+ */
+std::string MakeText(const std::size_t length) {
+    const char* words[] = {"alpha", "Bravo", "charlie", "DELTA", "echo", "foxtrot", "Golf", "hotel"};
+    std::string text = "  \t";
+    std::size_t word = 0;
+    while (text.size() < length) {
+        text += words[word % 8];
+        text += (++word % 6 == 0) ? "\n" : ", ";
+    }
+    text.resize(length);
+    if (length >= 8) {
+        text[length - 2] = ' ';
+        text[length - 1] = '\n';
+    }
+    return text;
+}
+
+/**
+ * Split SOURCE on DELIM into std::strings, as String::split does.
+ */
+std::vector<std::string> SplitStrings(const std::string& source, const std::string_view delim) {
+    std::vector<std::string> output;
+    std::size_t start = 0;
+    std::size_t p = 0;
+    while ((p = source.find(delim, start)) != std::string::npos) {
+        output.emplace_back(source, start, p - start);
+        start = p + delim.size();
+    }
+    output.emplace_back(source, start);
+    return output;
+}
+
+/**
+ * Split SOURCE on DELIM into views, without copying.
+ */
+std::vector<std::string_view> SplitViews(const std::string_view source, const std::string_view delim) {
+    std::vector<std::string_view> output;
+    std::size_t start = 0;
+    std::size_t p = 0;
+    while ((p = source.find(delim, start)) != std::string_view::npos) {
+        output.push_back(source.substr(start, p - start));
+        start = p + delim.size();
+    }
+    output.push_back(source.substr(start));
+    return output;
+}
+
+/**
+ * Replace every A in SOURCE with B into a new std::string.
+ */
+std::string ReplaceAll(const std::string& source, const std::string_view a, const std::string_view b) {
+    std::string output;
+    output.reserve(source.size());
+    std::size_t start = 0;
+    std::size_t p = 0;
+    while ((p = source.find(a, start)) != std::string::npos) {
+        output.append(source, start, p - start);
+        output.append(b);
+        start = p + a.size();
+    }
+    output.append(source, start);
+    return output;
+}
+
+/**
+ * Run every size dependent benchmark on BYTES of text.
+ */
+void RunSized(const std::size_t bytes) {
+    const std::string text = MakeText(bytes);
+    const String string(text);
+    const std::string_view view(text);
+    const std::string half(text, 0, bytes / 2);
+    const String halfString(half);
+
+    //  #################### Construction and copies ####################
+
+    Run("construct", "String", bytes, [&]() { String s(text.data(), text.size()); Escape(s); });
+    Run("construct", "std::string", bytes, [&]() { std::string s(text.data(), text.size()); Escape(s); });
+
+    Run("copy", "String", bytes, [&]() { String s(string); Escape(s); });
+    Run("copy", "std::string", bytes, [&]() { std::string s(text); Escape(s); });
+
+    //  One op is a move there and back
+    {
+        String a(string), b;
+        Run("move", "String", bytes, [&]() { b = std::move(a); a = std::move(b); Escape(a); });
+        std::string c(text), d;
+        Run("move", "std::string", bytes, [&]() { d = std::move(c); c = std::move(d); Escape(c); });
+    }
+
+    Run("plus", "String", bytes, [&]() { String s = halfString + halfString; Escape(s); });
+    Run("plus", "std::string", bytes, [&]() { std::string s = half + half; Escape(s); });
+
+    //  Built from 8 byte pieces
+    const std::string piece = text.substr(0, std::min<std::size_t>(8, bytes));
+    Run("plus_equals", "String", bytes, [&]() {
+        String s;
+        for (std::size_t n = 0; n < bytes; n += piece.size()) s += piece.c_str();
+        Escape(s);
+    });
+    Run("plus_equals", "std::string", bytes, [&]() {
+        std::string s;
+        for (std::size_t n = 0; n < bytes; n += piece.size()) s += piece;
+        Escape(s);
+    });
+
+    //  #################### split ####################
+
+    Run("split_char", "String", bytes, [&]() { auto parts = string.split('\n'); Escape(parts); });
+    Run("split_char", "std::string", bytes, [&]() { auto parts = SplitStrings(text, "\n"); Escape(parts); });
+    Run("split_char", "std::string_view", bytes, [&]() { auto parts = SplitViews(view, "\n"); Escape(parts); });
+
+    Run("split_string", "String", bytes, [&]() { auto parts = string.split(", "); Escape(parts); });
+    Run("split_string", "std::string", bytes, [&]() { auto parts = SplitStrings(text, ", "); Escape(parts); });
+    Run("split_string", "std::string_view", bytes, [&]() { auto parts = SplitViews(view, ", "); Escape(parts); });
+
+    //  #################### replace ####################
+
+    Run("replace_char_char", "String", bytes, [&]() { String s = string.replace(',', ';'); Escape(s); });
+    Run("replace_char_char", "std::string", bytes, [&]() {
+        std::string s(text);
+        std::replace(s.begin(), s.end(), ',', ';');
+        Escape(s);
+    });
+
+    Run("replace_cstr_cstr", "String", bytes, [&]() { String s = string.replace("echo", "ECHO!"); Escape(s); });
+    Run("replace_stdstr_stdstr", "String", bytes, [&]() {
+        String s = string.replace(std::string("echo"), std::string("ECHO!"));
+        Escape(s);
+    });
+    Run("replace_cstr_cstr", "std::string", bytes, [&]() { std::string s = ReplaceAll(text, "echo", "ECHO!"); Escape(s); });
+
+    Run("replace_cstr_char", "String", bytes, [&]() { String s = string.replace(", ", ';'); Escape(s); });
+    Run("replace_stdstr_char", "String", bytes, [&]() { String s = string.replace(std::string(", "), ';'); Escape(s); });
+    Run("replace_cstr_char", "std::string", bytes, [&]() { std::string s = ReplaceAll(text, ", ", ";"); Escape(s); });
+
+    Run("replace_char_cstr", "String", bytes, [&]() { String s = string.replace('\n', "\r\n"); Escape(s); });
+    Run("replace_char_stdstr", "String", bytes, [&]() { String s = string.replace('\n', std::string("\r\n")); Escape(s); });
+    Run("replace_char_cstr", "std::string", bytes, [&]() { std::string s = ReplaceAll(text, "\n", "\r\n"); Escape(s); });
+
+    //  #################### trim and case conversion ####################
+
+    Run("trim", "String", bytes, [&]() { String s = string.trim(); Escape(s); });
+    Run("trim", "std::string", bytes, [&]() {
+        const std::size_t first = view.find_first_not_of(" \n\r\t\f\v");
+        const std::size_t last = view.find_last_not_of(" \n\r\t\f\v");
+        std::string s = first == std::string_view::npos ? std::string() : std::string(view.substr(first, last - first + 1));
+        Escape(s);
+    });
+    Run("trim", "std::string_view", bytes, [&]() {
+        std::string_view v = view;
+        v.remove_prefix(std::min(v.find_first_not_of(" \n\r\t\f\v"), v.size()));
+        const std::size_t last = v.find_last_not_of(" \n\r\t\f\v");
+        v = v.substr(0, last == std::string_view::npos ? 0 : last + 1);
+        Escape(v);
+    });
+
+    Run("to_lower", "String", bytes, [&]() { String s = string.to_lower(); Escape(s); });
+    Run("to_lower", "std::string", bytes, [&]() {
+        std::string s(text);
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        Escape(s);
+    });
+
+    Run("to_upper", "String", bytes, [&]() { String s = string.to_upper(); Escape(s); });
+    Run("to_upper", "std::string", bytes, [&]() {
+        std::string s(text);
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        Escape(s);
+    });
+}
+
+/**
+ * Run the numeric parsing benchmarks, which work on one short number.
+ */
+void RunNumeric() {
+    const std::string integer = "1234567";
+    const std::string decimal = "3.14159265";
+    const String integerString(integer);
+    const String decimalString(decimal);
+
+    Run("parse_int", "String", integer.size(), [&]() { int v = integerString.to_int(); Escape(v); });
+    Run("parse_int_no_throw", "String", integer.size(), [&]() { auto v = integerString.try_to_int(); Escape(v); });
+    Run("parse_int", "std::string", integer.size(), [&]() { int v = std::stoi(integer); Escape(v); });
+    Run("parse_int_no_throw", "std::string_view", integer.size(), [&]() {
+        int v = 0;
+        std::from_chars(integer.data(), integer.data() + integer.size(), v);
+        Escape(v);
+    });
+
+    Run("parse_double", "String", decimal.size(), [&]() { double v = decimalString.to_double(); Escape(v); });
+    Run("parse_double_no_throw", "String", decimal.size(), [&]() { auto v = decimalString.try_to_double(); Escape(v); });
+    Run("parse_double", "std::string", decimal.size(), [&]() { double v = std::stod(decimal); Escape(v); });
+    Run("parse_double_no_throw", "std::string_view", decimal.size(), [&]() {
+        double v = 0;
+        std::from_chars(decimal.data(), decimal.data() + decimal.size(), v);
+        Escape(v);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg(argv[i]);
+        if (arg.rfind("--max-bytes=", 0) == 0)
+            OPTIONS._maxBytes = std::strtoull(argv[i] + 12, nullptr, 10);
+        else if (arg.rfind("--min-time-ms=", 0) == 0)
+            OPTIONS._minTimeMs = std::strtod(argv[i] + 14, nullptr);
+        else if (arg.rfind("--filter=", 0) == 0)
+            OPTIONS._filter = std::string(arg.substr(9));
+        else if (arg == "--json")
+            OPTIONS._json = true;
+        else {
+            std::fprintf(stderr, "Usage: %s [--max-bytes=N] [--min-time-ms=N] [--filter=TEXT] [--json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!OPTIONS._json)
+        std::printf("benchmark,implementation,bytes,iterations,ns_per_op,bytes_per_second\n");
+
+    RunNumeric();
+    for (const std::size_t bytes : {8, 64, 512, 4 << 10, 32 << 10, 256 << 10, 2 << 20, 16 << 20, 64 << 20}) {
+        if (bytes <= OPTIONS._maxBytes)
+            RunSized(bytes);
+    }
+
+    return 0;
+}
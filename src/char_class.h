@@ -0,0 +1,143 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_CHAR_CLASS_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_CHAR_CLASS_H__
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * A set of allowed byte values, built at compile time from a predicate, for
+ * checking that a whole buffer only holds allowed characters, such as HTTP
+ * tokens or header field values:
+ *
+ *     constexpr CharClass Digits([](char c) { return c >= '0' && c <= '9'; });
+ *     bool ok = Digits.all_of(data, length);
+ *
+ * The predicate is expanded into a 256 entry lookup table. If the allowed
+ * bytes form at most MAX_RANGES contiguous ranges, the ranges are also kept
+ * and checked 16 bytes at a time with SSE2, so the common sets (such as
+ * field values: tab, 0x20..0x7E and 0x80..0xFF) validate at memory
+ * bandwidth. Other sets use the lookup table one byte at a time.
+ */
+class CharClass {
+public:
+
+    /**
+     * The most ranges checked with SSE2. Every extra range costs three
+     * instructions per 16 bytes.
+     */
+    static constexpr std::size_t MAX_RANGES = 4;
+
+private:
+
+    bool _table[256] = {};
+    unsigned char _low[MAX_RANGES] = {};
+    unsigned char _span[MAX_RANGES] = {};
+    std::size_t _rangeCount = 0;
+    bool _useRanges = false;
+
+    /**
+     * Returns the offset of the first byte from I not in this class, using
+     * the lookup table.
+     */
+    std::size_t FindWithTable(const char* data, std::size_t i, const std::size_t length) const noexcept {
+        for (; i < length; i++) {
+            if (!_table[static_cast<unsigned char>(data[i])])
+                return i;
+        }
+        return length;
+    }
+
+public:
+
+    /**
+     * @brief   Build the class from PREDICATE, called once for every char
+     *          value. Intended for constexpr construction.
+     *
+     * @tparam Predicate    A constexpr callable taking a char and returning
+     *                      true if it is allowed.
+     * @param predicate     The predicate.
+     */
+    template < typename Predicate >
+    constexpr explicit CharClass(Predicate predicate) {
+        std::size_t ranges = 0;
+        for (int b = 0; b < 256; b++) {
+            _table[b] = predicate(static_cast<char>(b));
+            if (_table[b] && (b == 0 || !_table[b - 1])) {
+                if (ranges < MAX_RANGES)
+                    _low[ranges] = static_cast<unsigned char>(b);
+                ranges++;
+            }
+            if (_table[b] && ranges <= MAX_RANGES)
+                _span[ranges - 1] = static_cast<unsigned char>(b - _low[ranges - 1]);
+        }
+        _useRanges = ranges <= MAX_RANGES;
+        _rangeCount = _useRanges ? ranges : 0;
+    }
+
+    /**
+     * Returns true if C is in this class.
+     */
+    constexpr bool contains(const char c) const noexcept {
+        return _table[static_cast<unsigned char>(c)];
+    }
+
+    /**
+     * Returns true if the allowed bytes are checked as ranges with SSE2,
+     * rather than through the lookup table.
+     */
+    constexpr bool uses_ranges() const noexcept { return _useRanges; }
+
+    /**
+     * @brief   Find the first byte in LENGTH bytes at DATA that is not in
+     *          this class.
+     *
+     * @param data      The bytes to check.
+     * @param length    The number of bytes to check.
+     * @return          The offset of the first byte not in this class, or
+     *                  LENGTH if every byte is.
+     */
+    std::size_t find_first_not_of(const char* data, const std::size_t length) const noexcept {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        if (_useRanges) {
+            __m128i low[MAX_RANGES];
+            __m128i span[MAX_RANGES];
+            for (std::size_t r = 0; r < _rangeCount; r++) {
+                low[r] = _mm_set1_epi8(static_cast<char>(_low[r]));
+                span[r] = _mm_set1_epi8(static_cast<char>(_span[r]));
+            }
+
+            for (; i + 16 <= length; i += 16) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                __m128i allowed = _mm_setzero_si128();
+                for (std::size_t r = 0; r < _rangeCount; r++) {
+                    //  Unsigned LOW <= b <= LOW + SPAN as (b - LOW) <= SPAN, with wrap-around
+                    const __m128i offset = _mm_sub_epi8(block, low[r]);
+                    allowed = _mm_or_si128(allowed, _mm_cmpeq_epi8(_mm_min_epu8(offset, span[r]), offset));
+                }
+                const int mask = _mm_movemask_epi8(allowed);
+                if (mask != 0xFFFF)
+                    return i + static_cast<std::size_t>(__builtin_ctz(~mask & 0xFFFF));
+            }
+        }
+#endif
+        return FindWithTable(data, i, length);
+    }
+
+    /**
+     * Returns true if every one of LENGTH bytes at DATA is in this class.
+     */
+    bool all_of(const char* data, const std::size_t length) const noexcept {
+        return find_first_not_of(data, length) == length;
+    }
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_CHAR_CLASS_H__
@@ -14,6 +14,7 @@
 
 #include "log.h"
 #include "cpp_utilities.h"
+#include "stream_tokenizer.h"
 
 /**
  * The Parser Option class is used to quickly define CLI argument
@@ -805,16 +806,14 @@ private:
                 std::stringstream ossRestructuredEntry;
 
                 //  Split the current string out with space as a delimiter
-                std::stringstream currOptSs(currentOptionEntry);
-                std::vector<std::string> currOptArray;
-                std::string currOptStr;
-                while (std::getline(currOptSs, currOptStr, ' ')) {
-                    currOptArray.push_back(currOptStr);
-                }
+                StreamTokenizer currOptWords(" ");
+                currOptWords.feed(currentOptionEntry);
+                currOptWords.finish();
 
-                //  Go to add the string array entries to the new string stream
+                //  Go to add the words to the new string stream
                 int timesReachedLength = 1;
-                for (std::string str : currOptArray) {
+                std::string_view str;
+                while (currOptWords.next(str)) {
 
                     //  If this array entry length plus existing string length 
                     //  is greater than the maximum width allowed...
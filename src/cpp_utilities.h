@@ -11,6 +11,8 @@
 #include <vector>
 #include <chrono>
 
+#include "string.h"
+
 #pragma GCC diagnostic ignored "-Wunused-function"
 
 /**
@@ -62,11 +64,9 @@ static std::string CurrentProgramRunningTime() {
     auto us = std::chrono::duration_cast<std::chrono::microseconds>(__END - __START).count();
     auto s = us / 1000000.0;
     auto ms = us / 1000.0;
-    std::stringstream output;
-    output << "Current running time: " << us << " Microseconds ("
-        << (s < 1.0 ? std::to_string(ms) + " milliseconds" : std::to_string(s) + " seconds")
-        << ")";
-    return output.str();
+    if (s < 1.0)
+        return String::format("Current running time: {} Microseconds ({:.6} milliseconds)", us, ms);
+    return String::format("Current running time: {} Microseconds ({:.6} seconds)", us, s);
 }
 
 /**
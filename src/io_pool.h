@@ -0,0 +1,311 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_IO_POOL_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_IO_POOL_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+class BufferPool;
+
+/**
+ * A fixed-size I/O buffer leased from a BufferPool. Move-only; the buffer
+ * goes back to its pool when the lease is destroyed or 'release' is called,
+ * for the next connection to reuse. A default constructed lease is empty.
+ */
+class IoBuffer {
+private:
+
+    friend class BufferPool;
+
+    BufferPool* _pool = nullptr;
+    char* _data = nullptr;
+    std::size_t _size = 0;
+
+    IoBuffer(BufferPool* pool, char* data, const std::size_t size) noexcept :
+        _pool(pool), _data(data), _size(size) {}
+
+public:
+
+    /**
+     * Construct an empty lease.
+     */
+    IoBuffer() = default;
+
+    IoBuffer(const IoBuffer&) = delete;
+    IoBuffer& operator = (const IoBuffer&) = delete;
+
+    IoBuffer(IoBuffer&& other) noexcept :
+        _pool(other._pool), _data(other._data), _size(other._size) {
+        other._pool = nullptr;
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    IoBuffer& operator = (IoBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            _pool = other._pool;
+            _data = other._data;
+            _size = other._size;
+            other._pool = nullptr;
+            other._data = nullptr;
+            other._size = 0;
+        }
+        return *this;
+    }
+
+    /**
+     * Return the buffer to its pool.
+     */
+    ~IoBuffer() { release(); }
+
+    /**
+     * Returns the start of the buffer, or null if the lease is empty.
+     */
+    char* data() const noexcept { return _data; }
+
+    /**
+     * Returns the size of the buffer, which is its pool's size class and so
+     * may be more than was asked for.
+     */
+    std::size_t size() const noexcept { return _size; }
+
+    /**
+     * Returns true if this lease holds no buffer.
+     */
+    bool empty() const noexcept { return _data == nullptr; }
+
+    /**
+     * Returns true if this lease holds a buffer.
+     */
+    explicit operator bool() const noexcept { return _data != nullptr; }
+
+    /**
+     * Return the buffer to its pool now, leaving this lease empty.
+     */
+    inline void release() noexcept;
+};
+
+/**
+ * A slab allocator of fixed-size I/O buffers in three size classes: 4, 16
+ * and 64 KB. Buffers are carved out of page-aligned 256 KB slabs and kept on
+ * a free list per class when returned, so once a server has leased as many
+ * buffers as it has busy connections, serving more requests allocates
+ * nothing:
+ *
+ *     IoBuffer buff = BufferPool::Global().lease(16 * 1024);
+ *     int n = client.Read(buff.data(), buff.size());
+ *
+ * Slabs are only freed with the pool. Each size class has its own lock, so
+ * a pool can be shared between threads.
+ */
+class BufferPool {
+public:
+
+    static constexpr std::size_t SMALL_BUFFER_SIZE = 4 * 1024;
+    static constexpr std::size_t MEDIUM_BUFFER_SIZE = 16 * 1024;
+    static constexpr std::size_t LARGE_BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * The size of each slab buffers are carved from.
+     */
+    static constexpr std::size_t SLAB_SIZE = 256 * 1024;
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator = (const BufferPool&) = delete;
+
+    /**
+     * Returns the process-wide pool used by the networking classes.
+     */
+    static BufferPool& Global() {
+        static BufferPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief   Lease a buffer of at least MINIMUM_SIZE bytes, from the
+     *          smallest size class it fits.
+     *
+     * @throw invalid_argument if MINIMUM_SIZE is more than
+     *                         'LARGE_BUFFER_SIZE'.
+     */
+    IoBuffer lease(const std::size_t minimumSize) {
+        SizeClass& sizeClass = ClassFor(minimumSize);
+        std::lock_guard<std::mutex> lock(sizeClass._mutex);
+        if (sizeClass._free.empty())
+            Grow(sizeClass);
+        char* data = sizeClass._free.back();
+        sizeClass._free.pop_back();
+        return IoBuffer(this, data, sizeClass._size);
+    }
+
+    /**
+     * Carve enough slabs up front for COUNT buffers of the size class that
+     * fits SIZE to be leased at once, so the first requests do not allocate
+     * either.
+     */
+    void reserve(const std::size_t size, const std::size_t count) {
+        SizeClass& sizeClass = ClassFor(size);
+        std::lock_guard<std::mutex> lock(sizeClass._mutex);
+        while (sizeClass._slabs.size() * (SLAB_SIZE / sizeClass._size) < count)
+            Grow(sizeClass);
+    }
+
+    /**
+     * Returns the number of slabs allocated for all size classes.
+     */
+    std::size_t slab_count() {
+        std::size_t count = 0;
+        for (SizeClass& sizeClass : _classes) {
+            std::lock_guard<std::mutex> lock(sizeClass._mutex);
+            count += sizeClass._slabs.size();
+        }
+        return count;
+    }
+
+    /**
+     * Returns the number of buffers not leased in the size class that fits
+     * SIZE.
+     */
+    std::size_t free_count(const std::size_t size) {
+        SizeClass& sizeClass = ClassFor(size);
+        std::lock_guard<std::mutex> lock(sizeClass._mutex);
+        return sizeClass._free.size();
+    }
+
+private:
+
+    friend class IoBuffer;
+
+    struct SlabDeleter {
+        void operator () (char* slab) const noexcept { std::free(slab); }
+    };
+
+    struct SizeClass {
+        std::size_t _size;
+        std::mutex _mutex;
+        std::vector<char*> _free;
+        std::vector<std::unique_ptr<char, SlabDeleter>> _slabs;
+    };
+
+    std::array<SizeClass, 3> _classes = { { { SMALL_BUFFER_SIZE, {}, {}, {} },
+                                            { MEDIUM_BUFFER_SIZE, {}, {}, {} },
+                                            { LARGE_BUFFER_SIZE, {}, {}, {} } } };
+
+    SizeClass& ClassFor(const std::size_t size) {
+        for (SizeClass& sizeClass : _classes) {
+            if (size <= sizeClass._size)
+                return sizeClass;
+        }
+        throw std::invalid_argument("BufferPool buffers are at most 64 KB");
+    }
+
+    /**
+     * Allocate a slab for SIZE_CLASS and put its buffers on the free list.
+     * The class's lock must be held.
+     */
+    static void Grow(SizeClass& sizeClass) {
+        char* slab = static_cast<char*>(std::aligned_alloc(4096, SLAB_SIZE));
+        if (slab == nullptr)
+            throw std::bad_alloc();
+        sizeClass._slabs.emplace_back(slab);
+        for (std::size_t offset = SLAB_SIZE; offset >= sizeClass._size; offset -= sizeClass._size)
+            sizeClass._free.push_back(slab + offset - sizeClass._size);
+    }
+
+    void Return(char* data, const std::size_t size) noexcept {
+        SizeClass& sizeClass = ClassFor(size);
+        std::lock_guard<std::mutex> lock(sizeClass._mutex);
+        sizeClass._free.push_back(data);
+    }
+};
+
+void IoBuffer::release() noexcept {
+    if (_pool != nullptr)
+        _pool->Return(_data, _size);
+    _pool = nullptr;
+    _data = nullptr;
+    _size = 0;
+}
+
+/**
+ * A pool of reusable objects, such as per-connection state, so a server
+ * that has reached its busy size stops allocating one per connection.
+ * Objects are made by a factory the first time and kept when released,
+ * up to a limit, for 'acquire' to hand out again. The caller resets an
+ * object's state when it reuses it.
+ *
+ * Not thread-safe: give each thread or event loop its own pool.
+ */
+template<typename T>
+class ObjectPool {
+public:
+
+    /**
+     * Makes a new object for the pool.
+     */
+    using Factory = std::function<T*()>;
+
+    /**
+     * @brief   Construct a pool.
+     *
+     * @param factory   Makes an object when none are free.
+     * @param maxFree   The most released objects kept for reuse, beyond
+     *                  which they are deleted.
+     */
+    explicit ObjectPool(Factory factory, const std::size_t maxFree = 65536) :
+        _factory(std::move(factory)), _maxFree(maxFree) {}
+
+    /**
+     * Returns a free object, or a new one from the factory if there are none.
+     */
+    std::unique_ptr<T> acquire() {
+        if (_free.empty()) {
+            _created++;
+            return std::unique_ptr<T>(_factory());
+        }
+        std::unique_ptr<T> object = std::move(_free.back());
+        _free.pop_back();
+        return object;
+    }
+
+    /**
+     * Keep OBJECT for reuse, or delete it if the pool already holds as many
+     * free objects as it may.
+     */
+    void release(std::unique_ptr<T> object) {
+        if (object && _free.size() < _maxFree)
+            _free.push_back(std::move(object));
+    }
+
+    /**
+     * Returns the number of objects kept for reuse.
+     */
+    std::size_t free_count() const noexcept { return _free.size(); }
+
+    /**
+     * Returns the number of objects the factory has made.
+     */
+    std::size_t created_count() const noexcept { return _created; }
+
+private:
+
+    Factory _factory;
+    std::size_t _maxFree;
+    std::size_t _created = 0;
+    std::vector<std::unique_ptr<T>> _free;
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_IO_POOL_H__
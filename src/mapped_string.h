@@ -0,0 +1,432 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_MAPPED_STRING_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_MAPPED_STRING_H__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log.h"
+#include "string.h"
+
+/**
+ * A read-only view of a whole file, mapped into memory with 'mmap' rather
+ * than read into a buffer, with the search, split and trim functions of the
+ * String class. Nothing is copied: pages are read in by the kernel as they
+ * are touched and can be dropped again under memory pressure, so searching
+ * a multi-GB log or CSV file needs almost no memory of its own. Substrings
+ * are returned as std::string_view objects into the mapping, so they are
+ * only valid while the MappedString is open.
+ *
+ * The mapping is not null-terminated, use 'size()' or 'view()' rather than
+ * treating 'data()' as a C string. Use 'to_string()' to copy a range into a
+ * String when one is needed.
+ *
+ * __errno and __errmsg are local private variables that are set upon error, and
+ * can be accessed using ERR_NO() and ERR_MSG() functions. Error codes follow
+ * the pattern YYXXX of the TCP classes, where YY is a custom code and XXX is
+ * the 'errno' value:
+ * - 20XXX   The file could not be opened.
+ * - 21XXX   The file size could not be read.
+ * - 22XXX   The file could not be mapped.
+ */
+class MappedString {
+public:
+    /**
+     * The expected access pattern, passed to 'madvise' so the kernel can
+     * read ahead (and drop pages behind) accordingly.
+     */
+    enum AccessPattern : uint8_t { normal, sequential, random, willNeed };
+
+    using const_iterator = String::const_iterator;
+
+    /**
+     * Construct a MappedString with nothing mapped.
+     */
+    MappedString() {
+        __errno = 0;
+        __errmsg = "";
+    }
+
+    /**
+     * Construct a MappedString and map the file at PATH, see 'Open'. Check
+     * ERR_NO() or 'IsOpen()' for success.
+     */
+    explicit MappedString(const std::string& path, const AccessPattern access = AccessPattern::sequential) {
+        __errno = 0;
+        __errmsg = "";
+        Open(path, access);
+    }
+
+    MappedString(const MappedString&) = delete;
+    MappedString& operator = (const MappedString&) = delete;
+
+    /**
+     * The move constructor. SOURCE is left closed.
+     */
+    MappedString(MappedString&& source) noexcept :
+        _data(source._data), _length(source._length), _mapped(source._mapped),
+        __errmsg(std::move(source.__errmsg)), __errno(source.__errno) {
+        source._data = nullptr;
+        source._length = 0;
+        source._mapped = false;
+    }
+
+    /**
+     * The move assignment operator. Closes this mapping and takes over the
+     * one held by RHS, which is left closed.
+     */
+    MappedString& operator = (MappedString&& rhs) noexcept {
+        if (this == &rhs)
+            return *this;
+        Close();
+        std::swap(_data, rhs._data);
+        std::swap(_length, rhs._length);
+        std::swap(_mapped, rhs._mapped);
+        __errmsg = std::move(rhs.__errmsg);
+        __errno = rhs.__errno;
+        return *this;
+    }
+
+    /**
+     * Destroy the MappedString object and unmap the file.
+     */
+    ~MappedString() { Close(); }
+
+    //  ######################### Mapping ##########################
+    //  ##############################################################
+
+    /**
+     * @brief   Map the whole file at PATH read-only, closing any file that
+     *          is already mapped. The file descriptor is closed as soon as
+     *          the file is mapped. An empty file maps to an empty view. Sets
+     *          __errmsg and __errno on error.
+     *
+     * @param path      The path of the file to map.
+     * @param access    The expected access pattern, see 'Advise'.
+     * @return true     if the file was mapped,
+     * @return false    otherwise.
+     */
+    bool Open(const std::string& path, const AccessPattern access = AccessPattern::sequential) {
+        __errno = 0;
+        __errmsg = "";
+        Close();
+
+        llog << "Mapping file " << path << "...";
+
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            __errno = 20000 + errno;
+
+            std::stringstream msg;
+            msg << "Failed to open file for mapping: " << path << ". ERROR CODE: " << __errno << ".";
+            __errmsg = msg.str();
+            elog << __errmsg;
+
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) < 0) {
+            __errno = 21000 + errno;
+            close(fd);
+
+            std::stringstream msg;
+            msg << "Failed to read the size of file: " << path << ". ERROR CODE: " << __errno << ".";
+            __errmsg = msg.str();
+            elog << __errmsg;
+
+            return false;
+        }
+
+        _length = static_cast<std::size_t>(info.st_size);
+        if (_length == 0) {
+            //  mmap rejects a zero length, an empty file is just an empty view
+            close(fd);
+            _data = "";
+            return true;
+        }
+
+        void* mapping = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            __errno = 22000 + errno;
+            _length = 0;
+
+            std::stringstream msg;
+            msg << "Failed to map file: " << path << ". ERROR CODE: " << __errno << ".";
+            __errmsg = msg.str();
+            elog << __errmsg;
+
+            return false;
+        }
+
+        _data = static_cast<const char*>(mapping);
+        _mapped = true;
+        Advise(access);
+
+        llog << "Mapped " << _length << " bytes from " << path << ".";
+        return true;
+    }
+
+    /**
+     * Unmap the file, if one is mapped. Views returned from this object are
+     * invalid afterwards.
+     */
+    void Close() {
+        if (_mapped) {
+            dlog << "Unmapping " << _length << " bytes...";
+            munmap(const_cast<char*>(_data), _length);
+        }
+        _data = nullptr;
+        _length = 0;
+        _mapped = false;
+    }
+
+    /**
+     * Tell the kernel how the mapping will be read. 'sequential' reads ahead
+     * aggressively and frees pages soon after they are read, which suits a
+     * single pass over a large file. Returns false if 'madvise' failed,
+     * which only loses the hint.
+     */
+    bool Advise(const AccessPattern access) {
+        if (!_mapped)
+            return true;
+        const int advice = (access == AccessPattern::sequential ? MADV_SEQUENTIAL :
+                            access == AccessPattern::random ? MADV_RANDOM :
+                            access == AccessPattern::willNeed ? MADV_WILLNEED : MADV_NORMAL);
+        if (madvise(const_cast<char*>(_data), _length, advice) != 0) {
+            wlog << "madvise failed: " << errno << ".";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Returns true if a file is open, including an empty file.
+     */
+    bool IsOpen() const { return _data != nullptr; }
+
+    std::string ERR_MSG() { return __errmsg; }
+    int ERR_NO() { return __errno; }
+
+    //  ###################### Access functions ######################
+    //  ##############################################################
+
+    /**
+     * Return the mapped chars. Not null-terminated.
+     */
+    const char* data() const { return _data != nullptr ? _data : ""; }
+
+    /**
+     * Return the number of mapped chars, the size of the file.
+     */
+    std::size_t size() const { return _length; }
+
+    /**
+     * Return the number of mapped chars, the size of the file.
+     */
+    std::size_t length() const { return _length; }
+
+    /**
+     * Returns true if nothing is mapped or the file is empty.
+     */
+    bool empty() const { return _length == 0; }
+
+    /**
+     * Return a view of the whole mapping.
+     */
+    std::string_view view() const { return std::string_view(data(), _length); }
+
+    /**
+     * Allow use as a std::string_view.
+     */
+    operator std::string_view() const { return view(); }
+
+    const_iterator begin() const { return const_iterator(data()); }
+    const_iterator end() const { return const_iterator(data() + _length); }
+
+    /**
+     * Return the char at INDEX. INDEX is not range checked.
+     */
+    const char& operator [] (const std::size_t index) const { return _data[index]; }
+
+    /**
+     * Return a view of LEN chars from START, or the rest of the file if LEN
+     * is npos or runs past the end. Throws out_of_range if START is past
+     * the end.
+     */
+    std::string_view substr(const std::size_t start, const std::size_t len = std::string_view::npos) const {
+        if (start > _length)
+            throw std::out_of_range("MappedString::substr start is past the end");
+        return view().substr(start, len);
+    }
+
+    /**
+     * Copy LEN chars from START into a new String, allocating from RESOURCE
+     * or the default resource if RESOURCE is null.
+     */
+    String to_string(const std::size_t start = 0, const std::size_t len = std::string_view::npos,
+                     std::pmr::memory_resource* resource = nullptr) const {
+        const std::string_view part = substr(start, len);
+        return String(part.data(), part.size(), resource);
+    }
+
+    //  ###################### Search functions ######################
+    //  ##############################################################
+
+    /**
+     * Returns true if CONTENT appears in the file.
+     */
+    bool contains(const char content) const {
+        return _length > 0 && memchr(_data, content, _length) != nullptr;
+    }
+
+    /**
+     * Returns true if CONTENT appears in the file.
+     */
+    bool contains(const std::string_view content) const {
+        return view().find(content) != std::string_view::npos;
+    }
+
+    /**
+     * Return the offset of the first CONTENT at or after POS, or npos.
+     */
+    std::size_t find(const std::string_view content, const std::size_t pos = 0) const {
+        return view().find(content, pos);
+    }
+
+    /**
+     * Return the number of non-overlapping times TARGET appears in the file,
+     * matching 'CountOccurrences' in cpp_utilities.h. An empty TARGET is
+     * counted as zero occurrences.
+     */
+    std::size_t count(const std::string_view target) const {
+        if (target.empty())
+            return 0;
+        const std::string_view source = view();
+        std::size_t occurrences = 0;
+        std::size_t pos = 0;
+        while ((pos = source.find(target, pos)) != std::string_view::npos) {
+            occurrences++;
+            pos += target.size();
+        }
+        return occurrences;
+    }
+
+    /**
+     * Return the number of times CONTENT appears in the file, such as the
+     * number of lines with '\n'.
+     */
+    std::size_t count(const char content) const {
+        std::size_t occurrences = 0;
+        const char* p = _data;
+        const char* end = _data + _length;
+        while (p < end && (p = static_cast<const char*>(memchr(p, content, end - p))) != nullptr) {
+            occurrences++;
+            p++;
+        }
+        return occurrences;
+    }
+
+    /**
+     * @brief   Split the file into views based on the input delimiter, with
+     *          the same rules as 'String::split'.
+     *
+     * @param delim     The string delimiter to split on. An empty delimiter
+     *                  returns the whole file as the only element.
+     * @return          A std::vector<std::string_view> of each part, including
+     *                  an empty view after a trailing delimiter.
+     */
+    std::vector<std::string_view> split(const std::string_view delim) const {
+        std::vector<std::string_view> output;
+        const std::string_view source = view();
+        if (delim.empty()) {
+            output.push_back(source);
+            return output;
+        }
+
+        std::size_t start = 0;
+        std::size_t p = 0;
+        while ((p = source.find(delim, start)) != std::string_view::npos) {
+            output.push_back(source.substr(start, p - start));
+            start = p + delim.size();
+        }
+        output.push_back(source.substr(start));
+
+        return output;
+    }
+
+    /**
+     * @brief   Split the file into views based on the input delimiter
+     *          character, with the same rules as 'String::split'.
+     *
+     * @param delim     The char delimiter to split on.
+     * @return          A std::vector<std::string_view> of each part, including
+     *                  an empty view after a trailing delimiter.
+     */
+    std::vector<std::string_view> split(const char delim) const {
+        std::vector<std::string_view> output;
+        const char* start = data();
+        const char* end = start + _length;
+        const char* p = nullptr;
+        while (start < end && (p = static_cast<const char*>(memchr(start, delim, end - start))) != nullptr) {
+            output.emplace_back(start, static_cast<std::size_t>(p - start));
+            start = p + 1;
+        }
+        output.emplace_back(start, static_cast<std::size_t>(end - start));
+
+        return output;
+    }
+
+    /**
+     * Return a view of the file without the leading whitespace chars that
+     * 'String::ltrim' removes.
+     */
+    std::string_view ltrim() const {
+        const std::string_view source = view();
+        const std::size_t start = source.find_first_not_of(" \n\r\t\f\v");
+        return start == std::string_view::npos ? source.substr(_length) : source.substr(start);
+    }
+
+    /**
+     * Return a view of the file without the trailing whitespace chars that
+     * 'String::rtrim' removes.
+     */
+    std::string_view rtrim() const {
+        const std::string_view source = view();
+        const std::size_t end = source.find_last_not_of(" \n\r\t\f\v");
+        return end == std::string_view::npos ? source.substr(0, 0) : source.substr(0, end + 1);
+    }
+
+    /**
+     * Return a view of the file without leading and trailing whitespace.
+     */
+    std::string_view trim() const {
+        const std::string_view left = ltrim();
+        const std::size_t end = left.find_last_not_of(" \n\r\t\f\v");
+        return end == std::string_view::npos ? left.substr(0, 0) : left.substr(0, end + 1);
+    }
+
+private:
+    const char* _data = nullptr;
+    std::size_t _length = 0;
+    bool _mapped = false;
+
+    std::string __errmsg;
+    int __errno;
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_MAPPED_STRING_H__
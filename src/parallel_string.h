@@ -0,0 +1,352 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_PARALLEL_STRING_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_PARALLEL_STRING_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * Multi-threaded versions of the String searches, for buffers in the hundreds
+ * of megabytes such as a MappedString log file:
+ *
+ *     MappedString log("/var/log/big.log");
+ *     std::size_t errors = ParallelString::count(log.view(), "ERROR");
+ *     std::vector<std::string_view> lines = ParallelString::split(log.view(), "\n");
+ *
+ * The buffer is cut into one contiguous chunk per thread and every chunk is
+ * searched for matches that start inside it, reading past its end so a
+ * match that straddles two chunks is still found. The results are merged in
+ * order and give exactly what the single-threaded versions give, including
+ * the left to right, non-overlapping rule used by 'count' and 'split' for
+ * targets that can overlap themselves, such as "aa" in "aaa".
+ *
+ * Buffers smaller than MIN_CHUNK_SIZE per thread use fewer threads, so small
+ * inputs run on the calling thread alone and cost no more than a plain
+ * search.
+ */
+class ParallelString {
+public:
+
+    /**
+     * The fewest bytes given to one thread. Smaller chunks spend more time
+     * starting threads than searching.
+     */
+    static constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    /**
+     * The bytes 'find' searches between checks for an earlier match found by
+     * another thread.
+     */
+    static constexpr std::size_t FIND_BLOCK_SIZE = 1 << 18;
+
+private:
+
+    /**
+     * The matches found in one chunk: how many, and where the last one ends,
+     * or where the search started if there were none.
+     */
+    struct Span {
+        std::size_t _count;
+        std::size_t _end;
+    };
+
+    /**
+     * Returns the number of chunks to cut LENGTH bytes into for THREADS
+     * threads, where 0 threads means one per hardware thread.
+     */
+    static std::size_t ChunkCount(const std::size_t length, std::size_t threads) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        return std::max<std::size_t>(1, std::min(threads, length / MIN_CHUNK_SIZE));
+    }
+
+    /**
+     * Returns the offset chunk INDEX of COUNT starts at in LENGTH bytes.
+     */
+    static std::size_t ChunkStart(const std::size_t index, const std::size_t count, const std::size_t length) {
+        return length / count * index + std::min(index, length % count);
+    }
+
+    /**
+     * @brief   Call BODY(i) for every chunk index i below COUNT, chunk 0 on
+     *          the calling thread and the rest on their own threads, and wait
+     *          for all of them. The first exception thrown by any chunk is
+     *          rethrown here once every thread has finished.
+     *
+     * @tparam Body     A callable taking the chunk index.
+     * @param count     The number of chunks.
+     * @param body      The work for one chunk.
+     */
+    template < typename Body >
+    static void RunChunks(const std::size_t count, Body&& body) {
+        std::vector<std::exception_ptr> errors(count);
+        auto guarded = [&body, &errors](const std::size_t i) {
+            try {
+                body(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(count - 1);
+        for (std::size_t i = 1; i < count; i++)
+            threads.emplace_back(guarded, i);
+        guarded(0);
+        for (std::thread& thread : threads)
+            thread.join();
+
+        for (const std::exception_ptr& error : errors) {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Returns the offset of the first TARGET in SOURCE starting at or after
+     * FROM and before END, or npos. The match itself may run past END.
+     */
+    static std::size_t FindIn(const std::string_view source, const std::string_view target,
+                              const std::size_t from, const std::size_t end) noexcept {
+        if (from >= end)
+            return std::string_view::npos;
+        const std::size_t limit = std::min(source.size(), end + target.size() - 1);
+        return source.substr(0, limit).find(target, from);
+    }
+
+    /**
+     * Count the non-overlapping TARGETs in SOURCE that start in FROM to END,
+     * taken left to right from FROM.
+     */
+    static Span CountIn(const std::string_view source, const std::string_view target,
+                        std::size_t from, const std::size_t end) noexcept {
+        Span span{0, from};
+        while ((from = FindIn(source, target, from, end)) != std::string_view::npos) {
+            span._count++;
+            from += target.size();
+            span._end = from;
+        }
+        return span;
+    }
+
+    /**
+     * @brief   Correct the SPAN counted from START to END for a match in the
+     *          chunk before that ran on to CARRY, past START.
+     *
+     * Walks the matches taken from START and those taken from CARRY side by
+     * side until they meet at the same offset, after which they are the
+     * same, so only the few matches near the boundary are searched again.
+     *
+     * @param first     The offset of the first match taken from START.
+     * @return          The span as if counted from CARRY.
+     */
+    static Span Resync(const std::string_view source, const std::string_view target,
+                       const std::size_t carry, const std::size_t end,
+                       const Span span, std::size_t first) noexcept {
+        //  Nothing in the chunk overlaps the carried match
+        if (span._count == 0 || carry <= first)
+            return span._count == 0 ? Span{0, carry} : span;
+
+        std::size_t next = FindIn(source, target, carry, end);
+        std::size_t dropped = 0;
+        Span resynced{0, carry};
+        while (first != std::string_view::npos && next != std::string_view::npos && first != next) {
+            if (first < next) {
+                dropped++;
+                first = FindIn(source, target, first + target.size(), end);
+            } else {
+                resynced._count++;
+                resynced._end = next + target.size();
+                next = FindIn(source, target, resynced._end, end);
+            }
+        }
+
+        if (first != std::string_view::npos && first == next)
+            return Span{span._count - dropped + resynced._count, span._end};
+        if (next == std::string_view::npos)
+            return resynced;
+        const Span rest = CountIn(source, target, next, end);
+        return Span{resynced._count + rest._count, rest._end};
+    }
+
+public:
+
+    /**
+     * @brief   Find the first TARGET in SOURCE, searching with up to THREADS
+     *          threads. Threads stop early once another thread has found a
+     *          match before the part they are searching.
+     *
+     * @param source    The buffer to search.
+     * @param target    The string to find. An empty target is found at 0.
+     * @param threads   The most threads to use, or 0 for one per hardware
+     *                  thread.
+     * @return          The offset of the first TARGET, or npos.
+     */
+    static std::size_t find(const std::string_view source, const std::string_view target,
+                            const std::size_t threads = 0) {
+        const std::size_t chunks = ChunkCount(source.size(), threads);
+        if (chunks == 1 || target.empty())
+            return source.find(target);
+
+        std::atomic<std::size_t> best(std::string_view::npos);
+        RunChunks(chunks, [&](const std::size_t i) {
+            const std::size_t end = ChunkStart(i + 1, chunks, source.size());
+            for (std::size_t from = ChunkStart(i, chunks, source.size()); from < end; from += FIND_BLOCK_SIZE) {
+                if (from > best.load(std::memory_order_relaxed))
+                    return;
+                const std::size_t found = FindIn(source, target, from, std::min(end, from + FIND_BLOCK_SIZE));
+                if (found != std::string_view::npos) {
+                    std::size_t current = best.load(std::memory_order_relaxed);
+                    while (found < current && !best.compare_exchange_weak(current, found, std::memory_order_relaxed)) {}
+                    return;
+                }
+            }
+        });
+        return best.load();
+    }
+
+    /**
+     * Returns true if SOURCE contains TARGET, searching with up to THREADS
+     * threads. See 'find'.
+     */
+    static bool contains(const std::string_view source, const std::string_view target,
+                         const std::size_t threads = 0) {
+        return find(source, target, threads) != std::string_view::npos;
+    }
+
+    /**
+     * @brief   Count the non-overlapping TARGETs in SOURCE, taken left to
+     *          right, with up to THREADS threads. Gives the same result as
+     *          'CountOccurrences' in cpp_utilities.h.
+     *
+     * @param source    The buffer to search.
+     * @param target    The string to count. An empty target counts as zero.
+     * @param threads   The most threads to use, or 0 for one per hardware
+     *                  thread.
+     * @return          The number of times TARGET appears.
+     */
+    static std::size_t count(const std::string_view source, const std::string_view target,
+                             const std::size_t threads = 0) {
+        if (target.empty())
+            return 0;
+
+        const std::size_t chunks = ChunkCount(source.size(), threads);
+        std::vector<Span> spans(chunks);
+        std::vector<std::size_t> firsts(chunks);
+        RunChunks(chunks, [&](const std::size_t i) {
+            const std::size_t start = ChunkStart(i, chunks, source.size());
+            const std::size_t end = ChunkStart(i + 1, chunks, source.size());
+            firsts[i] = FindIn(source, target, start, end);
+            spans[i] = firsts[i] == std::string_view::npos ? Span{0, start} : CountIn(source, target, firsts[i], end);
+        });
+
+        std::size_t total = 0;
+        std::size_t carry = 0;
+        for (std::size_t i = 0; i < chunks; i++) {
+            const Span span = Resync(source, target, carry, ChunkStart(i + 1, chunks, source.size()), spans[i], firsts[i]);
+            total += span._count;
+            carry = std::max(carry, span._end);
+        }
+        return total;
+    }
+
+    /**
+     * Count the times CONTENT appears in SOURCE with up to THREADS threads.
+     */
+    static std::size_t count(const std::string_view source, const char content, const std::size_t threads = 0) {
+        return count(source, std::string_view(&content, 1), threads);
+    }
+
+    /**
+     * @brief   Split SOURCE into views based on the input delimiter, with the
+     *          same rules as 'String::split', using up to THREADS threads to
+     *          find the delimiters and fill the output.
+     *
+     * @param source    The buffer to split. The views point into it.
+     * @param delim     The string delimiter to split on. An empty delimiter
+     *                  returns the whole buffer as the only element.
+     * @param threads   The most threads to use, or 0 for one per hardware
+     *                  thread.
+     * @return          A std::vector<std::string_view> of each part, in
+     *                  order, including an empty view after a trailing
+     *                  delimiter.
+     */
+    static std::vector<std::string_view> split(const std::string_view source, const std::string_view delim,
+                                               const std::size_t threads = 0) {
+        if (delim.empty())
+            return std::vector<std::string_view>{source};
+
+        const std::size_t chunks = ChunkCount(source.size(), threads);
+        std::vector<std::vector<std::size_t>> found(chunks);
+        RunChunks(chunks, [&](const std::size_t i) {
+            const std::size_t end = ChunkStart(i + 1, chunks, source.size());
+            std::size_t p = ChunkStart(i, chunks, source.size());
+            while ((p = FindIn(source, delim, p, end)) != std::string_view::npos) {
+                found[i].push_back(p);
+                p += delim.size();
+            }
+        });
+
+        //  Drop delimiters overlapping one taken at the end of the chunk
+        //  before, searching again until the two walks meet
+        std::vector<std::size_t> offsets(chunks + 1, 0);
+        std::vector<std::size_t> starts(chunks, 0);
+        std::size_t carry = 0;
+        for (std::size_t i = 0; i < chunks; i++) {
+            std::vector<std::size_t>& positions = found[i];
+            if (!positions.empty() && positions.front() < carry) {
+                const std::size_t end = ChunkStart(i + 1, chunks, source.size());
+                std::vector<std::size_t> resynced;
+                std::size_t p = carry;
+                while ((p = FindIn(source, delim, p, end)) != std::string_view::npos) {
+                    const auto same = std::lower_bound(positions.begin(), positions.end(), p);
+                    if (same != positions.end() && *same == p) {
+                        resynced.insert(resynced.end(), same, positions.end());
+                        break;
+                    }
+                    resynced.push_back(p);
+                    p += delim.size();
+                }
+                positions.swap(resynced);
+            }
+
+            starts[i] = carry;
+            if (!positions.empty())
+                carry = positions.back() + delim.size();
+            offsets[i + 1] = offsets[i] + positions.size();
+        }
+
+        std::vector<std::string_view> output(offsets[chunks] + 1);
+        RunChunks(chunks, [&](const std::size_t i) {
+            std::size_t start = starts[i];
+            std::size_t out = offsets[i];
+            for (const std::size_t p : found[i]) {
+                output[out++] = source.substr(start, p - start);
+                start = p + delim.size();
+            }
+        });
+        output.back() = source.substr(carry);
+
+        return output;
+    }
+
+    /**
+     * Split SOURCE on the delimiter character DELIM with up to THREADS
+     * threads. See 'split(std::string_view, std::string_view, std::size_t)'.
+     */
+    static std::vector<std::string_view> split(const std::string_view source, const char delim,
+                                               const std::size_t threads = 0) {
+        return split(source, std::string_view(&delim, 1), threads);
+    }
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_PARALLEL_STRING_H__
@@ -6,15 +6,22 @@
 #ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_PROXY_HTTP_REQUEST_H__
 #define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_PROXY_HTTP_REQUEST_H__
 
+#include <array>
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <algorithm>
 
+#include "char_class.h"
+#include "io_pool.h"
 #include "log.h"
 #include "tcp_client.h"
 #include "string.h"
+#include "stream_tokenizer.h"
+#include "string_pool.h"
 
 namespace HTTP {
     //  ################## HTTP request structures ###################
@@ -196,11 +203,22 @@ namespace HTTP {
     };
 
     /**
-     * Formatted header field and value pairs.
+     * Formatted header field and value pairs. When header names are
+     * interned (see 'Request::SetInternHeaderNames') the name is held once
+     * in the global StringPool as '_internedName' and '_name' is left empty,
+     * so use 'name()' to read it either way.
      */
     struct HeaderField {
         std::string _name;
         std::string _value;
+        InternedString _internedName;
+
+        /**
+         * Returns the header name, interned or not.
+         */
+        std::string_view name() const noexcept {
+            return _internedName ? _internedName.view() : std::string_view(_name);
+        }
     };
     /**
      * List of header fields for a HTTP request.
@@ -306,6 +324,20 @@ namespace HTTP {
             static_cast<unsigned char>(c) <= 0xFF;
     }
 
+    /**
+     * The characters allowed in a header field token, see 'IsTokenChar'.
+     */
+    inline constexpr CharClass TokenChars([](const char c) { return IsTokenChar(c); });
+
+    /**
+     * The characters allowed in a header field value or reason phrase:
+     * white space, visible and obsolete text characters. These form three
+     * ranges, so they are checked 16 at a time.
+     */
+    inline constexpr CharClass FieldContentChars([](const char c) {
+        return IsWhiteSpaceChar(c) || IsVisibleChar(c) || IsObsoleteTextChar(c);
+    });
+
     //  ################## Header parsing functions ##################
     //  ##############################################################
 
@@ -314,9 +346,11 @@ namespace HTTP {
      *
      * @throw   runtime_error if the HTTP version string is invalid.
      */
-    inline Version ParseVersion(String input) {
+    inline Version ParseVersion(const String& input) {
         llog << "Parsing version...";
 
+        if (input.length() < 8)
+            throw std::runtime_error("Invalid HTTP version: too short.");
         if (input[0] != 'H')
             throw std::runtime_error("Invalid HTTP version: index: 0, char: H");
         if (input[1] != 'T')
@@ -333,12 +367,16 @@ namespace HTTP {
         if (input[4] != '/')
             throw std::runtime_error("Invalid HTTP version: index: 4, char: /");
 
-        const uint16_t verMajor = std::stoi(std::string{ input[5] });
+        if (!IsDigitChar(input[5]))
+            throw std::runtime_error("Invalid HTTP version: index: 5, char: digit");
+        const uint16_t verMajor = input[5] - '0';
 
         if (input[6] != '.')
             throw std::runtime_error("Invalid HTTP version: index: 6, char: .");
 
-        const uint16_t verMinor = std::stoi(std::string{ input[7] });
+        if (!IsDigitChar(input[7]))
+            throw std::runtime_error("Invalid HTTP version: index: 7, char: digit");
+        const uint16_t verMinor = input[7] - '0';
 
         return { ._major = verMajor, ._minor = verMinor };
     }
@@ -348,7 +386,7 @@ namespace HTTP {
      *
      * @throw   runtime_error if the status code value is invalid.
      */
-    inline uint16_t ParseStatusCode(String input) {
+    inline uint16_t ParseStatusCode(const String& input) {
         llog << "Parsing status code...";
 
         if (input.length() != 3) {
@@ -365,7 +403,7 @@ namespace HTTP {
             }
         }
 
-        return static_cast<std::uint16_t>(std::stoi(input));
+        return input.to_number<std::uint16_t>()._value;
     }
 
     /**
@@ -378,13 +416,12 @@ namespace HTTP {
      * See 'IsWhiteSpaceChar', 'IsVisibleChar' and
      * 'IsObsoleteTextChar' for details.
      */
-    inline bool ParseReason(String input) {
-        for (char c : input) {
-            if (!IsWhiteSpaceChar(c) && !IsVisibleChar(c) && !IsObsoleteTextChar(c)) {
-                std::stringstream msg;
-                msg << "Invalid reason string, invalid character: " << std::to_string(c) << ".";
-                throw std::runtime_error(msg.str());
-            }
+    inline bool ParseReason(const String& input) {
+        const std::size_t invalid = FieldContentChars.find_first_not_of(input.c_str(), input.size());
+        if (invalid != input.size()) {
+            std::stringstream msg;
+            msg << "Invalid reason string, invalid character: " << std::to_string(input[invalid]) << ".";
+            throw std::runtime_error(msg.str());
         }
         return true;
     }
@@ -398,7 +435,7 @@ namespace HTTP {
      *
      * See 'ParseVersion', 'ParseStatusCode' and 'ParseReason' for details.
      */
-    inline Status ParseStatusLine(String headerLine) {
+    inline Status ParseStatusLine(const String& headerLine) {
         llog << "Parsing status line...";
 
         std::vector<String> headerParts = headerLine.split(' ');
@@ -451,13 +488,12 @@ namespace HTTP {
      *
      * See 'IsTokenChar' for details.
      */
-    inline bool ParseToken(String input) {
-        for (char c : input) {
-            if (!IsTokenChar(c)) {
-                std::stringstream msg;
-                msg << "Invalid token: " << std::to_string(c);
-                throw std::runtime_error(msg.str());
-            }
+    inline bool ParseToken(const String& input) {
+        const std::size_t invalid = TokenChars.find_first_not_of(input.c_str(), input.size());
+        if (invalid != input.size()) {
+            std::stringstream msg;
+            msg << "Invalid token: " << std::to_string(input[invalid]);
+            throw std::runtime_error(msg.str());
         }
         return true;
     }
@@ -472,13 +508,12 @@ namespace HTTP {
      * See 'IsWhiteSpaceChar', 'IsVisibleChar' and
      * 'IsObsoleteTextChar' for details.
      */
-    inline bool ParseContent(String input) {
-        for (char c : input) {
-            if (!IsWhiteSpaceChar(c) && !IsVisibleChar(c) && !IsObsoleteTextChar(c)) {
-                std::stringstream msg;
-                msg << "Invalid content: " << std::to_string(c);
-                throw std::runtime_error(msg.str());
-            }
+    inline bool ParseContent(const String& input) {
+        const std::size_t invalid = FieldContentChars.find_first_not_of(input.c_str(), input.size());
+        if (invalid != input.size()) {
+            std::stringstream msg;
+            msg << "Invalid content: " << std::to_string(input[invalid]);
+            throw std::runtime_error(msg.str());
         }
         return true;
     }
@@ -490,9 +525,10 @@ namespace HTTP {
      * Throws runtime_error if the header field line is invalid and
      * re-throws caught runtime_error exceptions
      *
-     * See 'ParseToken' and 'ParseContent' for details.
+     * See 'ParseToken' and 'ParseContent' for details. The lower case
+     * name is interned in the global StringPool if INTERNNAME is true.
      */
-    inline HeaderField ParseHeaderLine(String headerLine) {
+    inline HeaderField ParseHeaderLine(const String& headerLine, const bool internName = false) {
         llog << "Parsing header line...";
 
         std::vector<String> headerParts = headerLine.split(':');
@@ -500,9 +536,9 @@ namespace HTTP {
         if (headerParts.size() < 2)
             throw std::runtime_error("Invalid header.");
 
-        String token;
+        String token{ headerLine.resource() };
         try {
-            if (ParseToken(headerParts[0])) token = headerParts[0];
+            if (ParseToken(headerParts[0])) token = std::move(headerParts[0]);
         }
         catch (std::runtime_error& e) {
             throw e;
@@ -518,7 +554,22 @@ namespace HTTP {
         }
         llog << "Content: " << content.c_str();
 
-        return { ._name = token.to_lower(), ._value = content };
+        //  Header names are case-insensitive, store them lower case
+        token.to_lower_inplace();
+        if (internName)
+            return { ._value = content, ._internedName = StringPool::Global().intern(token) };
+        return { ._name = token, ._value = content };
+    }
+
+    /**
+     * Returns true if the name of FIELD is NAME, a lower case name interned
+     * in the global StringPool. Interned names compare by pointer, other
+     * names ignoring case.
+     */
+    inline bool HeaderNameIs(const HeaderField& field, const InternedString& name) noexcept {
+        if (field._internedName)
+            return field._internedName == name;
+        return String::iequals(field._name, name.view());
     }
 
     //  ############## Encoding and Decoding functions ###############
@@ -676,10 +727,8 @@ namespace HTTP {
      *
      * RFC 7230, 3.1.1. Request Line.
      */
-    inline std::string EncodeRequestLine(const std::string& method, const std::string& target) {
-        std::stringstream result;
-        result << method << " " << target << " HTTP/1.1\r\n";
-        return result.str();
+    inline String EncodeRequestLine(const std::string& method, const std::string& target) {
+        return String::format("{} {} HTTP/1.1\r\n", method, target);
     }
 
     /**
@@ -694,10 +743,11 @@ namespace HTTP {
     inline std::string EncodeHeaderFields(const HeaderFields& headerFields) {
         std::stringstream result;
         for (const auto& headerField : headerFields) {
-            if (headerField._name.empty())
+            const std::string_view name = headerField.name();
+            if (name.empty())
                 throw std::logic_error{ "Invalid header field name" };
 
-            for (const auto c : headerField._name)
+            for (const auto c : name)
                 if (!IsTokenChar(c))
                     throw std::logic_error{ "Invalid header field name" };
 
@@ -705,7 +755,7 @@ namespace HTTP {
                 if (!IsWhiteSpaceChar(c) && !IsVisibleChar(c) && !IsObsoleteTextChar(c))
                     throw std::logic_error{ "Invalid header field value" };
 
-            result << headerField._name << ": " << headerField._value << "\r\n";
+            result << name << ": " << headerField._value << "\r\n";
         }
 
         return result.str();
@@ -935,9 +985,9 @@ namespace HTTP {
 
             llog << "Constructed request html: \"" << requestData
                 << "\", beginning TCP Client initialisation and comms...";
-            TcpClient* client;
+            std::unique_ptr<TcpClient> client;
             try {
-                client = new TcpClient(_ipv);
+                client.reset(new TcpClient(_ipv));
             }
             catch (std::runtime_error& err) {
              //  Error message and number returned in exception as the
@@ -1020,10 +1070,18 @@ namespace HTTP {
 
             //  A flag to toggle after the header data has been parsed
             bool headerParsed = false;
+            //  A flag to toggle after the status line has been parsed
+            bool statusParsed = false;
             //  Definition of Carriage Return and Line Feed
             const std::string crlf = "\r\n";
-            //  The character sequence that defines the end of the header section in the output html
-            const std::string headerEndString = "\r\n\r\n";
+            //  Splits the header section into lines as it arrives, keeping
+            //  its place between reads so no byte is searched twice
+            StreamTokenizer headerLines(crlf);
+            //  Every String built while parsing the header comes from this
+            //  arena, which starts on the stack and is released in one go
+            //  when the request returns.
+            char arenaBuffer[4096];
+            std::pmr::monotonic_buffer_resource arena(arenaBuffer, sizeof(arenaBuffer));
 
             //  A flag to toggle is the header specifies this is a chunked data reply
             bool chunkedResponse = false;
@@ -1037,15 +1095,21 @@ namespace HTTP {
             //  A flag to remove crlf after the chunk
             bool removeCrlfAfterChunk = false;
 
+            static const InternedString transferEncodingName =
+                StringPool::Global().intern("transfer-encoding");
+            static const InternedString contentLengthName =
+                StringPool::Global().intern("content-length");
+
+            //  Leased once for the whole response, and reused by the next
+            //  request once this one returns
+            IoBuffer buff = BufferPool::Global().lease(BufferPool::MEDIUM_BUFFER_SIZE);
+
             llog << "Parsing response...";
 
             //  Need to continuously read bytes on the socket until no more bytes are available
             while (true) {
                 //  Read from the socket
-                size_t buffSize = 10000;
-                uint8_t buff[buffSize];
-
-                const int bytesRead = client->Read(buff, buffSize);
+                const int bytesRead = client->Read(buff.data(), buff.size());
 
                 if (bytesRead < 0) {
                     //  error
@@ -1064,64 +1128,57 @@ namespace HTTP {
                     return response;
                 }
 
-                llog << "Read bytes: " << bytesRead << ", socket buff:\n\n" << buff << "\n";
-
-                //  Raw output
-                responseData.insert(responseData.end(), buff, buff + bytesRead);
+                llog << "Read bytes: " << bytesRead << ", socket buff:\n\n"
+                    << std::string_view(buff.data(), static_cast<std::size_t>(bytesRead)) << "\n";
 
-                if (!headerParsed) {
+                if (headerParsed) {
+                    //  Raw output
+                    responseData.insert(responseData.end(), buff.data(), buff.data() + bytesRead);
+                } else {
                     llog << "Parsing header...";
 
                     // RFC 7230, 3. Message Format
-                    // Two empty lines indicates the end of the header section (RFC 7230, 2.1. Client/Server Messaging)
-                    std::stringstream ss;
-                    ss << responseData.data();
-                    String fullOutput = ss.str();
-
-                    //  two consecutive CRLFs not found
-                    if (!fullOutput.contains(headerEndString)) break;
-
-                    llog << "End of header found, parsing header fields...";
-
-                    std::vector<String> headerLines = fullOutput.split(crlf);
-                    if (headerLines.size() < 2) {
-                        std::stringstream msg;
-                        msg << "Error splitting header content into separate lines; "
-                            << "Returned headers were not formatted correctly.";
-                        elog << msg.str();
-
-                        return { ._status = {
-                                    ._code = Status::Code::InternalServerError,
-                                    ._reason = msg.str() } };
-                    }
+                    // An empty line indicates the end of the header section (RFC 7230, 2.1. Client/Server Messaging)
+                    headerLines.feed(buff.data(), static_cast<std::size_t>(bytesRead));
 
-                    response._status = ParseStatusLine(headerLines[0]);
-                    if (response._status._code == Status::Code::InternalProgramError) {
-                        std::stringstream msg;
-                        msg << "Internal program error occurred with processing.";
+                    std::string_view line;
+                    while (!headerParsed && headerLines.next(line)) {
+                        const String headerLine(line.data(), line.size(), &arena);
 
-                        elog << msg.str();
+                        if (!statusParsed) {
+                            response._status = ParseStatusLine(headerLine);
+                            if (response._status._code == Status::Code::InternalProgramError) {
+                                std::stringstream msg;
+                                msg << "Internal program error occurred with processing.";
 
-                        return { ._status = {
-                                    ._code = Status::Code::InternalProgramError,
-                                    ._reason = msg.str() } };
-                    }
+                                elog << msg.str();
 
-                    llog << "\nResponse:\n\tStatus:\n\t\tCode: "
-                        << static_cast<std::uint16_t>(response._status._code)
-                        << "\n\t\tVersion: "
-                        << response._status._version._major
-                        << "." << response._status._version._minor
-                        << "\n\t\tReason: "
-                        << response._status._reason;
+                                return { ._status = {
+                                            ._code = Status::Code::InternalProgramError,
+                                            ._reason = msg.str() } };
+                            }
+                            statusParsed = true;
+
+                            llog << "\nResponse:\n\tStatus:\n\t\tCode: "
+                                << static_cast<std::uint16_t>(response._status._code)
+                                << "\n\t\tVersion: "
+                                << response._status._version._major
+                                << "." << response._status._version._minor
+                                << "\n\t\tReason: "
+                                << response._status._reason;
+                            continue;
+                        }
 
-#pragma GCC diagnostic ignored "-Wsign-compare"
-                    for (int i = 1; i < headerLines.size(); i++) {
-#pragma GCC diagnostic pop
+                        //  The empty line after the last header field
+                        if (line.empty()) {
+                            llog << "End of header found.";
+                            headerParsed = true;
+                            break;
+                        }
 
                         HeaderField headerField;
                         try {
-                            headerField = ParseHeaderLine(headerLines[i]);
+                            headerField = ParseHeaderLine(headerLine, _internHeaderNames);
                         }
                         catch (std::runtime_error& e) {
                             return { ._status = {
@@ -1130,13 +1187,13 @@ namespace HTTP {
                         }
 
                         llog << "\nHeader:\n\tName:"
-                            << headerField._name
+                            << headerField.name()
                             << "\n\tValue:"
                             << headerField._value;
 
-                        if (strcmp(headerField._name.c_str(), "transfer-encoding") == 0) {
+                        if (HeaderNameIs(headerField, transferEncodingName)) {
                             // RFC 7230, 3.3.1. Transfer-Encoding
-                            if (strcmp(headerField._value.c_str(), "chunked") == 0) {
+                            if (String::iequals(headerField._value, "chunked")) {
                                 chunkedResponse = true;
                             } else {
                                 std::stringstream msg;
@@ -1148,26 +1205,35 @@ namespace HTTP {
 #pragma GCC diagnostic pop
 
                             }
-                        } else if (strcmp(headerField._name.c_str(), "content-length") == 0) {
+                        } else if (HeaderNameIs(headerField, contentLengthName)) {
                             // RFC 7230, 3.3.2. Content-Length
-                            contentLength = std::stoi(headerField._value);
+                            const auto parsedLength = String::parse_number<std::size_t>(
+                                headerField._value.data(),
+                                headerField._value.data() + headerField._value.size());
+                            if (!parsedLength) {
+                                std::stringstream msg;
+                                msg << "Invalid content-length: " << headerField._value;
+                                elog << msg.str();
+
+                                return { ._status = {
+                                            ._code = Status::Code::InternalProgramError,
+                                            ._reason = msg.str() } };
+                            }
+                            contentLength = parsedLength._value;
                             contentLengthReceived = true;
                             response._body.reserve(contentLength);
                         }
 
                         response._headerFields.push_back(headerField);
-
-                        //  Check if this is the last header field
-                        if (strcmp(headerLines[i + 1], "") == 0) break;
                     }
 
-                    // RFC 7230, 3. Message Format
-                    // Empty line indicates the end of the header section (RFC 7230, 2.1. Client/Server Messaging)
-                    const auto endIterator = std::search(responseData.cbegin(), responseData.cend(),
-                                                    headerEndString.cbegin(), headerEndString.cend());
+                    //  The end of the header has not arrived yet, read more
+                    if (!headerParsed) continue;
 
-                    responseData.erase(responseData.begin(), endIterator + 4);
-                    headerParsed = true;
+                    //  Whatever followed the header in this read is body
+                    const std::string_view rest = headerLines.remainder();
+                    responseData.insert(responseData.end(), rest.begin(), rest.end());
+                    headerLines.reset();
                 }
 
                 if (headerParsed) {
@@ -1207,12 +1273,26 @@ namespace HTTP {
 
                                 if (i == responseData.end()) break;
 
-                                std::stringstream ss;
-                                ss << responseData.data();
-                                String output = ss.str();
-
-                                //  Convert the hex string to int
-                                expectedChunkSize = std::stoi(output.split(crlf)[0], 0, 16);
+                                //  Convert the hex chunk size straight from the received
+                                //  bytes, stopping at any chunk extension (RFC 7230, 4.1.1)
+                                const char* sizeBegin = reinterpret_cast<const char*>(responseData.data());
+                                const char* sizeEnd = reinterpret_cast<const char*>(&*i);
+                                const char* extension = static_cast<const char*>(
+                                    memchr(sizeBegin, ';', sizeEnd - sizeBegin));
+                                if (extension != nullptr) sizeEnd = extension;
+
+                                const auto parsedSize = String::parse_number<std::size_t>(sizeBegin, sizeEnd, 16);
+                                if (!parsedSize) {
+                                    std::stringstream msg;
+                                    msg << "Invalid chunk size: "
+                                        << std::string(sizeBegin, sizeEnd) << ".";
+                                    elog << msg.str();
+
+                                    return { ._status = {
+                                                ._code = Status::Code::InternalProgramError,
+                                                ._reason = msg.str() } };
+                                }
+                                expectedChunkSize = parsedSize._value;
                                 responseData.erase(responseData.begin(), i + 2);
 
                                 if (expectedChunkSize == 0)
@@ -1233,11 +1313,21 @@ namespace HTTP {
             return response;
         }
 
+        /**
+         * Intern the names of received header fields in the global
+         * StringPool rather than copying each one into its HeaderField. Saves
+         * memory when many responses with the same header names are kept,
+         * and header names are then matched by pointer. Off by default; the
+         * names are then in 'HeaderField::_internedName', not '_name'.
+         */
+        void SetInternHeaderNames(const bool intern) noexcept { _internHeaderNames = intern; }
+
         std::string ERR_MSG() { return __errmsg; }
         int ERR_NO() { return __errno; }
 
     private:
         TcpClient::InternetProtocol _ipv = TcpClient::InternetProtocol::v4;
+        bool _internHeaderNames = false;
         std::string _ipAddress;
         Uri _uri;
 
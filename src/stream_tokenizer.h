@@ -0,0 +1,160 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STREAM_TOKENIZER_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STREAM_TOKENIZER_H__
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A resumable tokenizer for input that arrives in pieces, such as bytes read
+ * from a socket. Feed it each chunk as it arrives and take the complete
+ * tokens (lines, or delimiter separated fields) out as they become
+ * available:
+ *
+ *     StreamTokenizer lines("\r\n");
+ *     while (int n = client.Read(buff, sizeof(buff))) {
+ *         lines.feed(buff, n);
+ *         std::string_view line;
+ *         while (lines.next(line)) { ... }
+ *     }
+ *
+ * The scan position is kept between chunks, so every byte is searched once
+ * however the input is split, and a delimiter split across two chunks is
+ * still found. Bytes before the current token are dropped from the buffer
+ * once they are more than half of it, so feeding N bytes costs O(N) in
+ * total, not O(N^2) as rebuilding and splitting the whole input after every
+ * read does.
+ *
+ * Tokens are std::string_views into the tokenizer's buffer. They stay valid
+ * until the next call to 'feed' or 'reset', so copy anything that must be
+ * kept longer. Chunks are copied in, so the caller can reuse its read buffer
+ * straight away.
+ */
+class StreamTokenizer {
+private:
+
+    std::string _delimiter;
+    std::vector<char> _buffer;
+
+    /**
+     * The offset of the start of the next token in '_buffer'.
+     */
+    std::size_t _start = 0;
+
+    /**
+     * The offset to resume searching for the delimiter from. Everything
+     * between '_start' and here is known not to start a delimiter.
+     */
+    std::size_t _scan = 0;
+
+    bool _finished = false;
+
+    /**
+     * Drop the bytes before '_start' once they are at least half of the
+     * buffer, so the buffer is moved O(1) times per byte fed.
+     */
+    void Compact() {
+        if (_start == 0 || _start < _buffer.size() - _start)
+            return;
+        _buffer.erase(_buffer.begin(), _buffer.begin() + static_cast<std::ptrdiff_t>(_start));
+        _scan -= _start;
+        _start = 0;
+    }
+
+public:
+
+    /**
+     * @brief   Construct a tokenizer that splits on DELIMITER.
+     *
+     * @param delimiter     The bytes between tokens, such as "\r\n" or ",".
+     *                      Must not be empty.
+     */
+    explicit StreamTokenizer(const std::string_view delimiter) : _delimiter(delimiter) {
+        if (_delimiter.empty())
+            throw std::invalid_argument("StreamTokenizer delimiter must not be empty");
+    }
+
+    /**
+     * Append LENGTH bytes at DATA to the input. Invalidates the tokens
+     * already returned.
+     */
+    void feed(const char* data, const std::size_t length) {
+        Compact();
+        _buffer.insert(_buffer.end(), data, data + length);
+    }
+
+    /**
+     * Append CHUNK to the input. Invalidates the tokens already returned.
+     */
+    void feed(const std::string_view chunk) { feed(chunk.data(), chunk.size()); }
+
+    /**
+     * Mark the end of the input, so 'next' also returns the bytes after the
+     * last delimiter as a final token, if there are any.
+     */
+    void finish() noexcept { _finished = true; }
+
+    /**
+     * @brief   Take the next complete token, continuing the search from where
+     *          the last call stopped.
+     *
+     * @param token     Set to the token, without its delimiter, if there is
+     *                  one.
+     * @return          True if a token was found, false if more input is
+     *                  needed first (or, after 'finish', the input is used
+     *                  up).
+     */
+    bool next(std::string_view& token) noexcept {
+        const std::string_view buffered(_buffer.data(), _buffer.size());
+        const std::size_t found = buffered.find(_delimiter, _scan);
+        if (found != std::string_view::npos) {
+            token = buffered.substr(_start, found - _start);
+            _start = _scan = found + _delimiter.size();
+            return true;
+        }
+
+        if (_finished && _start < buffered.size()) {
+            token = buffered.substr(_start);
+            _start = _scan = buffered.size();
+            return true;
+        }
+
+        //  A delimiter could still start in the last few bytes
+        const std::size_t tail = _delimiter.size() - 1;
+        if (buffered.size() > _start + tail)
+            _scan = buffered.size() - tail;
+        return false;
+    }
+
+    /**
+     * Returns the bytes not yet returned in a token, such as a body that
+     * follows a header section. Valid until the next 'feed' or 'reset'.
+     */
+    std::string_view remainder() const noexcept {
+        return std::string_view(_buffer.data() + _start, _buffer.size() - _start);
+    }
+
+    /**
+     * Returns the number of bytes held, including those already returned in
+     * tokens but not yet dropped.
+     */
+    std::size_t buffered() const noexcept { return _buffer.size(); }
+
+    /**
+     * Drop all input and start again, keeping the buffer's memory.
+     */
+    void reset() noexcept {
+        _buffer.clear();
+        _start = _scan = 0;
+        _finished = false;
+    }
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STREAM_TOKENIZER_H__
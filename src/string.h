@@ -6,44 +6,587 @@
 #ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_H__
 #define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_H__
 
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
 #include <string.h>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "utf8.h"
+
 /**
  * @brief       A template class to instantiate 'begin()' and 'end()' functions
  *              for the custom String class so it can be used in iterator-based
  *              methods.
  *
- * @tparam T
+ *              A contiguous random-access iterator over the chars of a String,
+ *              with the standard iterator traits set, so standard algorithms
+ *              such as std::search, std::find and std::distance take their
+ *              random-access paths. An Iterator<char> converts to an
+ *              Iterator<const char>.
+ *
+ * @tparam T    char or const char.
  */
 template < typename T >
 class Iterator {
 private:
     T* _data;
+
+    template < typename > friend class Iterator;
+
 public:
-    Iterator(T* data) {
-        _data = data;
+    using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+    using iterator_concept = std::contiguous_iterator_tag;
+#endif
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    Iterator() noexcept : _data(nullptr) {}
+
+    Iterator(T* data) noexcept : _data(data) {}
+
+    /**
+     * Convert an Iterator<char> to an Iterator<const char>.
+     */
+    template < typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>> >
+    Iterator(const Iterator<U>& other) noexcept : _data(other._data) {}
+
+    /**
+     * Returns the address of the char this iterator refers to.
+     */
+    T* base() const noexcept { return _data; }
+
+    T& operator*() const noexcept { return *_data; }
+    T* operator->() const noexcept { return _data; }
+    T& operator[](const difference_type n) const noexcept { return _data[n]; }
+
+    Iterator<T>& operator++() noexcept {
+        _data++;
+        return *this;
     }
 
-    T& operator*() {
-        return *_data;
+    Iterator<T> operator++(int) noexcept { return Iterator<T>(_data++); }
+
+    Iterator<T>& operator--() noexcept {
+        _data--;
+        return *this;
     }
 
-    Iterator<T>& operator++() {
-        _data++;
+    Iterator<T> operator--(int) noexcept { return Iterator<T>(_data--); }
+
+    Iterator<T>& operator+=(const difference_type n) noexcept {
+        _data += n;
         return *this;
     }
 
-    bool operator==(const Iterator<T>& a) {
-        return _data == a._data;
+    Iterator<T>& operator-=(const difference_type n) noexcept {
+        _data -= n;
+        return *this;
+    }
+
+    friend Iterator<T> operator+(const Iterator<T>& a, const difference_type n) noexcept { return Iterator<T>(a._data + n); }
+    friend Iterator<T> operator+(const difference_type n, const Iterator<T>& a) noexcept { return Iterator<T>(a._data + n); }
+    friend Iterator<T> operator-(const Iterator<T>& a, const difference_type n) noexcept { return Iterator<T>(a._data - n); }
+    friend difference_type operator-(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data - b._data; }
+
+    friend bool operator==(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data == b._data; }
+    friend bool operator!=(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data != b._data; }
+    friend bool operator<(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data < b._data; }
+    friend bool operator>(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data > b._data; }
+    friend bool operator<=(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data <= b._data; }
+    friend bool operator>=(const Iterator<T>& a, const Iterator<T>& b) noexcept { return a._data >= b._data; }
+};
+
+/**
+ * The result of an exception-free numeric conversion. '_error' is a
+ * default constructed std::errc on success, 'std::errc::invalid_argument'
+ * if the input was empty or was not entirely a number, and
+ * 'std::errc::result_out_of_range' if the number does not fit the type
+ * (or the requested range). '_value' is only meaningful on success.
+ *
+ * @tparam T    The numeric type converted to.
+ */
+template < typename T >
+struct NumericResult {
+    T _value;
+    std::errc _error;
+
+    /**
+     * Returns true if the conversion succeeded.
+     */
+    bool ok() const noexcept { return _error == std::errc(); }
+
+    /**
+     * Returns true if the conversion succeeded.
+     */
+    explicit operator bool() const noexcept { return ok(); }
+};
+
+/**
+ * One operand of a StringConcat: '_length' characters at '_data', or a
+ * char operand held by value in '_char' when '_data' is null, so it does
+ * not refer to a temporary.
+ */
+struct StringConcatPiece {
+    const char* _data;
+    std::size_t _length;
+    char _char;
+
+    const char* data() const noexcept { return _data != nullptr ? _data : &_char; }
+};
+
+/**
+ * A lazy concatenation of N pieces, returned by the String plus ( + )
+ * operator. Nothing is copied while the expression is built; the total
+ * length is known up front, so assigning the expression to a String (or
+ * constructing one, or converting it to a std::string) allocates once and
+ * copies every piece once, however long the chain.
+ *
+ * The pieces refer to the operands rather than copying them, so a
+ * StringConcat must not outlive the full expression it was built in. Do
+ * not hold one in an 'auto' variable.
+ *
+ * @tparam N    The number of pieces.
+ */
+template < std::size_t N >
+class StringConcat {
+public:
+
+    /**
+     * One operand of the concatenation, shared by every StringConcat size.
+     */
+    using Piece = StringConcatPiece;
+
+private:
+
+    template < std::size_t > friend class StringConcat;
+
+    Piece _pieces[N];
+    std::size_t _length;
+    std::pmr::memory_resource* _resource;
+
+public:
+
+    /**
+     * Wrap a single piece. RESOURCE is the memory resource of the String the
+     * piece came from, or null if it did not come from a String.
+     */
+    StringConcat(const Piece& piece, std::pmr::memory_resource* resource = nullptr) noexcept {
+        static_assert(N == 1, "A StringConcat is built from one piece or from two concatenations");
+        _pieces[0] = piece;
+        _length = piece._length;
+        _resource = resource;
+    }
+
+    /**
+     * Join two concatenations. The result uses the memory resource of the
+     * leftmost String operand.
+     */
+    template < std::size_t A, std::size_t B >
+    StringConcat(const StringConcat<A>& lhs, const StringConcat<B>& rhs) noexcept {
+        static_assert(A + B == N, "StringConcat size does not match its operands");
+        for (std::size_t i = 0; i < A; i++)
+            _pieces[i] = lhs._pieces[i];
+        for (std::size_t i = 0; i < B; i++)
+            _pieces[A + i] = rhs._pieces[i];
+        _length = lhs._length + rhs._length;
+        _resource = (lhs._resource != nullptr ? lhs._resource : rhs._resource);
+    }
+
+    /**
+     * Make a piece from a C string. A null pointer is treated as empty.
+     */
+    static Piece MakePiece(const char* source) noexcept {
+        return { source != nullptr ? source : "", source != nullptr ? strlen(source) : 0, '\0' };
+    }
+
+    /**
+     * Make a piece from a std::string.
+     */
+    static Piece MakePiece(const std::string& source) noexcept {
+        return { source.data(), source.size(), '\0' };
+    }
+
+    /**
+     * Make a piece holding a single character by value.
+     */
+    static Piece MakePiece(const char source) noexcept {
+        return { nullptr, 1, source };
+    }
+
+    /**
+     * The total number of characters in the concatenation.
+     */
+    std::size_t size() const noexcept { return _length; }
+
+    /**
+     * The memory resource of the leftmost String operand, or null if there
+     * is no String operand.
+     */
+    std::pmr::memory_resource* resource() const noexcept { return _resource; }
+
+    /**
+     * Copy every piece to OUT, which must have room for 'size()' characters.
+     * Returns the position after the last character copied. No terminator is
+     * written.
+     */
+    char* copy(char* out) const noexcept {
+        for (std::size_t i = 0; i < N; i++) {
+            if (_pieces[i]._length > 0)
+                memcpy(out, _pieces[i].data(), _pieces[i]._length);
+            out += _pieces[i]._length;
+        }
+        return out;
+    }
+
+    /**
+     * Returns true if any piece refers to characters in [FIRST, LAST), so a
+     * String being assigned to can tell whether it appears in the expression.
+     */
+    bool overlaps(const char* first, const char* last) const noexcept {
+        std::less<const char*> less;
+        for (std::size_t i = 0; i < N; i++) {
+            const char* data = _pieces[i]._data;
+            if (data != nullptr && _pieces[i]._length > 0 &&
+                less(data, last) && less(first, data + _pieces[i]._length))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Materialise the concatenation as a std::string with one allocation.
+     */
+    operator std::string() const {
+        std::string result(_length, '\0');
+        copy(result.data());
+        return result;
+    }
+
+    /**
+     * Write every piece to OS without materialising the concatenation.
+     */
+    friend std::ostream& operator << (std::ostream& os, const StringConcat& obj) {
+        for (std::size_t i = 0; i < N; i++)
+            os.write(obj._pieces[i].data(), static_cast<std::streamsize>(obj._pieces[i]._length));
+        return os;
+    }
+
+    /**
+     * Extend the concatenation with another concatenation.
+     */
+    template < std::size_t M >
+    friend StringConcat<N + M> operator + (const StringConcat& lhs, const StringConcat<M>& rhs) noexcept {
+        return StringConcat<N + M>(lhs, rhs);
+    }
+
+    /**
+     * Extend the concatenation with a C string.
+     */
+    friend StringConcat<N + 1> operator + (const StringConcat& lhs, const char* rhs) noexcept {
+        return StringConcat<N + 1>(lhs, StringConcat<1>(MakePiece(rhs)));
+    }
+
+    /**
+     * Prepend a C string to the concatenation.
+     */
+    friend StringConcat<N + 1> operator + (const char* lhs, const StringConcat& rhs) noexcept {
+        return StringConcat<N + 1>(StringConcat<1>(MakePiece(lhs)), rhs);
+    }
+
+    /**
+     * Extend the concatenation with a std::string.
+     */
+    friend StringConcat<N + 1> operator + (const StringConcat& lhs, const std::string& rhs) noexcept {
+        return StringConcat<N + 1>(lhs, StringConcat<1>(MakePiece(rhs)));
+    }
+
+    /**
+     * Prepend a std::string to the concatenation.
+     */
+    friend StringConcat<N + 1> operator + (const std::string& lhs, const StringConcat& rhs) noexcept {
+        return StringConcat<N + 1>(StringConcat<1>(MakePiece(lhs)), rhs);
+    }
+
+    /**
+     * Extend the concatenation with a char.
+     */
+    friend StringConcat<N + 1> operator + (const StringConcat& lhs, const char rhs) noexcept {
+        return StringConcat<N + 1>(lhs, StringConcat<1>(MakePiece(rhs)));
     }
 
-    bool operator!=(const Iterator<T>& a) {
-        return _data != a._data;
+    /**
+     * Prepend a char to the concatenation.
+     */
+    friend StringConcat<N + 1> operator + (const char lhs, const StringConcat& rhs) noexcept {
+        return StringConcat<N + 1>(StringConcat<1>(MakePiece(lhs)), rhs);
     }
 };
 
+class String;
+
+/**
+ * The grammar shared by 'String::format' and its compile-time check. A format
+ * string is literal text with '{}' placeholders, filled by the arguments in
+ * order, and '{{' and '}}' for literal braces. A placeholder may give a spec
+ * after a colon:
+ *
+ *  - '{:x}' and '{:X}' format an integer in lower or upper case hex.
+ *  - '{:.N}' formats a floating point value with N (0 to 20) decimal places.
+ *
+ * Without a spec integers are decimal, floating point values use the shortest
+ * form that reads back to the same value, bools are 'true' or 'false' and
+ * text and chars are copied as they are.
+ */
+class StringFormat {
+public:
+
+    /**
+     * The most decimal places a '{:.N}' spec can ask for.
+     */
+    static constexpr int MAX_PRECISION = 20;
+
+    /**
+     * The kind of value an argument is, which decides the specs it accepts.
+     */
+    enum class Kind : uint8_t { text, character, boolean, integer, floating, unsupported };
+
+    /**
+     * A parsed placeholder spec. '_type' is 'x' or 'X' for hex, or zero, and
+     * '_precision' is the decimal places, or -1 for the shortest form.
+     */
+    struct Spec {
+        char _type = '\0';
+        int _precision = -1;
+    };
+
+    /**
+     * Stops argument types being deduced from the format string, so they are
+     * only deduced from the arguments.
+     */
+    template < typename T >
+    struct Identity {
+        using type = T;
+    };
+
+    /**
+     * Returns the kind of a T argument.
+     */
+    template < typename T >
+    static constexpr Kind KindOf() {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>)
+            return Kind::boolean;
+        else if constexpr (std::is_same_v<U, char>)
+            return Kind::character;
+        else if constexpr (std::is_integral_v<U>)
+            return Kind::integer;
+        else if constexpr (std::is_floating_point_v<U>)
+            return Kind::floating;
+        else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*> ||
+                           std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view> ||
+                           std::is_same_v<U, String>)
+            return Kind::text;
+        else
+            return Kind::unsupported;
+    }
+
+    /**
+     * @brief   Parse the spec TEXT, the part of a placeholder after the colon,
+     *          for an argument of KIND into SPEC.
+     *
+     * @return  Null if the spec is valid for KIND, or a message saying why
+     *          not.
+     */
+    static constexpr const char* ParseSpec(const std::string_view text, const Kind kind, Spec& spec) {
+        if (text.empty())
+            return nullptr;
+        if (text == "x" || text == "X") {
+            if (kind != Kind::integer)
+                return "'{:x}' and '{:X}' format integers only";
+            spec._type = text[0];
+            return nullptr;
+        }
+        if (text[0] == '.' && text.size() >= 2 && text.size() <= 3) {
+            int precision = 0;
+            for (std::size_t i = 1; i < text.size(); i++) {
+                if (text[i] < '0' || text[i] > '9')
+                    return "'{:.N}' needs a number of decimal places";
+                precision = precision * 10 + (text[i] - '0');
+            }
+            if (precision > MAX_PRECISION)
+                return "'{:.N}' allows at most 20 decimal places";
+            if (kind != Kind::floating)
+                return "'{:.N}' formats floating point values only";
+            spec._precision = precision;
+            return nullptr;
+        }
+        return "unknown format spec, expected '{:x}', '{:X}' or '{:.N}'";
+    }
+
+    /**
+     * @brief   Walk FORMAT for arguments of the COUNT KINDS, calling
+     *          LITERAL(std::string_view) for each run of literal text and
+     *          FIELD(index, Spec) for each placeholder, in order.
+     *
+     * @return  Null if FORMAT is valid for the arguments, or a message
+     *          saying why not.
+     */
+    template < typename Literal, typename Field >
+    static constexpr const char* Walk(const std::string_view format, const Kind* kinds, const std::size_t count,
+                                      Literal&& literal, Field&& field) {
+        std::size_t index = 0;
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < format.size(); i++) {
+            const char c = format[i];
+            if (c != '{' && c != '}')
+                continue;
+
+            literal(format.substr(start, i - start));
+            if (i + 1 < format.size() && format[i + 1] == c) {
+                //  An escaped brace, keep the second one as literal text
+                start = ++i;
+                continue;
+            }
+            if (c == '}')
+                return "unmatched '}' in format string, use '}}' for a literal brace";
+
+            const std::size_t close = format.find('}', i + 1);
+            if (close == std::string_view::npos)
+                return "unterminated '{' in format string, use '{{' for a literal brace";
+            const std::string_view inner = format.substr(i + 1, close - i - 1);
+            if (!inner.empty() && inner[0] != ':')
+                return "placeholders must be '{}' or '{:spec}'";
+            if (index >= count)
+                return "more placeholders than arguments in format string";
+
+            Spec spec;
+            const char* error = ParseSpec(inner.empty() ? inner : inner.substr(1), kinds[index], spec);
+            if (error != nullptr)
+                return error;
+            field(index++, spec);
+            start = i = close;
+            start++;
+        }
+        literal(format.substr(start));
+        return index == count ? nullptr : "fewer placeholders than arguments in format string";
+    }
+
+    /**
+     * One argument converted to text for 'String::format': a view of the
+     * argument itself for text, or of the formatted digits in '_buffer'.
+     */
+    struct Argument {
+        std::string_view _view;
+        char _buffer[64];
+    };
+
+    /**
+     * Convert VALUE to text in ARGUMENT as SPEC asks.
+     */
+    template < typename T >
+    static void Convert(Argument& argument, const Spec& spec, const T& value) {
+        constexpr Kind kind = KindOf<T>();
+        char* const first = argument._buffer;
+        char* const last = first + sizeof(argument._buffer);
+
+        if constexpr (kind == Kind::text) {
+            using U = std::decay_t<T>;
+            if constexpr (std::is_array_v<T>)
+                argument._view = std::string_view(value);
+            else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>)
+                argument._view = value != nullptr ? std::string_view(value) : std::string_view();
+            else if constexpr (std::is_same_v<U, String>)
+                argument._view = std::string_view(value.c_str(), value.size());
+            else
+                argument._view = std::string_view(value);
+        } else if constexpr (kind == Kind::character) {
+            first[0] = value;
+            argument._view = std::string_view(first, 1);
+        } else if constexpr (kind == Kind::boolean) {
+            argument._view = value ? "true" : "false";
+        } else if constexpr (kind == Kind::integer) {
+            const std::to_chars_result written = std::to_chars(first, last, value, spec._type != '\0' ? 16 : 10);
+            if (spec._type == 'X') {
+                for (char* p = first; p < written.ptr; p++)
+                    *p = (*p >= 'a' && *p <= 'f') ? static_cast<char>(*p - 'a' + 'A') : *p;
+            }
+            argument._view = std::string_view(first, static_cast<std::size_t>(written.ptr - first));
+        } else if constexpr (kind == Kind::floating) {
+            std::to_chars_result written = spec._precision < 0
+                ? std::to_chars(first, last, value)
+                : std::to_chars(first, last, value, std::chars_format::fixed, spec._precision);
+            //  Values too large for fixed notation in the buffer
+            if (written.ec != std::errc())
+                written = std::to_chars(first, last, value, std::chars_format::general, spec._precision);
+            argument._view = std::string_view(first, static_cast<std::size_t>(written.ptr - first));
+        }
+    }
+};
+
+#if defined(__cpp_consteval)
+/**
+ * Defined when String::format checks its format strings at compile time,
+ * which needs C++20. Before C++20 they are checked when formatting, and a bad
+ * format string throws std::invalid_argument.
+ */
+#define STRING_FORMAT_COMPILE_TIME_CHECKS 1
+#define STRING_FORMAT_CONSTEVAL consteval
+#else
+#define STRING_FORMAT_CONSTEVAL constexpr
+#endif
+
+/**
+ * A format string for 'String::format' with arguments of types ARGS. Under
+ * C++20 the string is checked against the argument types when it is
+ * constructed, at compile time, so a wrong number of placeholders, an
+ * unmatched brace or a spec that does not suit its argument fails to compile.
+ *
+ * @tparam Args     The types of the arguments to format.
+ */
+template < typename... Args >
+class FormatString {
+private:
+
+    std::string_view _format;
+
+public:
+
+    /**
+     * Check and hold FORMAT, which must be a constant expression under C++20.
+     */
+    template < typename S, typename = std::enable_if_t<std::is_convertible_v<const S&, std::string_view>> >
+    STRING_FORMAT_CONSTEVAL FormatString(const S& format) : _format(format) {
+        constexpr StringFormat::Kind kinds[] = { StringFormat::KindOf<Args>()..., StringFormat::Kind::text };
+        const char* error = StringFormat::Walk(_format, kinds, sizeof...(Args),
+            [](std::string_view) {}, [](std::size_t, const StringFormat::Spec&) {});
+        if (error != nullptr)
+            throw std::invalid_argument(error);     //  The format string does not match its arguments
+    }
+
+    /**
+     * Returns the format string.
+     */
+    constexpr std::string_view view() const noexcept { return _format; }
+};
+
 /**
  * The custom String class has been created to replicate high-level
  * functionality that you might expect when using C# strings such
@@ -52,6 +595,16 @@ public:
  * been rewritten to be more simple and more like C# functionality.
  * All String class objects are null-terminated to prevent stack
  * overflow errors.
+ *
+ * Storage is allocated from a std::pmr::memory_resource, the default
+ * resource unless one is given on construction. Strings derived from
+ * another String (substr, split, replace, trim and the case conversions)
+ * are allocated from the same resource as their source, so everything
+ * built while parsing one input can come from a single arena, such as a
+ * std::pmr::monotonic_buffer_resource, and be released in one go. Copies
+ * use the default resource unless one is given, so a copy can safely
+ * outlive the arena its source came from. A String must not outlive the
+ * resource it was allocated from.
  */
 class String {
 private:
@@ -63,11 +616,372 @@ private:
      * The string (C strings are stored as char arrays - a char pointer
      * is a char array). This is not exposed as the String class object
      * itself can be returned as a std::string and char pointer (or a
-     * const char pointer if using the 'c_str()' function).
+     * const char pointer if using the 'c_str()' function). Points at a
+     * shared empty buffer until something is stored.
      */
     char* _str;
 
-    const std::string WHITESPACE = " \n\r\t\f\v";
+    /**
+     * The number of characters stored, not including the null-terminator.
+     */
+    std::size_t _length;
+
+    /**
+     * The number of characters the buffer can hold, not including the
+     * null-terminator. Zero while '_str' points at the shared empty buffer.
+     */
+    std::size_t _capacity;
+
+    /**
+     * The memory resource the buffer is allocated from.
+     */
+    std::pmr::memory_resource* _resource;
+
+    /**
+     * The hash of the contents, computed by 'hash()' the first time it is
+     * needed and cleared by every function that can change the contents.
+     * Zero means it has not been computed. Atomic so that 'hash()' can be
+     * called on a String shared between threads, as any const function can.
+     */
+    mutable std::atomic<std::size_t> _hash;
+
+    /**
+     * The characters removed by the trim functions. Held once for the class
+     * rather than as a std::string member on every String object.
+     */
+    static constexpr const char* WHITESPACE = " \n\r\t\f\v";
+
+    /**
+     * Returns true if C is one of the WHITESPACE characters.
+     */
+    static bool IsWhitespace(const char c) {
+        return c != '\0' && strchr(WHITESPACE, c) != nullptr;
+    }
+
+    /**
+     * The buffer shared by every String that has nothing allocated, so blank
+     * and moved-from Strings do not need an allocation. It is never written:
+     * a String gets a buffer of its own before handing out anything its
+     * chars can be changed through, see 'Writable'. Read-only, so a write
+     * that slips through faults rather than changing every blank String.
+     */
+    static char* EmptyBuffer() {
+        static const char empty[1] = { '\0' };
+        return const_cast<char*>(empty);
+    }
+
+    //  ###################### ASCII case folding ####################
+    //  ##############################################################
+
+    /**
+     * Fold an upper case ASCII char to lower case. Every other char,
+     * including non-ASCII bytes, is returned unchanged.
+     */
+    static char FoldChar(const char c) noexcept {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+    }
+
+    /**
+     * Load 8 bytes from DATA, which need not be aligned.
+     */
+    static std::uint64_t LoadWord(const char* data) noexcept {
+        std::uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    /**
+     * Return a mask with 0x20 set in every byte of WORD that is an ASCII
+     * char between LOW and HIGH, computed for all 8 bytes at once without
+     * branches. Bytes with the high bit set never match.
+     */
+    static std::uint64_t RangeMask(const std::uint64_t word, const char low, const char high) noexcept {
+        constexpr std::uint64_t ones = 0x0101010101010101ULL;
+        constexpr std::uint64_t highBits = 0x8080808080808080ULL;
+        const std::uint64_t heptets = word & ~highBits;
+        const std::uint64_t aboveHigh = heptets + ones * static_cast<std::uint64_t>(0x7F - high);
+        const std::uint64_t atLeastLow = heptets + ones * static_cast<std::uint64_t>(0x80 - low);
+        return ((atLeastLow ^ aboveHigh) & ~word & highBits) >> 2;
+    }
+
+#if defined(__SSE2__)
+    /**
+     * Return a mask with 0x20 set in every byte of BLOCK that is an ASCII
+     * char between LOW and HIGH. Bytes with the high bit set are negative as
+     * signed chars, so they never match.
+     */
+    static __m128i RangeMask(const __m128i block, const char low, const char high) noexcept {
+        const __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(low - 1))),
+                                              _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(high + 1))));
+        return _mm_and_si128(inRange, _mm_set1_epi8(0x20));
+    }
+#endif
+
+    /**
+     * Convert LENGTH chars at DATA to lower case (LOWER true) or upper case
+     * (LOWER false) in place. Only ASCII letters change. Uses 16 byte SSE2
+     * blocks where available and 8 byte words otherwise.
+     */
+    static void FoldCase(char* data, const std::size_t length, const bool lower) noexcept {
+        const char low = lower ? 'A' : 'a';
+        const char high = lower ? 'Z' : 'z';
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 16 <= length; i += 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            //  Lower case sets the 0x20 bit of the letters, upper case clears it
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+                             _mm_xor_si128(block, RangeMask(block, low, high)));
+        }
+#endif
+        for (; i + 8 <= length; i += 8) {
+            std::uint64_t word = LoadWord(data + i);
+            word ^= RangeMask(word, low, high);
+            memcpy(data + i, &word, sizeof(word));
+        }
+        for (; i < length; i++) {
+            if (data[i] >= low && data[i] <= high)
+                data[i] = static_cast<char>(data[i] ^ 0x20);
+        }
+    }
+
+    /**
+     * Returns true if the LENGTH chars at LHS and RHS are equal ignoring
+     * ASCII case. Folds both sides in registers, so no lowered copy is made.
+     */
+    static bool FoldedEquals(const char* lhs, const char* rhs, const std::size_t length) noexcept {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 16 <= length; i += 16) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+            const __m128i foldedA = _mm_or_si128(a, RangeMask(a, 'A', 'Z'));
+            const __m128i foldedB = _mm_or_si128(b, RangeMask(b, 'A', 'Z'));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(foldedA, foldedB)) != 0xFFFF)
+                return false;
+        }
+#endif
+        for (; i + 8 <= length; i += 8) {
+            const std::uint64_t a = LoadWord(lhs + i);
+            const std::uint64_t b = LoadWord(rhs + i);
+            if ((a | RangeMask(a, 'A', 'Z')) != (b | RangeMask(b, 'A', 'Z')))
+                return false;
+        }
+        for (; i < length; i++) {
+            if (FoldChar(lhs[i]) != FoldChar(rhs[i]))
+                return false;
+        }
+        return true;
+    }
+
+    //  ########################### Hashing ##########################
+    //  ##############################################################
+
+    /**
+     * Multiply A and B to 128 bits and return the low and high halves in A
+     * and B.
+     */
+    static void Multiply(std::uint64_t& a, std::uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<std::uint64_t>(product);
+        b = static_cast<std::uint64_t>(product >> 64);
+#else
+        const std::uint64_t aHigh = a >> 32, aLow = static_cast<std::uint32_t>(a);
+        const std::uint64_t bHigh = b >> 32, bLow = static_cast<std::uint32_t>(b);
+        const std::uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+        const std::uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        const std::uint64_t middle = (lowLow >> 32) + static_cast<std::uint32_t>(highLow) + static_cast<std::uint32_t>(lowHigh);
+        a = (middle << 32) | static_cast<std::uint32_t>(lowLow);
+        b = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+#endif
+    }
+
+    /**
+     * Multiply A and B to 128 bits and fold the halves together.
+     */
+    static std::uint64_t Mix(std::uint64_t a, std::uint64_t b) noexcept {
+        Multiply(a, b);
+        return a ^ b;
+    }
+
+    /**
+     * Hash LENGTH bytes at DATA with the wyhash construction: 48 bytes per
+     * round over three independent lanes, a single multiply for inputs of
+     * 16 bytes or less, and no per-byte loop. When FOLD is true every load
+     * is ASCII lower-cased in its register first, giving a case-insensitive
+     * hash without a lowered copy. Never returns zero, which '_hash' uses to
+     * mean 'not computed'.
+     */
+    template < bool Fold >
+    static std::size_t HashBytes(const char* data, const std::size_t length) noexcept {
+        constexpr std::uint64_t secret0 = 0xA0761D6478BD642FULL;
+        constexpr std::uint64_t secret1 = 0xE7037ED1A0B428DBULL;
+        constexpr std::uint64_t secret2 = 0x8EBC6AF09C88C6E3ULL;
+        constexpr std::uint64_t secret3 = 0x589965CC75374CC3ULL;
+
+        auto read8 = [](const char* p) noexcept {
+            const std::uint64_t word = LoadWord(p);
+            return Fold ? (word | RangeMask(word, 'A', 'Z')) : word;
+        };
+        auto read4 = [](const char* p) noexcept {
+            std::uint32_t half;
+            memcpy(&half, p, sizeof(half));
+            const std::uint64_t word = half;
+            return Fold ? (word | RangeMask(word, 'A', 'Z')) : word;
+        };
+        auto read1 = [](const char c) noexcept {
+            return static_cast<std::uint64_t>(static_cast<unsigned char>(Fold ? FoldChar(c) : c));
+        };
+
+        std::uint64_t seed = Mix(secret0, secret1);
+        std::uint64_t a = 0;
+        std::uint64_t b = 0;
+        if (length <= 16) {
+            if (length >= 4) {
+                const std::size_t offset = (length >> 3) << 2;
+                a = (read4(data) << 32) | read4(data + offset);
+                b = (read4(data + length - 4) << 32) | read4(data + length - 4 - offset);
+            } else if (length > 0) {
+                a = (read1(data[0]) << 16) | (read1(data[length >> 1]) << 8) | read1(data[length - 1]);
+            }
+        } else {
+            const char* p = data;
+            std::size_t remaining = length;
+            if (remaining > 48) {
+                std::uint64_t lane1 = seed;
+                std::uint64_t lane2 = seed;
+                do {
+                    seed = Mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                    lane1 = Mix(read8(p + 16) ^ secret2, read8(p + 24) ^ lane1);
+                    lane2 = Mix(read8(p + 32) ^ secret3, read8(p + 40) ^ lane2);
+                    p += 48;
+                    remaining -= 48;
+                } while (remaining > 48);
+                seed ^= lane1 ^ lane2;
+            }
+            while (remaining > 16) {
+                seed = Mix(read8(p) ^ secret1, read8(p + 8) ^ seed);
+                p += 16;
+                remaining -= 16;
+            }
+            a = read8(p + remaining - 16);
+            b = read8(p + remaining - 8);
+        }
+
+        a ^= secret1;
+        b ^= seed;
+        Multiply(a, b);
+        const std::uint64_t hash = Mix(a ^ secret0 ^ length, b ^ secret1);
+        const std::size_t result = static_cast<std::size_t>(sizeof(std::size_t) < 8 ? hash ^ (hash >> 32) : hash);
+        return result != 0 ? result : 1;
+    }
+
+    //  ###################### Storage management ####################
+    //  ##############################################################
+
+    /**
+     * Set up an empty String drawing from RESOURCE, or from the default
+     * resource if RESOURCE is null.
+     */
+    void Initialise(std::pmr::memory_resource* resource) {
+        _str = EmptyBuffer();
+        _length = 0;
+        _capacity = 0;
+        _resource = (resource != nullptr ? resource : std::pmr::get_default_resource());
+        _hash.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Release the buffer back to the memory resource, if one is held.
+     */
+    void Release() {
+        if (_capacity > 0)
+            _resource->deallocate(_str, _capacity + 1, alignof(char));
+        _str = EmptyBuffer();
+        _capacity = 0;
+    }
+
+    /**
+     * Grow the buffer so it can hold at least CAPACITY characters, keeping
+     * the current contents.
+     */
+    void Grow(const std::size_t capacity) {
+        if (capacity <= _capacity)
+            return;
+        char* buff = static_cast<char*>(_resource->allocate(capacity + 1, alignof(char)));
+        memcpy(buff, _str, _length + 1);
+        Release();
+        _str = buff;
+        _capacity = capacity;
+    }
+
+    /**
+     * Returns the chars to hand out for writing, with the cached hash
+     * cleared. A String still on the shared empty buffer gets its own.
+     */
+    char* Writable() {
+        _hash.store(0, std::memory_order_relaxed);
+        if (_capacity == 0)
+            Grow(1);
+        return _str;
+    }
+
+    /**
+     * Replace the contents with LENGTH characters from DATA, reusing the
+     * buffer if it is large enough. DATA may point into this String.
+     */
+    void Assign(const char* data, const std::size_t length) {
+        _hash.store(0, std::memory_order_relaxed);
+        if (length > _capacity) {
+            char* buff = static_cast<char*>(_resource->allocate(length + 1, alignof(char)));
+            memcpy(buff, data, length);
+            Release();
+            _str = buff;
+            _capacity = length;
+        } else if (length > 0) {
+            memmove(_str, data, length);
+        }
+        _length = length;
+        if (_capacity > 0)
+            _str[_length] = '\0';
+    }
+
+    /**
+     * Append LENGTH characters from DATA, growing the buffer geometrically so
+     * repeated appends are amortised. DATA may point into this String.
+     */
+    void Append(const char* data, const std::size_t length) {
+        if (length == 0)
+            return;
+        _hash.store(0, std::memory_order_relaxed);
+        const std::size_t required = _length + length;
+        if (required > _capacity) {
+            const std::size_t grown = _capacity * 2;
+            char* buff = static_cast<char*>(_resource->allocate(
+                (grown > required ? grown : required) + 1, alignof(char)));
+            memcpy(buff, _str, _length);
+            memcpy(buff + _length, data, length);
+            Release();
+            _str = buff;
+            _capacity = (grown > required ? grown : required);
+        } else {
+            memmove(_str + _length, data, length);
+        }
+        _length = required;
+        _str[_length] = '\0';
+    }
+
+    /**
+     * A view of the characters in a 'join' part or separator.
+     */
+    static std::string_view ViewOf(const String& source) noexcept { return { source._str, source._length }; }
+    static std::string_view ViewOf(const std::string& source) noexcept { return source; }
+    static std::string_view ViewOf(const std::string_view source) noexcept { return source; }
+    static std::string_view ViewOf(const char* source) noexcept {
+        return source != nullptr ? std::string_view(source) : std::string_view();
+    }
+    static std::string_view ViewOf(const char& source) noexcept { return { &source, 1 }; }
 
     //  ############ Match to other overloading operators ############
     //  ##############################################################
@@ -81,133 +995,263 @@ private:
     }
 
     /**
-     * Prototype plus ( + ) operator to concatenate String and String.
+     * Wrap this String as the single piece of a concatenation.
      */
-    friend String operator + (const String& lhs, const String& rhs) {
-        int length = strlen(lhs._str) + strlen(rhs._str);
-        char* buff = new char[length + 1];
+    StringConcat<1> Concat() const noexcept {
+        return StringConcat<1>({ _str, _length, '\0' }, _resource);
+    }
 
-        strcpy(buff, lhs._str);
-        strcat(buff, rhs._str);
-        buff[length] = '\0';
-        String temp{ buff };
-        delete[] buff;
-        return temp;
+    /**
+     * Prototype plus ( + ) operator to concatenate String and String. Every
+     * plus ( + ) operator returns a StringConcat, so a chain such as
+     * 'a + b + c' is copied once, into a single allocation, when it is
+     * assigned to a String. The result uses the memory resource of the
+     * leftmost String operand.
+     */
+    friend StringConcat<2> operator + (const String& lhs, const String& rhs) noexcept {
+        return StringConcat<2>(lhs.Concat(), rhs.Concat());
     }
 
     /**
-     * Prototype plus ( + ) operator to concatenate String and const char.
+     * Prototype plus ( + ) operator to concatenate String and const char*.
      */
-    friend String operator + (const String& lhs, const char& rhs) {
-        int length = strlen(lhs._str) + 1;
-        char* buff = new char[length + 1];
+    friend StringConcat<2> operator + (const String& lhs, const char* rhs) noexcept {
+        return StringConcat<2>(lhs.Concat(), StringConcat<1>(StringConcat<1>::MakePiece(rhs)));
+    }
 
-        std::string std_temp(1, rhs);
-        strcpy(buff, lhs._str);
-        strcat(buff, std_temp.c_str());
-        buff[length] = '\0';
-        String temp{ buff };
-        delete[] buff;
-        return temp;
+    /**
+     * Prototype plus ( + ) operator to concatenate const char* and String.
+     */
+    friend StringConcat<2> operator + (const char* lhs, const String& rhs) noexcept {
+        return StringConcat<2>(StringConcat<1>(StringConcat<1>::MakePiece(lhs)), rhs.Concat());
+    }
+
+    /**
+     * Prototype plus ( + ) operator to concatenate String and std::string.
+     */
+    friend StringConcat<2> operator + (const String& lhs, const std::string& rhs) noexcept {
+        return StringConcat<2>(lhs.Concat(), StringConcat<1>(StringConcat<1>::MakePiece(rhs)));
+    }
+
+    /**
+     * Prototype plus ( + ) operator to concatenate std::string and String.
+     */
+    friend StringConcat<2> operator + (const std::string& lhs, const String& rhs) noexcept {
+        return StringConcat<2>(StringConcat<1>(StringConcat<1>::MakePiece(lhs)), rhs.Concat());
+    }
+
+    /**
+     * Prototype plus ( + ) operator to concatenate String and const char.
+     */
+    friend StringConcat<2> operator + (const String& lhs, const char rhs) noexcept {
+        return StringConcat<2>(lhs.Concat(), StringConcat<1>(StringConcat<1>::MakePiece(rhs)));
     }
 
     /**
      * Prototype plus ( + ) operator to concatenate const char and String.
      */
-    friend String operator + (const char& lhs, const String& rhs) {
-        int length = strlen(rhs._str) + 1;
-        char* buff = new char[length + 1];
+    friend StringConcat<2> operator + (const char lhs, const String& rhs) noexcept {
+        return StringConcat<2>(StringConcat<1>(StringConcat<1>::MakePiece(lhs)), rhs.Concat());
+    }
 
-        std::string std_temp(1, lhs);
-        strcpy(buff, std_temp.c_str());
-        strcat(buff, rhs._str);
-        buff[length] = '\0';
-        String temp{ buff };
-        delete[] buff;
-        return temp;
+    /**
+     * Prototype plus ( + ) operator to extend a concatenation with a String.
+     */
+    template < std::size_t N >
+    friend StringConcat<N + 1> operator + (const StringConcat<N>& lhs, const String& rhs) noexcept {
+        return StringConcat<N + 1>(lhs, rhs.Concat());
+    }
+
+    /**
+     * Prototype plus ( + ) operator to prepend a String to a concatenation.
+     */
+    template < std::size_t N >
+    friend StringConcat<N + 1> operator + (const String& lhs, const StringConcat<N>& rhs) noexcept {
+        return StringConcat<N + 1>(lhs.Concat(), rhs);
     }
 
 public:
 
+    //  ###################### Container types #######################
+    //  ##############################################################
+
+    using value_type = char;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = char&;
+    using const_reference = const char&;
+    using pointer = char*;
+    using const_pointer = const char*;
+    using iterator = Iterator<char>;
+    using const_iterator = Iterator<const char>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
     //  ##### Constructors / initialisation assignment operators #####
     //  ##############################################################
 
     /**
-     * Construct a blank String.
+     * Construct a blank String. Nothing is allocated until data is stored.
+     */
+    String() { Initialise(nullptr); }
+
+    /**
+     * Construct a blank String that allocates from RESOURCE.
+     */
+    explicit String(std::pmr::memory_resource* resource) { Initialise(resource); }
+
+    /**
+     * Construct a new String object from a std::string variable. Characters
+     * are copied up to the first null-terminator. Allocates from RESOURCE,
+     * or the default resource if RESOURCE is null.
      */
-    String()
-        : _str{ nullptr } {
-        _str = new char[1];
-        _str[0] = '\0';
+    String(const std::string& source, std::pmr::memory_resource* resource = nullptr) {
+        Initialise(resource);
+        Assign(source.c_str(), strlen(source.c_str()));
     }
 
     /**
-     * Construct a new String object from a std::string variable.
+     * Construct a new String object from a const char* variable. Allocates
+     * from RESOURCE, or the default resource if RESOURCE is null.
      */
-    String(const std::string& source) {
-        _str = new char[strlen(source.c_str()) + 1];
-        strcpy(_str, source.c_str());
-        _str[strlen(source.c_str())] = '\0';
+    String(const char* source, std::pmr::memory_resource* resource = nullptr) {
+        Initialise(resource);
+        if (source != nullptr)
+            Assign(source, strlen(source));
     }
 
     /**
-     * Construct a new String object from a const char* variable.
+     * Construct a new String object from the first LENGTH characters at
+     * SOURCE, which does not need to be null-terminated. Allocates from
+     * RESOURCE, or the default resource if RESOURCE is null.
      */
-    String(const char* source) {
-        if (source == nullptr) {
-            _str = new char[1];
-            _str[0] = '\0';
-        } else {
-            _str = new char[strlen(source) + 1];
-            strcpy(_str, source);
-            _str[strlen(source)] = '\0';
-        }
+    String(const char* source, const std::size_t length,
+           std::pmr::memory_resource* resource = nullptr) {
+        Initialise(resource);
+        if (source != nullptr)
+            Assign(source, length);
+    }
+
+    /**
+     * Construct a new String object from a single char variable. Allocates
+     * from RESOURCE, or the default resource if RESOURCE is null.
+     */
+    String(const char source, std::pmr::memory_resource* resource = nullptr) {
+        Initialise(resource);
+        Assign(&source, 1);
     }
 
     /**
-     * Construct a new String object from a single char variable.
+     * Materialise a concatenation built with the plus ( + ) operator, with a
+     * single allocation. Allocates from the memory resource of the leftmost
+     * String operand, or the default resource if there is none.
      */
-    String(const char source) {
-        _str = new char[2];
-        _str[0] = source;
-        _str[1] = '\0';
+    template < std::size_t N >
+    String(const StringConcat<N>& source) {
+        Initialise(source.resource());
+        if (source.size() == 0)
+            return;
+        Grow(source.size());
+        _length = static_cast<std::size_t>(source.copy(_str) - _str);
+        _str[_length] = '\0';
     }
 
     /**
-     * The copy constructor for String class objects.
+     * The copy constructor for String class objects. The copy allocates from
+     * the default resource, see the class description.
      */
     String(const String& source) {
-        _str = new char[strlen(source._str) + 1];
-        strcpy(_str, source._str);
-        _str[strlen(source._str)] = '\0';
+        Initialise(nullptr);
+        Assign(source._str, source._length);
     }
 
     /**
-     * The move constructor for String class objects.
+     * Copy SOURCE into a new String that allocates from RESOURCE.
      */
-    String(String&& source) {
+    String(const String& source, std::pmr::memory_resource* resource) {
+        Initialise(resource);
+        Assign(source._str, source._length);
+    }
+
+    /**
+     * The move constructor for String class objects. SOURCE is left blank.
+     */
+    String(String&& source) noexcept {
         _str = source._str;
-        source._str = nullptr;
+        _length = source._length;
+        _capacity = source._capacity;
+        _resource = source._resource;
+        _hash.store(source._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        source._str = EmptyBuffer();
+        source._length = 0;
+        source._capacity = 0;
+        source._hash.store(0, std::memory_order_relaxed);
     }
 
     /**
      * Destroy this String object. Destructor for the String class.
      */
-    ~String() { delete _str; }
+    ~String() { Release(); }
 
     //  ########### Common overloaded assignment operators ###########
     //  ##############################################################
 
     /**
-     * The standard 'equal' assignment operator.
+     * The standard 'equal' assignment operator. Reuses the existing buffer
+     * when it is large enough, and keeps this String's memory resource.
      */
     String& operator = (const String& rhs) {
         if (this == &rhs)
             return *this;
-        delete[] _str;
-        _str = new char[strlen(rhs._str) + 1];
-        strcpy(_str, rhs._str);
-        _str[strlen(rhs._str)] = '\0';
+        Assign(rhs._str, rhs._length);
+        return *this;
+    }
+
+    /**
+     * The move assignment operator. Takes ownership of the buffer held by RHS
+     * rather than copying it when both use the same memory resource, and
+     * copies otherwise. Not noexcept, as std::pmr::string's is not: the copy
+     * allocates from this String's resource, which may throw.
+     */
+    String& operator = (String&& rhs) {
+        if (this == &rhs)
+            return *this;
+        if (_resource != rhs._resource && !_resource->is_equal(*rhs._resource)) {
+            Assign(rhs._str, rhs._length);
+            return *this;
+        }
+        std::swap(_str, rhs._str);
+        std::swap(_length, rhs._length);
+        std::swap(_capacity, rhs._capacity);
+        const std::size_t cached = _hash.load(std::memory_order_relaxed);
+        _hash.store(rhs._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        rhs._hash.store(cached, std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * Assign a concatenation built with the plus ( + ) operator, copying it
+     * once. Reuses the existing buffer when it is large enough, and this
+     * String may appear in the concatenation, as in 's = "<" + s + ">"'.
+     */
+    template < std::size_t N >
+    String& operator = (const StringConcat<N>& rhs) {
+        const std::size_t length = rhs.size();
+        _hash.store(0, std::memory_order_relaxed);
+        if (length > _capacity || rhs.overlaps(_str, _str + _length)) {
+            char* buff = static_cast<char*>(_resource->allocate(
+                (length > _capacity ? length : _capacity) + 1, alignof(char)));
+            rhs.copy(buff);
+            const std::size_t capacity = (length > _capacity ? length : _capacity);
+            Release();
+            _str = buff;
+            _capacity = capacity;
+        } else {
+            rhs.copy(_str);
+        }
+        _length = length;
+        if (_capacity > 0)
+            _str[_length] = '\0';
         return *this;
     }
 
@@ -215,44 +1259,151 @@ public:
      * The plus-equals ( += ) assignment operator.
      */
     String& operator += (const String& rhs) {
-        if (this == &rhs)
+        Append(rhs._str, rhs._length);
+        return *this;
+    }
+
+    /**
+     * The plus-equals ( += ) assignment operator for a C string.
+     */
+    String& operator += (const char* rhs) {
+        if (rhs != nullptr)
+            Append(rhs, strlen(rhs));
+        return *this;
+    }
+
+    /**
+     * The plus-equals ( += ) assignment operator for a char.
+     */
+    String& operator += (const char rhs) {
+        Append(&rhs, 1);
+        return *this;
+    }
+
+    /**
+     * The plus-equals ( += ) assignment operator for a concatenation, growing
+     * the buffer at most once. This String may appear in the concatenation.
+     */
+    template < std::size_t N >
+    String& operator += (const StringConcat<N>& rhs) {
+        const std::size_t length = rhs.size();
+        if (length == 0)
+            return *this;
+        _hash.store(0, std::memory_order_relaxed);
+        const std::size_t required = _length + length;
+        if (required > _capacity && rhs.overlaps(_str, _str + _length)) {
+            String appended(rhs);
+            Append(appended._str, appended._length);
             return *this;
-        String temp{ _str };
-        delete[] _str;
-        _str = new char[strlen(temp._str) + strlen(rhs._str) + 1];
-        strcpy(_str, temp._str);
-        strcat(_str, rhs._str);
-        _str[strlen(temp._str) + strlen(rhs._str)] = '\0';
+        }
+        if (required > _capacity) {
+            const std::size_t grown = _capacity * 2;
+            Grow(grown > required ? grown : required);
+        }
+        rhs.copy(_str + _length);
+        _length = required;
+        _str[_length] = '\0';
         return *this;
     }
 
     /**
      * Allow return data type to be std::string.
      */
-    operator std::string() { return _str; }
+    operator std::string() const { return std::string(_str, _length); }
     /**
-     * Allow return data type to char*.
+     * Allow return data type to char*. The cached hash is cleared, as the
+     * chars may be changed through the pointer.
      */
-    operator char* () { return _str; }
+    operator char* () { return Writable(); }
 
     //  ####### Existing string functions to mimic std::string #######
     //  ##############################################################
 
     /**
-     * The definition for the 'begin' iterator function.
+     * The definition for the 'begin' iterator function. The cached hash is
+     * cleared, as the chars may be changed through the iterator.
      */
-    Iterator<char> begin() {
-        Iterator<char> iter(_str);
-        return iter;
-    }
+    iterator begin() { return iterator(Writable()); }
 
     /**
-     * The definition for the 'end' iterator function.
+     * The definition for the 'end' iterator function. The cached hash is
+     * cleared, as the chars may be changed through the iterator.
      */
-    Iterator<char> end() {
-        Iterator<char> iter(_str + strlen(_str));
-        return iter;
-    }
+    iterator end() { return iterator(Writable() + _length); }
+
+    /**
+     * The definition for the const 'begin' iterator function.
+     */
+    const_iterator begin() const { return const_iterator(_str); }
+
+    /**
+     * The definition for the const 'end' iterator function.
+     */
+    const_iterator end() const { return const_iterator(_str + _length); }
+
+    /**
+     * The definition for the const 'cbegin' iterator function.
+     */
+    const_iterator cbegin() const { return begin(); }
+
+    /**
+     * The definition for the const 'cend' iterator function.
+     */
+    const_iterator cend() const { return end(); }
+
+    /**
+     * The definition for the 'rbegin' reverse iterator function.
+     */
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+    /**
+     * The definition for the 'rend' reverse iterator function.
+     */
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+
+    /**
+     * The definition for the const 'rbegin' reverse iterator function.
+     */
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+    /**
+     * The definition for the const 'rend' reverse iterator function.
+     */
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    /**
+     * The definition for the const 'crbegin' reverse iterator function.
+     */
+    const_reverse_iterator crbegin() const { return rbegin(); }
+
+    /**
+     * The definition for the const 'crend' reverse iterator function.
+     */
+    const_reverse_iterator crend() const { return rend(); }
+
+    /**
+     * Return the chars of this String, which are contiguous and
+     * null-terminated. The cached hash is cleared, as the chars may be
+     * changed through the pointer.
+     */
+    char* data() { return Writable(); }
+
+    /**
+     * Return the chars of this String, which are contiguous and
+     * null-terminated.
+     */
+    const char* data() const { return _str; }
+
+    /**
+     * Return the char at INDEX. INDEX is not range checked. The cached hash
+     * is cleared, as the char may be changed through the reference.
+     */
+    char& operator [] (const std::size_t index) { return Writable()[index]; }
+
+    /**
+     * Return the char at INDEX. INDEX is not range checked.
+     */
+    const char& operator [] (const std::size_t index) const { return _str[index]; }
 
     /**
      * Return this String as a const char*.
@@ -262,18 +1413,47 @@ public:
     /**
      * Get the character length of the String data.
      */
-    const int length() { return strlen(_str); }
+    int length() const { return static_cast<int>(_length); }
+
+    /**
+     * Get the character length of the String data as a size_t.
+     */
+    std::size_t size() const { return _length; }
+
+    /**
+     * Returns true if this String holds no characters.
+     */
+    bool empty() const { return _length == 0; }
+
+    /**
+     * Make sure the buffer can hold at least CAPACITY characters without
+     * reallocating.
+     */
+    void reserve(const std::size_t capacity) { Grow(capacity); }
+
+    /**
+     * Get the memory resource this String allocates from.
+     */
+    std::pmr::memory_resource* resource() const { return _resource; }
 
     /**
      * @brief   Get a substring.
      *
      * @param start     The start character index.
      * @param len       The number of characters onward from the start index.
-     * @return          A String object of the new String data.
+     *                  A negative value or a value running past the end takes
+     *                  the rest of the String.
+     * @return          A String object of the new String data, allocated from
+     *                  the same memory resource as this String.
+     * @throw           out_of_range if START is past the end of this String.
      */
-    String substr(const int start, const int len) {
-        std::string str = _str;
-        return String(str.substr(start, len).c_str());
+    String substr(const int start, const int len) const {
+        if (start < 0 || static_cast<std::size_t>(start) > _length)
+            throw std::out_of_range("String::substr: start is out of range");
+        const std::size_t remaining = _length - static_cast<std::size_t>(start);
+        const std::size_t count = (len < 0 || static_cast<std::size_t>(len) > remaining
+                                   ? remaining : static_cast<std::size_t>(len));
+        return String(_str + start, count, _resource);
     }
 
     //  ########### Existing string functions but modified ###########
@@ -288,27 +1468,48 @@ public:
      * @param b     The char to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(const char a, const char b) {
-        const int length = strlen(_str);
-        char* buff = new char[length + 1];
-
-        strcpy(buff, _str);
-        buff[length] = '\0';
+    String replace(const char a, const char b) const & {
+        String temp{ *this, _resource };
+        temp.replace_inplace(a, b);
+        return temp;
+    }
 
-//  Ignore the sign comparison warning as it does not affect main running code
-#pragma GCC diagnostic ignored "-Wsign-compare"
+    /**
+     * Replace all occurrences of char A with char B, reusing the buffer of
+     * this temporary String rather than allocating a new one.
+     */
+    String replace(const char a, const char b) && {
+        replace_inplace(a, b);
+        return std::move(*this);
+    }
 
-        for (int i = 0; i < strlen(buff); i++) {
-            if (buff[i] == a) {
-                buff[i] = b;
+    /**
+     * @brief   Replace all occurrences of a specified Unicode character in this
+     *          instance with another specified Unicode character, modifying
+     *          this String in place.
+     *
+     * @param a     The char being replaced.
+     * @param b     The char to replace with.
+     * @return      A reference to this String.
+     */
+    String& replace_inplace(const char a, const char b) {
+        _hash.store(0, std::memory_order_relaxed);
+        if (b == '\0') {
+            //  Replacing with the null-terminator ends the String at the
+            //  first occurrence.
+            char* first = static_cast<char*>(memchr(_str, a, _length));
+            if (first != nullptr) {
+                *first = '\0';
+                _length = first - _str;
             }
+            return *this;
         }
-
-#pragma GCC diagnostic pop
-
-        String temp = String(buff);
-        delete[] buff;
-        return temp;
+        for (char* c = _str; *c != '\0'; c++) {
+            if (*c == a) {
+                *c = b;
+            }
+        }
+        return *this;
     }
 
     /**
@@ -320,32 +1521,27 @@ public:
      * @param b     The string to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(const char* a, const char* b) {
+    String replace(const char* a, const char* b) const {
         if (a == nullptr || b == nullptr || a == NULL || b == NULL || strlen(a) < 1) {
-            return String(_str);
+            return String(*this, _resource);
         }
-        const int length = strlen(_str);
-        char* buff = new char[length + 1];
 
-        strcpy(buff, _str);
-        buff[length] = '\0';
+        const std::string_view source(_str, _length);
+        const std::string_view target(a);
+        const std::size_t length_b = strlen(b);
 
-        std::string s = buff;
+        String temp{ _resource };
+        temp.reserve(_length);
 
-        const int length_a = strlen(a);
+        size_t copied = 0;
         size_t pos = 0;
-        size_t diff = 0;
-        bool diffSet = false;
-        while ((pos = s.find(a, pos + diff)) != std::string::npos) {
-            s.replace(pos, length_a, b);
-            if (!diffSet) {
-                diff = strlen(b);
-                diffSet = true;
-            }
+        while ((pos = source.find(target, copied)) != std::string_view::npos) {
+            temp.Append(_str + copied, pos - copied);
+            temp.Append(b, length_b);
+            copied = pos + target.length();
         }
+        temp.Append(_str + copied, _length - copied);
 
-        String temp = String(s.c_str());
-        delete[] buff;
         return temp;
     }
 
@@ -358,7 +1554,7 @@ public:
      * @param b     The string to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(std::string a, std::string b) {
+    String replace(std::string a, std::string b) const {
         return replace(a.c_str(), b.c_str());
     }
 
@@ -371,12 +1567,11 @@ public:
      * @param b     The char to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(const char* a, const char b) {
+    String replace(const char* a, const char b) const {
         if (a == nullptr || a == NULL || strlen(a) < 1) {
-            return String(_str);
+            return String(*this, _resource);
         }
-        std::string temp(1, b);
-        const char* newB = temp.c_str();
+        const char newB[2] = { b, '\0' };
         return replace(a, newB);
     }
 
@@ -389,7 +1584,7 @@ public:
      * @param b     The char to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(std::string a, const char b) {
+    String replace(std::string a, const char b) const {
         return replace(a.c_str(), b);
     }
 
@@ -402,12 +1597,11 @@ public:
      * @param b     The string to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(const char a, const char* b) {
+    String replace(const char a, const char* b) const {
         if (b == nullptr || b == NULL || a == '\0') {
-            return String(_str);
+            return String(*this, _resource);
         }
-        std::string temp(1, a);
-        const char* newA = temp.c_str();
+        const char newA[2] = { a, '\0' };
         return replace(newA, b);
     }
 
@@ -420,7 +1614,7 @@ public:
      * @param b     The string to replace with.
      * @return      A String object of the new String data.
      */
-    String replace(const char a, std::string b) {
+    String replace(const char a, std::string b) const {
         return replace(a, b.c_str());
     }
 
@@ -429,147 +1623,743 @@ public:
 
     /**
      * @brief   Split this String into substrings based on the input delimiter
-     *          characters.
+     *          characters. Every substring is allocated from the same memory
+     *          resource as this String.
      *
-     * @param delim     The string delimiter to spli on.
-     * @return          A std::vector<String> object with
+     * @param delim     The string delimiter to split on. An empty delimiter
+     *                  returns the whole String as the only element.
+     * @return          A std::vector<String> object with each substring,
+     *                  including an empty String after a trailing delimiter.
      */
-    std::vector<String> split(const std::string delim) {
-        std::string str = _str;
-        str += delim;
+    std::vector<String> split(const std::string delim) const {
         std::vector<String> output;
+        if (delim.empty()) {
+            output.emplace_back(*this, _resource);
+            return output;
+        }
 
+        const std::string_view source(_str, _length);
+        size_t start = 0;
         size_t p = 0;
-        while ((p = str.find(delim)) != std::string::npos) {
-            String temp = str.substr(0, p).c_str();
-            output.push_back(temp);
-            str.erase(0, p + delim.length());
+        while ((p = source.find(delim, start)) != std::string_view::npos) {
+            output.emplace_back(_str + start, p - start, _resource);
+            start = p + delim.length();
         }
+        output.emplace_back(_str + start, _length - start, _resource);
 
         return output;
     }
 
     /**
      * @brief   Split this String into substrings based on the input delimiter
-     *          character.
+     *          character. Every substring is allocated from the same memory
+     *          resource as this String.
      *
-     * @param delim
-     * @return std::vector<String>
+     * @param delim     The char delimiter to split on.
+     * @return          A std::vector<String> object with each substring,
+     *                  including an empty String after a trailing delimiter.
      */
-    std::vector<String> split(const char delim) {
-        std::string str = _str;
-        str += delim;
+    std::vector<String> split(const char delim) const {
         std::vector<String> output;
 
-        size_t p = 0;
-        while ((p = str.find(delim)) != std::string::npos) {
-            String temp = str.substr(0, p).c_str();
-            output.push_back(temp);
-            str.erase(0, p + 1);
+        const char* start = _str;
+        const char* end = _str + _length;
+        const char* p = nullptr;
+        while ((p = static_cast<const char*>(memchr(start, delim, end - start))) != nullptr) {
+            output.emplace_back(start, static_cast<std::size_t>(p - start), _resource);
+            start = p + 1;
+        }
+        output.emplace_back(start, static_cast<std::size_t>(end - start), _resource);
+
+        return output;
+    }
+
+    /**
+     * @brief   Join every element of PARTS into one String, with SEPARATOR
+     *          between each pair. The total length is measured first, so the
+     *          result is allocated once and every part is copied once.
+     *
+     * @tparam Range        Any range of String, std::string, std::string_view,
+     *                      const char* or char elements.
+     * @tparam Separator    A String, std::string, std::string_view, const
+     *                      char* or char.
+     * @param parts         The parts to join.
+     * @param separator     Inserted between each pair of parts.
+     * @param resource      The memory resource to allocate from, or null for
+     *                      the default resource.
+     * @return              A String object of the joined parts.
+     */
+    template < typename Range, typename Separator >
+    static String join(const Range& parts, const Separator& separator,
+                       std::pmr::memory_resource* resource = nullptr) {
+        const std::string_view sep = ViewOf(separator);
+
+        std::size_t total = 0;
+        std::size_t count = 0;
+        for (const auto& part : parts) {
+            total += ViewOf(part).size();
+            count++;
         }
+        if (count > 1)
+            total += sep.size() * (count - 1);
+
+        String output{ resource };
+        output.reserve(total);
+        bool first = true;
+        for (const auto& part : parts) {
+            if (!first)
+                output.Append(sep.data(), sep.size());
+            first = false;
+            const std::string_view view = ViewOf(part);
+            output.Append(view.data(), view.size());
+        }
+
+        return output;
+    }
 
+    /**
+     * @brief   Format ARGS into a new String as FORMAT describes, such as
+     *          'String::format("{}:{}", host, port)'. Numbers are written
+     *          with std::to_chars, with no streams and no locale, and the
+     *          total length is measured first, so the result is allocated
+     *          once. See StringFormat for the placeholders and specs.
+     *
+     *          Under C++20 FORMAT must be a constant expression and is
+     *          checked against the argument types at compile time. Before
+     *          C++20 it is checked here and a bad format string throws
+     *          std::invalid_argument.
+     *
+     * @tparam Args     Text (String, std::string, std::string_view, C
+     *                  strings), chars, bools, integers or floating point
+     *                  values.
+     * @param format    The format string.
+     * @param args      The values for the placeholders, in order.
+     * @return          A String object of the formatted text.
+     */
+    template < typename... Args >
+    static String format(const FormatString<typename StringFormat::Identity<Args>::type...> format,
+                         const Args&... args) {
+        String output;
+        format_to(output, format, args...);
         return output;
     }
 
+    /**
+     * @brief   Format ARGS as FORMAT describes and append them to OUTPUT,
+     *          growing its buffer at most once, and geometrically so that
+     *          repeated calls are amortised. Reusing one String for
+     *          repeated messages avoids an allocation per message. OUTPUT
+     *          may also be one of the arguments. See 'format'.
+     *
+     * @param output    The String to append to.
+     * @param format    The format string.
+     * @param args      The values for the placeholders, in order.
+     */
+    template < typename... Args >
+    static void format_to(String& output, const FormatString<typename StringFormat::Identity<Args>::type...> format,
+                          const Args&... args) {
+        static_assert(((StringFormat::KindOf<Args>() != StringFormat::Kind::unsupported) && ...),
+                      "String::format arguments must be text, chars, bools, integers or floating point values");
+
+        constexpr StringFormat::Kind kinds[] = { StringFormat::KindOf<Args>()..., StringFormat::Kind::text };
+        StringFormat::Spec specs[sizeof...(Args) + 1];
+        std::size_t total = 0;
+        const char* error = StringFormat::Walk(format.view(), kinds, sizeof...(Args),
+            [&total](const std::string_view literal) { total += literal.size(); },
+            [&specs](const std::size_t index, const StringFormat::Spec& spec) { specs[index] = spec; });
+        if (error != nullptr)
+            throw std::invalid_argument(error);
+
+        StringFormat::Argument converted[sizeof...(Args) + 1];
+        std::size_t index = 0;
+        ((StringFormat::Convert(converted[index], specs[index], args), total += converted[index]._view.size(), index++), ...);
+        if (total == 0)
+            return;
+
+        //  The old buffer is released only once written, as an argument may
+        //  be a view of OUTPUT
+        const std::size_t required = output._length + total;
+        String previous(output._resource);
+        if (required > output._capacity) {
+            const std::size_t grown = output._capacity * 2;
+            const std::size_t capacity = (grown > required ? grown : required);
+            char* buff = static_cast<char*>(output._resource->allocate(capacity + 1, alignof(char)));
+            memcpy(buff, output._str, output._length);
+            previous._str = std::exchange(output._str, buff);
+            previous._capacity = std::exchange(output._capacity, capacity);
+        }
+        char* out = output._str + output._length;
+        StringFormat::Walk(format.view(), kinds, sizeof...(Args),
+            [&out](const std::string_view literal) {
+                if (!literal.empty())
+                    memcpy(out, literal.data(), literal.size());
+                out += literal.size();
+            },
+            [&out, &converted](const std::size_t index, const StringFormat::Spec&) {
+                const std::string_view text = converted[index]._view;
+                if (!text.empty())
+                    memcpy(out, text.data(), text.size());
+                out += text.size();
+            });
+        output._length += total;
+        output._str[output._length] = '\0';
+        output._hash.store(0, std::memory_order_relaxed);
+    }
+
     /**
      * Returns true if CONTENT appears in this String.
      */
-    bool contains(const char content) {
-        std::string str = _str;
-        return str.find(content) != std::string::npos;
+    bool contains(const char content) const {
+        return memchr(_str, content, _length) != nullptr;
     }
 
     /**
      * Returns true if CONTENT appears in this String.
      */
-    bool contains(const std::string content) {
-        std::string str = _str;
-        return str.find(content) != std::string::npos;
+    bool contains(const std::string content) const {
+        return std::string_view(_str, _length).find(content) != std::string_view::npos;
     }
 
     /**
      * Return a new String, trimming the leading (left-side) whitespace chars from the string.
      */
-    String ltrim() {
-        std::string s = _str;
-        size_t start = s.find_first_not_of(WHITESPACE);
-        return (start == std::string::npos ? "" : s.substr(start));
+    String ltrim() const & {
+        String temp{ *this, _resource };
+        temp.ltrim_inplace();
+        return temp;
     }
 
     /**
-     * Return a new String, trimming the trailing (left-side) whitespace chars from the string.
+     * Trim the leading whitespace chars, reusing the buffer of this temporary String.
      */
-    String rtrim() {
-        std::string s = _str;
-        size_t end = s.find_last_not_of(WHITESPACE);
-        return (end == std::string::npos ? "" : s.substr(0, end + 1));
+    String ltrim() && {
+        ltrim_inplace();
+        return std::move(*this);
     }
 
     /**
-     * Return a new String, trimming the leading and trailing whitespace char's from the string.
+     * Trim the leading (left-side) whitespace chars from this String in place.
      */
-    String trim() {
-        std::string s = _str;
-        auto start = s.begin();
-        while (start != s.end() && std::isspace(*start)) {
+    String& ltrim_inplace() {
+        std::size_t start = 0;
+        while (start < _length && IsWhitespace(_str[start])) {
             start++;
         }
+        if (start != 0) {
+            _hash.store(0, std::memory_order_relaxed);
+            _length -= start;
+            memmove(_str, _str + start, _length + 1);
+        }
+        return *this;
+    }
+
+    /**
+     * Return a new String, trimming the trailing (right-side) whitespace chars from the string.
+     */
+    String rtrim() const & {
+        String temp{ *this, _resource };
+        temp.rtrim_inplace();
+        return temp;
+    }
+
+    /**
+     * Trim the trailing whitespace chars, reusing the buffer of this temporary String.
+     */
+    String rtrim() && {
+        rtrim_inplace();
+        return std::move(*this);
+    }
 
-        auto end = s.end();
-        do {
+    /**
+     * Trim the trailing (right-side) whitespace chars from this String in place.
+     */
+    String& rtrim_inplace() {
+        std::size_t end = _length;
+        while (end > 0 && IsWhitespace(_str[end - 1])) {
             end--;
-        } while (std::distance(start, end) > 0 && std::isspace(*end));
+        }
+        if (end != _length) {
+            _hash.store(0, std::memory_order_relaxed);
+            _length = end;
+            _str[_length] = '\0';
+        }
+        return *this;
+    }
 
-        return std::string(start, end + 1);
+    /**
+     * Return a new String, trimming the leading and trailing whitespace char's from the string.
+     */
+    String trim() const & {
+        String temp{ *this, _resource };
+        temp.trim_inplace();
+        return temp;
+    }
+
+    /**
+     * Trim the leading and trailing whitespace char's, reusing the buffer of
+     * this temporary String.
+     */
+    String trim() && {
+        trim_inplace();
+        return std::move(*this);
+    }
+
+    /**
+     * Trim the leading and trailing whitespace char's from this String in place.
+     */
+    String& trim_inplace() {
+        rtrim_inplace();
+        return ltrim_inplace();
     }
 
     /**
      * Return a new String, converted to lower case char's.
      */
-    String to_lower() {
-        std::string s = _str;
-        for (int i = 0; s[i] != '\0'; i++) {
-            if (s[i] >= 'A' && s[i] <= 'Z') {
-                s[i] = s[i] + 32;
-            }
-        }
-        return s;
+    String to_lower() const & {
+        String temp{ *this, _resource };
+        temp.to_lower_inplace();
+        return temp;
+    }
+
+    /**
+     * Convert to lower case char's, reusing the buffer of this temporary String.
+     */
+    String to_lower() && {
+        to_lower_inplace();
+        return std::move(*this);
+    }
+
+    /**
+     * Convert this String to lower case char's in place. Only ASCII letters
+     * change, several chars at a time.
+     */
+    String& to_lower_inplace() {
+        _hash.store(0, std::memory_order_relaxed);
+        FoldCase(_str, _length, true);
+        return *this;
     }
 
     /**
      * Return a new String, converted to upper case char's.
      */
-    String to_upper() {
-        std::string s = _str;
-        for (int i = 0; s[i] != '\0'; i++) {
-            if (s[i] >= 'a' && s[i] <= 'z') {
-                s[i] = s[i] - 32;
-            }
+    String to_upper() const & {
+        String temp{ *this, _resource };
+        temp.to_upper_inplace();
+        return temp;
+    }
+
+    /**
+     * Convert to upper case char's, reusing the buffer of this temporary String.
+     */
+    String to_upper() && {
+        to_upper_inplace();
+        return std::move(*this);
+    }
+
+    /**
+     * Convert this String to upper case char's in place. Only ASCII letters
+     * change, several chars at a time.
+     */
+    String& to_upper_inplace() {
+        _hash.store(0, std::memory_order_relaxed);
+        FoldCase(_str, _length, false);
+        return *this;
+    }
+
+    //  ################### Hashing and comparisons ##################
+    //  ##############################################################
+
+    /**
+     * Hash SOURCE with a fast, well distributed non-cryptographic hash. A
+     * String hashes the same as a std::string or std::string_view with the
+     * same contents, so any of them can be used to look a String up.
+     */
+    static std::size_t hash(const std::string_view source) noexcept {
+        return HashBytes<false>(source.data(), source.size());
+    }
+
+    /**
+     * Hash this String. The result is cached until the contents change, so
+     * repeated lookups with the same key only hash it once. Handing out a
+     * mutable pointer, reference or iterator clears the cache, but a write
+     * through one that is held across a later 'hash()' call is not seen.
+     */
+    std::size_t hash() const noexcept {
+        std::size_t value = _hash.load(std::memory_order_relaxed);
+        if (value == 0) {
+            value = hash(std::string_view(_str, _length));
+            _hash.store(value, std::memory_order_relaxed);
         }
-        return s;
+        return value;
+    }
+
+    /**
+     * Prototype equality ( == ) operator to compare String and String. The
+     * chars are always compared: the cached hash is only used by 'hash()',
+     * as it can be stale after a write through a held pointer.
+     */
+    friend bool operator == (const String& lhs, const String& rhs) noexcept {
+        if (lhs._length != rhs._length)
+            return false;
+        return memcmp(lhs._str, rhs._str, lhs._length) == 0;
+    }
+
+    /**
+     * Prototype equality ( == ) operator to compare String and std::string_view.
+     */
+    friend bool operator == (const String& lhs, const std::string_view rhs) noexcept {
+        return std::string_view(lhs._str, lhs._length) == rhs;
+    }
+
+    /**
+     * Prototype equality ( == ) operator to compare String and const char*.
+     */
+    friend bool operator == (const String& lhs, const char* rhs) noexcept {
+        return rhs != nullptr && lhs == std::string_view(rhs);
+    }
+
+    /**
+     * Prototype equality ( == ) operator to compare const char* and String.
+     */
+    friend bool operator == (const char* lhs, const String& rhs) noexcept { return rhs == lhs; }
+
+    /**
+     * Prototype equality ( == ) operator to compare String and std::string.
+     */
+    friend bool operator == (const String& lhs, const std::string& rhs) noexcept {
+        return lhs == std::string_view(rhs);
     }
 
     /**
-     * Return this string as an integer.
+     * Prototype equality ( == ) operator to compare std::string and String.
      */
-    int to_int() { return std::stoi(_str); }
+    friend bool operator == (const std::string& lhs, const String& rhs) noexcept { return rhs == lhs; }
+
+    /**
+     * Prototype inequality ( != ) operator to compare String and String.
+     */
+    friend bool operator != (const String& lhs, const String& rhs) noexcept { return !(lhs == rhs); }
+
+    /**
+     * Prototype inequality ( != ) operator to compare String and std::string_view.
+     */
+    friend bool operator != (const String& lhs, const std::string_view rhs) noexcept { return !(lhs == rhs); }
+
+    /**
+     * Prototype inequality ( != ) operator to compare String and const char*.
+     */
+    friend bool operator != (const String& lhs, const char* rhs) noexcept { return !(lhs == rhs); }
+
+    /**
+     * Prototype inequality ( != ) operator to compare const char* and String.
+     */
+    friend bool operator != (const char* lhs, const String& rhs) noexcept { return !(lhs == rhs); }
+
+    /**
+     * Prototype inequality ( != ) operator to compare String and std::string.
+     */
+    friend bool operator != (const String& lhs, const std::string& rhs) noexcept { return !(lhs == rhs); }
+
+    /**
+     * Prototype inequality ( != ) operator to compare std::string and String.
+     */
+    friend bool operator != (const std::string& lhs, const String& rhs) noexcept { return !(lhs == rhs); }
+
+    //  ################ Case-insensitive comparisons ################
+    //  ##############################################################
+
+    /**
+     * Returns true if LHS and RHS are equal ignoring ASCII case, without
+     * making a lowered copy of either.
+     */
+    static bool iequals(const std::string_view lhs, const std::string_view rhs) noexcept {
+        return lhs.size() == rhs.size() && FoldedEquals(lhs.data(), rhs.data(), lhs.size());
+    }
+
+    /**
+     * Returns true if this String equals OTHER ignoring ASCII case.
+     */
+    bool iequals(const String& other) const noexcept {
+        return iequals(std::string_view(_str, _length), std::string_view(other._str, other._length));
+    }
+
+    /**
+     * Returns true if this String equals OTHER ignoring ASCII case.
+     */
+    bool iequals(const std::string& other) const noexcept {
+        return iequals(std::string_view(_str, _length), std::string_view(other));
+    }
+
+    /**
+     * Returns true if this String equals OTHER ignoring ASCII case.
+     */
+    bool iequals(const char* other) const noexcept {
+        return other != nullptr && iequals(std::string_view(_str, _length), std::string_view(other));
+    }
+
+    /**
+     * Returns true if SOURCE starts with PREFIX ignoring ASCII case.
+     */
+    static bool istarts_with(const std::string_view source, const std::string_view prefix) noexcept {
+        return source.size() >= prefix.size() && FoldedEquals(source.data(), prefix.data(), prefix.size());
+    }
+
+    /**
+     * Returns true if this String starts with PREFIX ignoring ASCII case.
+     */
+    bool istarts_with(const String& prefix) const noexcept {
+        return istarts_with(std::string_view(_str, _length), std::string_view(prefix._str, prefix._length));
+    }
+
+    /**
+     * Returns true if this String starts with PREFIX ignoring ASCII case.
+     */
+    bool istarts_with(const std::string& prefix) const noexcept {
+        return istarts_with(std::string_view(_str, _length), std::string_view(prefix));
+    }
+
+    /**
+     * Returns true if this String starts with PREFIX ignoring ASCII case.
+     */
+    bool istarts_with(const char* prefix) const noexcept {
+        return prefix != nullptr && istarts_with(std::string_view(_str, _length), std::string_view(prefix));
+    }
+
+    /**
+     * Hash SOURCE ignoring ASCII case, so Strings that are 'iequals' hash
+     * the same. Uses the same hash as 'hash', folding each load in a
+     * register, so no lowered copy is made.
+     */
+    static std::size_t ihash(const std::string_view source) noexcept {
+        return HashBytes<true>(source.data(), source.size());
+    }
+
+    /**
+     * Hash this String ignoring ASCII case. See the static 'ihash'.
+     */
+    std::size_t ihash() const noexcept { return ihash(std::string_view(_str, _length)); }
+
+    /**
+     * Case-insensitive hash functor, for unordered containers keyed on
+     * String, std::string or const char* that ignore ASCII case.
+     */
+    struct IHash {
+        std::size_t operator()(const String& value) const noexcept { return value.ihash(); }
+        std::size_t operator()(const std::string& value) const noexcept { return String::ihash(value); }
+        std::size_t operator()(const char* value) const noexcept { return String::ihash(value); }
+    };
+
+    /**
+     * Case-insensitive equality functor, to pair with IHash.
+     */
+    struct IEqual {
+        bool operator()(const String& lhs, const String& rhs) const noexcept { return lhs.iequals(rhs); }
+        bool operator()(const std::string& lhs, const std::string& rhs) const noexcept {
+            return String::iequals(lhs, rhs);
+        }
+    };
+
+    //  ############################ UTF-8 ###########################
+    //  ##############################################################
+
+    /**
+     * Returns true if this String is entirely valid UTF-8. See the Utf8
+     * class for the rules and the ASCII fast path.
+     */
+    bool is_valid_utf8() const noexcept { return Utf8::is_valid(_str, _length); }
+
+    /**
+     * Returns the offset of the first sequence that is not valid UTF-8, or
+     * 'size()' if this String is entirely valid UTF-8.
+     */
+    std::size_t find_invalid_utf8() const noexcept { return Utf8::find_invalid(_str, _length); }
+
+    /**
+     * Returns the number of code points in this String, which should be
+     * valid UTF-8. 'size()' is the number of bytes.
+     */
+    std::size_t code_point_count() const noexcept { return Utf8::count(_str, _length); }
+
+    /**
+     * Returns a range over the code points in this String, for range based
+     * for loops. Ill-formed sequences yield U+FFFD. The range refers to this
+     * String's buffer, so it is invalidated by any change to the String.
+     */
+    Utf8::CodePoints code_points() const noexcept { return Utf8::CodePoints(_str, _str + _length); }
+
+    //  ##################### Numeric conversions ####################
+    //  ##############################################################
+
+    /**
+     * Return this string as an integer. Throws on invalid input, see
+     * 'try_to_int' for an exception-free conversion.
+     */
+    int to_int() const { return std::stoi(_str); }
 
     /**
      * Return this string as a double.
      */
-    double to_double() { return std::stod(_str); }
+    double to_double() const { return std::stod(_str); }
 
     /**
      * Return this string as a float.
      */
-    float to_float() { return std::stof(_str); }
+    float to_float() const { return std::stof(_str); }
 
     /**
      * Return this string as a long.
      */
-    long to_long() { return std::stol(_str); }
+    long to_long() const { return std::stol(_str); }
+
+    /**
+     * @brief   Convert the characters in [FIRST, LAST) to a number with
+     *          std::from_chars, without exceptions, locales or errno. The
+     *          whole range must be the number: no leading whitespace, no
+     *          leading '+' and no trailing characters.
+     *
+     * @tparam T        The integral or floating point type to convert to.
+     * @param first     The first character.
+     * @param last      One past the last character.
+     * @param base      The base for integral types, 2 to 36. Ignored for
+     *                  floating point types.
+     * @return          A NumericResult<T> holding the value or the error.
+     */
+    template < typename T >
+    static NumericResult<T> parse_number(const char* first, const char* last,
+                                         const int base = 10) noexcept {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                      "String::parse_number requires an integral or floating point type");
+
+        NumericResult<T> result{ T(), std::errc::invalid_argument };
+        if (first == nullptr || first >= last)
+            return result;
+
+        std::from_chars_result parsed;
+        if constexpr (std::is_floating_point_v<T>) {
+            (void) base;
+            parsed = std::from_chars(first, last, result._value);
+        } else {
+            parsed = std::from_chars(first, last, result._value, base);
+        }
+
+        if (parsed.ec != std::errc())
+            result._error = parsed.ec;
+        else if (parsed.ptr != last)
+            result._error = std::errc::invalid_argument;
+        else
+            result._error = std::errc();
+        return result;
+    }
+
+    /**
+     * @brief   Convert this String to a number without exceptions. See
+     *          'parse_number' for the accepted format.
+     *
+     * @tparam T        The integral or floating point type to convert to.
+     * @param base      The base for integral types. Ignored for floating
+     *                  point types.
+     * @return          A NumericResult<T> holding the value or the error.
+     */
+    template < typename T >
+    NumericResult<T> to_number(const int base = 10) const noexcept {
+        return parse_number<T>(_str, _str + _length, base);
+    }
+
+    /**
+     * @brief   Convert this String to a number without exceptions, failing
+     *          with 'std::errc::result_out_of_range' unless MIN <= value <= MAX.
+     *
+     * @tparam T        The integral or floating point type to convert to.
+     * @param min       The smallest accepted value.
+     * @param max       The largest accepted value.
+     * @param base      The base for integral types. Ignored for floating
+     *                  point types.
+     * @return          A NumericResult<T> holding the value or the error.
+     */
+    template < typename T >
+    NumericResult<T> to_number_in_range(const T min, const T max,
+                                        const int base = 10) const noexcept {
+        NumericResult<T> result = to_number<T>(base);
+        if (result.ok() && (result._value < min || result._value > max))
+            result._error = std::errc::result_out_of_range;
+        return result;
+    }
+
+    /**
+     * Convert this String from hexadecimal without exceptions. An optional
+     * '0x' or '0X' prefix is accepted.
+     */
+    template < typename T = unsigned long >
+    NumericResult<T> to_hex() const noexcept {
+        static_assert(std::is_integral_v<T>, "String::to_hex requires an integral type");
+        const char* first = _str;
+        if (_length > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+            first += 2;
+        return parse_number<T>(first, _str + _length, 16);
+    }
+
+    /**
+     * Return this string as an integer, without exceptions.
+     */
+    NumericResult<int> try_to_int() const noexcept { return to_number<int>(); }
+
+    /**
+     * Return this string as a double, without exceptions.
+     */
+    NumericResult<double> try_to_double() const noexcept { return to_number<double>(); }
+
+    /**
+     * Return this string as a float, without exceptions.
+     */
+    NumericResult<float> try_to_float() const noexcept { return to_number<float>(); }
+
+    /**
+     * Return this string as a long, without exceptions.
+     */
+    NumericResult<long> try_to_long() const noexcept { return to_number<long>(); }
+
+    /**
+     * @brief   Format VALUE into a new String with std::to_chars, without
+     *          streams or locales. Floating point values use the shortest
+     *          representation that reads back to the same value.
+     *
+     * @tparam T        The integral or floating point type to format.
+     * @param value     The value to format.
+     * @param base      The base for integral types, 2 to 36. Ignored for
+     *                  floating point types.
+     * @param resource  The memory resource to allocate from, or null for the
+     *                  default resource.
+     * @return          A String object of the formatted number.
+     */
+    template < typename T >
+    static String from_number(const T value, const int base = 10,
+                              std::pmr::memory_resource* resource = nullptr) {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                      "String::from_number requires an integral or floating point type");
+
+        //  Enough for any 64 bit integer in base 2 or any shortest double
+        char buff[72];
+        std::to_chars_result written;
+        if constexpr (std::is_floating_point_v<T>) {
+            (void) base;
+            written = std::to_chars(buff, buff + sizeof(buff), value);
+        } else {
+            written = std::to_chars(buff, buff + sizeof(buff), value, base);
+        }
+        return String(buff, static_cast<std::size_t>(written.ptr - buff), resource);
+    }
 
 };
 
+/**
+ * Hash String keys in std::unordered_map and std::unordered_set with the
+ * cached String hash, rather than converting through std::string.
+ */
+namespace std {
+    template <>
+    struct hash<String> {
+        std::size_t operator()(const String& value) const noexcept { return value.hash(); }
+    };
+}
 
 #endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_H__
@@ -0,0 +1,433 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_MATCHER_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_MATCHER_H__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#include "string.h"
+
+/**
+ * A compiled multi-pattern matcher (an Aho-Corasick automaton) for searching
+ * and replacing many patterns in a single pass over the input. Build it once
+ * with the full list of patterns and reuse it for every input, rather than
+ * calling 'String::replace' once per pattern and copying the input each time.
+ *
+ * Matches are reported leftmost-first and, where several patterns start at the
+ * same position, longest-first. Matches never overlap, so 'find_all' returns
+ * exactly the matches that 'replace_all' would replace.
+ *
+ * Empty patterns are ignored. Duplicate patterns keep the index of their first
+ * occurrence.
+ */
+class StringMatcher {
+public:
+    /**
+     * A single match found in the input.
+     */
+    struct Match {
+        /**
+         * The byte offset of the match in the input.
+         */
+        std::size_t _position;
+        /**
+         * The byte length of the match.
+         */
+        std::size_t _length;
+        /**
+         * The index of the matched pattern, in the order the patterns were
+         * given to the constructor.
+         */
+        std::size_t _pattern;
+    };
+
+    /**
+     * Construct an empty matcher, which never matches anything.
+     */
+    StringMatcher() { Compile(); }
+
+    /**
+     * Construct and compile a matcher for the given PATTERNS.
+     */
+    StringMatcher(const std::vector<std::string>& patterns)
+        : _patterns(patterns) {
+        Compile();
+    }
+
+    /**
+     * Construct and compile a matcher for the given PATTERNS.
+     */
+    StringMatcher(std::initializer_list<std::string> patterns)
+        : _patterns(patterns) {
+        Compile();
+    }
+
+    /**
+     * Construct and compile a matcher for the keys of REPLACEMENTS, storing
+     * the mapped values so 'replace_all(input)' can be used without passing
+     * the replacements on every call.
+     */
+    StringMatcher(const std::map<std::string, std::string>& replacements) {
+        _patterns.reserve(replacements.size());
+        _replacements.reserve(replacements.size());
+        for (const auto& pair : replacements) {
+            _patterns.push_back(pair.first);
+            _replacements.push_back(pair.second);
+        }
+        Compile();
+    }
+
+    /**
+     * Get the patterns this matcher was compiled with.
+     */
+    const std::vector<std::string>& patterns() const { return _patterns; }
+
+    //  ######################### Searching ##########################
+    //  ##############################################################
+
+    /**
+     * Returns true if any of the patterns appear in the LENGTH bytes at DATA.
+     * Stops at the first match found.
+     */
+    bool contains_any(const char* data, const std::size_t length) const {
+        if (data == nullptr)
+            return false;
+
+        std::int32_t state = 0;
+        for (std::size_t i = 0; i < length; i++) {
+            state = Next(state, data[i]);
+            if (_output[state] != -1 || _outputLink[state] != -1)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Returns true if any of the patterns appear in INPUT.
+     */
+    bool contains_any(const std::string& input) const {
+        return contains_any(input.c_str(), input.length());
+    }
+
+    /**
+     * Returns true if any of the patterns appear in INPUT.
+     */
+    bool contains_any(const String& input) const {
+        return contains_any(input.c_str(), input.size());
+    }
+
+    /**
+     * @brief   Find every non-overlapping match in the LENGTH bytes at DATA,
+     *          in order of position.
+     *
+     * @param data      The bytes to search.
+     * @param length    The number of bytes to search.
+     * @return          A std::vector<Match> of every match found.
+     */
+    std::vector<Match> find_all(const char* data, const std::size_t length) const {
+        std::vector<Match> matches;
+        if (data == nullptr)
+            return matches;
+
+        Scan(data, length, [&matches](const Match& match) {
+            matches.push_back(match);
+        });
+        return matches;
+    }
+
+    /**
+     * Find every non-overlapping match in INPUT, in order of position.
+     */
+    std::vector<Match> find_all(const std::string& input) const {
+        return find_all(input.c_str(), input.length());
+    }
+
+    /**
+     * Find every non-overlapping match in INPUT, in order of position.
+     */
+    std::vector<Match> find_all(const String& input) const {
+        return find_all(input.c_str(), input.size());
+    }
+
+    //  ######################### Replacing ##########################
+    //  ##############################################################
+
+    /**
+     * @brief   Returns a new String with every match in INPUT replaced by the
+     *          entry of REPLACEMENTS at the matched pattern's index. The input
+     *          is scanned once and the output is allocated once.
+     *
+     * @param input         The String to search.
+     * @param replacements  One replacement per pattern, in pattern order.
+     *                      Patterns without an entry are not searched for,
+     *                      so they never hide a match of one that has.
+     * @return              A String object of the new String data.
+     */
+    String replace_all(const String& input,
+                       const std::vector<std::string>& replacements) const {
+        return Replace(input.c_str(), input.size(), input.resource(), replacements);
+    }
+
+    /**
+     * @brief   Returns a new String with every match in INPUT replaced by the
+     *          value mapped to the matched pattern in REPLACEMENTS. Patterns
+     *          missing from REPLACEMENTS are not searched for, so with
+     *          patterns "abc" and "b" and only "b" mapped, the "b" in "abc"
+     *          is replaced.
+     *
+     * @param input         The String to search.
+     * @param replacements  A map of pattern to replacement string.
+     * @return              A String object of the new String data.
+     */
+    String replace_all(const String& input,
+                       const std::map<std::string, std::string>& replacements) const {
+        std::vector<std::string> byIndex(_patterns.size());
+        std::vector<bool> mapped(_patterns.size(), false);
+        for (std::size_t i = 0; i < _patterns.size(); i++) {
+            const auto it = replacements.find(_patterns[i]);
+            if (it != replacements.end()) {
+                byIndex[i] = it->second;
+                mapped[i] = true;
+            }
+        }
+        return Replace(input.c_str(), input.size(), input.resource(), byIndex, &mapped);
+    }
+
+    /**
+     * Returns a new String with every match in INPUT replaced by the
+     * replacements given to the map constructor.
+     */
+    String replace_all(const String& input) const {
+        return Replace(input.c_str(), input.size(), input.resource(), _replacements);
+    }
+
+private:
+    /**
+     * Sentinel for 'no output' and 'no transition'.
+     */
+    static constexpr std::int32_t NONE = -1;
+
+    /**
+     * Follow the transition out of STATE for the byte C.
+     */
+    std::int32_t Next(const std::int32_t state, const char c) const {
+        return _transitions[static_cast<std::size_t>(state) * _classCount
+                            + _classOf[static_cast<unsigned char>(c)]];
+    }
+
+    /**
+     * Build the trie, failure links and the dense transition table. Bytes that
+     * never occur in any pattern share a single class, which keeps the table
+     * small even for hundreds of patterns.
+     */
+    void Compile() {
+        _classOf.fill(0);
+        _classCount = 1;
+        for (const auto& pattern : _patterns)
+            for (const char c : pattern)
+                if (_classOf[static_cast<unsigned char>(c)] == 0)
+                    _classOf[static_cast<unsigned char>(c)] = _classCount++;
+
+        _transitions.assign(_classCount, NONE);
+        _fail.assign(1, 0);
+        _depth.assign(1, 0);
+        _output.assign(1, NONE);
+
+        for (std::size_t p = 0; p < _patterns.size(); p++) {
+            if (_patterns[p].empty())
+                continue;
+
+            std::int32_t state = 0;
+            for (const char c : _patterns[p]) {
+                const std::size_t slot = static_cast<std::size_t>(state) * _classCount
+                    + _classOf[static_cast<unsigned char>(c)];
+                if (_transitions[slot] == NONE) {
+                    const std::int32_t created = static_cast<std::int32_t>(_depth.size());
+                    _transitions[slot] = created;
+                    _transitions.resize(_transitions.size() + _classCount, NONE);
+                    _fail.push_back(0);
+                    _depth.push_back(_depth[state] + 1);
+                    _output.push_back(NONE);
+                }
+                state = _transitions[slot];
+            }
+            if (_output[state] == NONE)
+                _output[state] = static_cast<std::int32_t>(p);
+        }
+
+        _outputLink.assign(_depth.size(), NONE);
+
+        //  Breadth-first so every failure link points at an already finished
+        //  state, then fill the missing transitions from the failure state.
+        std::queue<std::int32_t> pending;
+        for (std::size_t c = 0; c < _classCount; c++) {
+            std::int32_t& target = _transitions[c];
+            if (target == NONE) {
+                target = 0;
+            } else {
+                _fail[target] = 0;
+                pending.push(target);
+            }
+        }
+
+        while (!pending.empty()) {
+            const std::int32_t state = pending.front();
+            pending.pop();
+
+            const std::int32_t fail = _fail[state];
+            _outputLink[state] = (_output[fail] != NONE ? fail : _outputLink[fail]);
+
+            for (std::size_t c = 0; c < _classCount; c++) {
+                std::int32_t& target = _transitions[static_cast<std::size_t>(state) * _classCount + c];
+                const std::int32_t fallback = _transitions[static_cast<std::size_t>(fail) * _classCount + c];
+                if (target == NONE) {
+                    target = fallback;
+                } else {
+                    _fail[target] = fallback;
+                    pending.push(target);
+                }
+            }
+        }
+    }
+
+    /**
+     * Walk the LENGTH bytes at DATA and call EMIT for every leftmost-longest
+     * match. A candidate match is only committed once the automaton can no
+     * longer be inside a longer match starting at or before it, and the scan
+     * restarts from the end of each committed match so matches never overlap.
+     * When ELIGIBLE is supplied, only patterns flagged in it can match.
+     */
+    template <typename Emit>
+    void Scan(const char* data, const std::size_t length, Emit emit,
+              const std::vector<bool>* eligible = nullptr) const {
+        std::size_t i = 0;
+        std::int32_t state = 0;
+        bool hasCandidate = false;
+        Match candidate{ 0, 0, 0 };
+
+        while (true) {
+            if (i == length) {
+                if (!hasCandidate)
+                    break;
+                emit(candidate);
+                i = candidate._position + candidate._length;
+                state = 0;
+                hasCandidate = false;
+                continue;
+            }
+
+            state = Next(state, data[i++]);
+
+            for (std::int32_t s = (_output[state] != NONE ? state : _outputLink[state]);
+                 s != NONE; s = _outputLink[s]) {
+                if (eligible != nullptr && !(*eligible)[static_cast<std::size_t>(_output[s])])
+                    continue;
+                const std::size_t matchLength = static_cast<std::size_t>(_depth[s]);
+                const std::size_t start = i - matchLength;
+                if (!hasCandidate || start < candidate._position
+                    || (start == candidate._position && matchLength > candidate._length)) {
+                    candidate = { start, matchLength, static_cast<std::size_t>(_output[s]) };
+                    hasCandidate = true;
+                }
+            }
+
+            if (hasCandidate && i - static_cast<std::size_t>(_depth[state]) > candidate._position) {
+                emit(candidate);
+                i = candidate._position + candidate._length;
+                state = 0;
+                hasCandidate = false;
+            }
+        }
+    }
+
+    /**
+     * Copy the LENGTH bytes at DATA into a new String, substituting each match
+     * with its entry in REPLACEMENTS and allocating it from RESOURCE. When
+     * MAPPED is supplied, only patterns flagged in it are replaced. Only the
+     * patterns being replaced are searched for, so one left alone never
+     * hides a shorter or later match of one that is not.
+     */
+    String Replace(const char* data, const std::size_t length,
+                   std::pmr::memory_resource* resource,
+                   const std::vector<std::string>& replacements,
+                   const std::vector<bool>* mapped = nullptr) const {
+        std::vector<bool> replaced;
+        if (mapped == nullptr && replacements.size() < _patterns.size()) {
+            replaced.assign(_patterns.size(), false);
+            std::fill_n(replaced.begin(), replacements.size(), true);
+            mapped = &replaced;
+        }
+
+        std::string result;
+        result.reserve(length);
+
+        std::size_t copied = 0;
+        Scan(data, length, [&](const Match& match) {
+            result.append(data + copied, match._position - copied);
+            result.append(replacements[match._pattern]);
+            copied = match._position + match._length;
+        }, mapped);
+        result.append(data + copied, length - copied);
+
+        return String(result.data(), result.size(), resource);
+    }
+
+    /**
+     * The patterns, in the order they were given.
+     */
+    std::vector<std::string> _patterns;
+
+    /**
+     * Replacements stored by the map constructor, indexed by pattern.
+     */
+    std::vector<std::string> _replacements;
+
+    /**
+     * Byte to transition class lookup. Class 0 is every byte that does not
+     * occur in any pattern.
+     */
+    std::array<std::uint16_t, 256> _classOf;
+
+    /**
+     * The number of transition classes, and so the width of each row in the
+     * transition table.
+     */
+    std::size_t _classCount = 1;
+
+    /**
+     * Dense transition table, one row of '_classCount' entries per state.
+     */
+    std::vector<std::int32_t> _transitions;
+
+    /**
+     * The failure link for each state.
+     */
+    std::vector<std::int32_t> _fail;
+
+    /**
+     * The depth of each state, which is the length of the prefix it matches.
+     */
+    std::vector<std::int32_t> _depth;
+
+    /**
+     * The pattern that ends exactly at each state, or NONE.
+     */
+    std::vector<std::int32_t> _output;
+
+    /**
+     * The nearest state along the failure chain that has an output, or NONE.
+     */
+    std::vector<std::int32_t> _outputLink;
+};
+
+#endif // __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_MATCHER_H__
@@ -0,0 +1,278 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_POOL_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_POOL_H__
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "string.h"
+
+/**
+ * A handle to a string held by a StringPool: a pointer to the pooled,
+ * null-terminated chars, their length and their precomputed hash. Copying a
+ * handle copies three words, and two handles from the same pool are equal
+ * exactly when they point at the same chars, so comparing them is a pointer
+ * comparison. A default constructed handle is empty and equal only to other
+ * empty handles. A handle is valid for as long as the pool it came from.
+ */
+class InternedString {
+private:
+
+    friend class StringPool;
+
+    const char* _data = nullptr;
+    std::size_t _length = 0;
+    std::size_t _hash = 0;
+
+    InternedString(const char* data, const std::size_t length, const std::size_t hash) noexcept :
+        _data(data), _length(length), _hash(hash) {}
+
+public:
+
+    /**
+     * Construct an empty handle.
+     */
+    InternedString() = default;
+
+    /**
+     * Returns the pooled chars, which are null-terminated, or "" for an
+     * empty handle.
+     */
+    const char* c_str() const noexcept { return _data != nullptr ? _data : ""; }
+
+    /**
+     * Returns the number of chars, not including the null-terminator.
+     */
+    std::size_t size() const noexcept { return _length; }
+
+    /**
+     * Returns the hash of the chars, the same as 'String::hash' would give.
+     */
+    std::size_t hash() const noexcept { return _hash; }
+
+    /**
+     * Returns a view of the pooled chars.
+     */
+    std::string_view view() const noexcept { return std::string_view(c_str(), _length); }
+
+    /**
+     * Returns true if this handle does not refer to a pooled string.
+     */
+    bool empty() const noexcept { return _data == nullptr; }
+
+    /**
+     * Returns true if this handle refers to a pooled string.
+     */
+    explicit operator bool() const noexcept { return _data != nullptr; }
+
+    /**
+     * Prototype equality ( == ) operator. Compares the pooled pointers, so
+     * it only means 'same chars' for handles from the same pool.
+     */
+    friend bool operator == (const InternedString& lhs, const InternedString& rhs) noexcept {
+        return lhs._data == rhs._data;
+    }
+
+    /**
+     * Prototype inequality ( != ) operator. See the equality operator.
+     */
+    friend bool operator != (const InternedString& lhs, const InternedString& rhs) noexcept {
+        return lhs._data != rhs._data;
+    }
+
+    /**
+     * Prototype insertion operator override.
+     */
+    friend std::ostream& operator << (std::ostream& os, const InternedString& obj) {
+        return os << obj.view();
+    }
+};
+
+namespace std {
+    /**
+     * Hash InternedString keys with their precomputed hash.
+     */
+    template <>
+    struct hash<InternedString> {
+        std::size_t operator()(const InternedString& value) const noexcept { return value.hash(); }
+    };
+}
+
+/**
+ * A thread-safe table of interned strings. Interning a byte sequence stores
+ * one copy of it for the life of the pool and returns an InternedString
+ * handle to it; interning the same bytes again returns the same handle, so
+ * repeated tokens such as header names, methods and log tags are held once
+ * and compared by pointer.
+ *
+ * The table is split into shards, chosen by hash, each with its own
+ * reader-writer lock, so lookups of already interned strings from many
+ * threads only take shared locks and rarely on the same shard. Strings are
+ * copied into a per-shard arena and never released until the pool is
+ * destroyed, so only intern bounded sets of tokens, not arbitrary input.
+ */
+class StringPool {
+private:
+
+    /**
+     * The number of independently locked shards.
+     */
+    static constexpr std::size_t SHARD_COUNT = 16;
+
+    /**
+     * Hash a pooled entry with its precomputed hash.
+     */
+    struct EntryHash {
+        std::size_t operator()(const InternedString& value) const noexcept { return value._hash; }
+    };
+
+    /**
+     * Compare entries by their chars, as a lookup key points at the caller's
+     * bytes rather than the pooled copy.
+     */
+    struct EntryEqual {
+        bool operator()(const InternedString& lhs, const InternedString& rhs) const noexcept {
+            return lhs._length == rhs._length &&
+                (lhs._length == 0 || memcmp(lhs._data, rhs._data, lhs._length) == 0);
+        }
+    };
+
+    /**
+     * One lock, the entries it guards and the arena their chars live in.
+     */
+    struct Shard {
+        mutable std::shared_mutex _mutex;
+        std::pmr::monotonic_buffer_resource _arena;
+        std::unordered_set<InternedString, EntryHash, EntryEqual> _entries;
+    };
+
+    std::array<Shard, SHARD_COUNT> _shards;
+
+    /**
+     * Returns the shard that holds strings with HASH.
+     */
+    Shard& ShardFor(const std::size_t hash) noexcept {
+        //  The low bits pick the hash table bucket, use the high bits here
+        return _shards[(hash >> (sizeof(std::size_t) * 8 - 4)) % SHARD_COUNT];
+    }
+
+    /**
+     * Returns the shard that holds strings with HASH.
+     */
+    const Shard& ShardFor(const std::size_t hash) const noexcept {
+        return _shards[(hash >> (sizeof(std::size_t) * 8 - 4)) % SHARD_COUNT];
+    }
+
+public:
+
+    /**
+     * Construct an empty pool.
+     */
+    StringPool() = default;
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator = (const StringPool&) = delete;
+
+    /**
+     * The process-wide pool, for tokens shared across the program. It is
+     * never destroyed before static destruction, so its handles stay valid
+     * for the life of the program.
+     */
+    static StringPool& Global() {
+        static StringPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief   Intern the chars in SOURCE, copying them into the pool the
+     *          first time they are seen.
+     *
+     * @param source    The chars to intern. Need not be null-terminated.
+     * @return          The handle for SOURCE, the same handle every time the
+     *                  same chars are interned in this pool.
+     */
+    InternedString intern(const std::string_view source) {
+        const InternedString key(source.data(), source.size(), String::hash(source));
+        Shard& shard = ShardFor(key._hash);
+
+        {
+            std::shared_lock<std::shared_mutex> lock(shard._mutex);
+            const auto found = shard._entries.find(key);
+            if (found != shard._entries.end())
+                return *found;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard._mutex);
+        //  Another thread may have interned it between the two locks
+        const auto found = shard._entries.find(key);
+        if (found != shard._entries.end())
+            return *found;
+
+        char* copy = static_cast<char*>(shard._arena.allocate(source.size() + 1, alignof(char)));
+        if (!source.empty())
+            memcpy(copy, source.data(), source.size());
+        copy[source.size()] = '\0';
+        const InternedString entry(copy, source.size(), key._hash);
+        shard._entries.insert(entry);
+        return entry;
+    }
+
+    /**
+     * Intern the chars in SOURCE. See 'intern(std::string_view)'.
+     */
+    InternedString intern(const String& source) {
+        return intern(std::string_view(source.c_str(), source.size()));
+    }
+
+    /**
+     * Intern the chars in SOURCE. See 'intern(std::string_view)'.
+     */
+    InternedString intern(const std::string& source) { return intern(std::string_view(source)); }
+
+    /**
+     * Intern the chars in SOURCE. See 'intern(std::string_view)'.
+     */
+    InternedString intern(const char* source) {
+        return intern(source != nullptr ? std::string_view(source) : std::string_view());
+    }
+
+    /**
+     * Returns the handle for SOURCE if it has been interned, or an empty
+     * handle if not. Never adds to the pool, so it is safe to call with
+     * untrusted input.
+     */
+    InternedString find(const std::string_view source) const {
+        const InternedString key(source.data(), source.size(), String::hash(source));
+        const Shard& shard = ShardFor(key._hash);
+
+        std::shared_lock<std::shared_mutex> lock(shard._mutex);
+        const auto found = shard._entries.find(key);
+        return found != shard._entries.end() ? *found : InternedString();
+    }
+
+    /**
+     * Returns the number of distinct strings interned.
+     */
+    std::size_t size() const {
+        std::size_t count = 0;
+        for (const Shard& shard : _shards) {
+            std::shared_lock<std::shared_mutex> lock(shard._mutex);
+            count += shard._entries.size();
+        }
+        return count;
+    }
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_STRING_POOL_H__
@@ -7,15 +7,20 @@
 #define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_CLIENT_H__
 
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <arpa/inet.h>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 #include <sys/ioctl.h>
+#include <sys/time.h>
 
 #include "log.h"
+#include "string.h"
 
 /**
  * The custom TCP Socket class is designed to simplify the process of using and
@@ -26,6 +31,10 @@
  * descriptor that is used for sending and reading data over the network socket,
  * as well as storing the server file descriptor this client connected to.
  *
+ * Constructed with 'InternetProtocol::local', the client connects to a Unix
+ * domain stream socket at a path instead of an address and port, for a
+ * server on the same host. It is read and written the same way.
+ *
  * __errno and __errmsg are local private variables that are set upon error, and
  * can be accessed using ERR_NO() and ERR_MSG() functions.
  *
@@ -49,15 +58,16 @@
 class TcpClient {
 public:
     /**
-     * The internet protocol version.
+     * The internet protocol version, or 'local' for a Unix domain socket.
      */
-    enum InternetProtocol : uint8_t { v4, v6 };
+    enum InternetProtocol : uint8_t { v4, v6, local };
 
     /**
      * Construct a new Tcp Client object with a socket file descriptor
      * and some default parameters for a TCP type connection:
      * 'socket(AF_INET, SOCK_STREAM, 0)'. Address Options: AF_INET
-     * family.
+     * family. With 'local', the socket is 'socket(AF_UNIX, SOCK_STREAM, 0)'
+     * instead.
      */
     TcpClient(InternetProtocol ipv = InternetProtocol::v4) {
         __errno = 0;
@@ -69,15 +79,15 @@ public:
         llog << "Initialise new TCP client object...";
 
         _ipv = ipv;
-        _socketFd = socket((_ipv == InternetProtocol::v4 ? AF_INET : AF_INET6), SOCK_STREAM, 0);
+        _socketFd = socket((_ipv == InternetProtocol::local ? AF_UNIX
+            : (_ipv == InternetProtocol::v4 ? AF_INET : AF_INET6)), SOCK_STREAM, 0);
         if (_socketFd < 0) {
             __errno = 10000 + errno;
 
-            std::stringstream msg;
-            msg << "Client socket creation failed: _socketFd: "
-                << _socketFd << ". ERROR CODE: " << __errno << ".";
+            const String msg = String::format("Client socket creation failed: _socketFd: {}. ERROR CODE: {}.",
+                _socketFd, __errno);
 
-            flog << msg.str();
+            flog << msg;
             
             return;
         }
@@ -121,7 +131,8 @@ public:
     void Close() {
         dlog << "Closing socket " << _socketFd << " and server " << _serverFd
             << "...";
-        close(_serverFd);
+        //  '_serverFd' only holds the result of 'connect', never a descriptor
+        //  this object owns, so closing it would close descriptor 0
         close(_socketFd);
         _serverFd = -1;
         _socketFd = -1;
@@ -142,28 +153,35 @@ public:
 
         llog << "Connecting to " << ip << ":" << portNumber << "...";
 
+        if (_ipv == InternetProtocol::local) {
+            const String msg = String::format("Connection failed: this is a local socket, connect to a path "
+                "instead of {}:{}.", ip, portNumber);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 102;
+            return false;
+        }
+
         _address.sin_port = htons(portNumber);
 
         const int inet_result = inet_pton((_ipv == InternetProtocol::v4 ? AF_INET : AF_INET6), ip, &_address.sin_addr);
         if (inet_result <= 0) {
-            std::stringstream msg;
-            msg << "Address invalid / not supported: inet_result: "
-                << inet_result << ".";
+            const String msg = String::format("Address invalid / not supported: inet_result: {}.",
+                inet_result);
 
-            flog << msg.str();
-            __errmsg = msg.str();
+            flog << msg;
+            __errmsg = msg;
             __errno = 11000 + errno;
             return false;
         }
 
         _serverFd = connect(_socketFd, (struct sockaddr*) &_address, _addressLength);
         if (_serverFd < 0) {
-            std::stringstream msg;
-            msg << "Connection failed: _serverFd: "
-                << _serverFd << ".";
+            const String msg = String::format("Connection failed: _serverFd: {}.", _serverFd);
 
-            flog << msg.str();
-            __errmsg = msg.str();
+            flog << msg;
+            __errmsg = msg;
             __errno = 12000 + errno;
             return false;
         }
@@ -172,6 +190,65 @@ public:
         return true;
     }
 
+    /**
+     * @brief   Connect this socket to the Unix domain socket at PATH, for a
+     *          client constructed with 'InternetProtocol::local'. A PATH
+     *          starting with '@' names a socket in the abstract namespace.
+     *          Sets __errmsg and __errno on error.
+     *
+     * @param path      The socket path, at most 107 characters.
+     * @return true     if the socket successfully connected to the endpoint,
+     * @return false    otherwise.
+     */
+    bool Connect(const char* path) {
+        __errno = 0;
+        __errmsg = "";
+
+        llog << "Connecting to " << path << "...";
+
+        if (_ipv != InternetProtocol::local) {
+            const String msg = String::format("Connection failed: only a local socket connects to a path: {}.",
+                path);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 102;
+            return false;
+        }
+
+        //  An abstract name is every byte given after a leading null, so it
+        //  is not null terminated; a file path is
+        const std::size_t length = strlen(path);
+        if (length == 0 || length >= sizeof(_localAddress.sun_path)) {
+            const String msg = String::format("Address invalid / not supported: the path is too long: {}.", path);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 11000 + ENAMETOOLONG;
+            return false;
+        }
+        memset(&_localAddress, 0, sizeof(_localAddress));
+        _localAddress.sun_family = AF_UNIX;
+        memcpy(_localAddress.sun_path, path, length);
+        if (path[0] == '@')
+            _localAddress.sun_path[0] = '\0';
+        const socklen_t addressLength =
+            static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length + (path[0] == '@' ? 0 : 1));
+
+        _serverFd = connect(_socketFd, (struct sockaddr*) &_localAddress, addressLength);
+        if (_serverFd < 0) {
+            const String msg = String::format("Connection failed: _serverFd: {}.", _serverFd);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 12000 + errno;
+            return false;
+        }
+
+        llog << "Connected on " << path << ".";
+        return true;
+    }
+
     /**
      * Read N_BYTES into BUFF on this socket. Return
      * number of bytes read, -1 if error or 0 if EOF.
@@ -183,11 +260,10 @@ public:
         __errno = 0;
 
         if (_socketFd < 0) {
-            std::stringstream msg;
-            msg << "Socket read error, tried reading without valid socket file "
-                << "descriptor: " << _socketFd << ".";
-            elog << msg.str();
-            __errmsg = msg.str();
+            const String msg = String::format("Socket read error, tried reading without valid socket file "
+                "descriptor: {}.", _socketFd);
+            elog << msg;
+            __errmsg = msg;
             __errno = 101;
             return -1;
         }
@@ -195,12 +271,11 @@ public:
         memset(buff, 0, n_bytes);
         int bytes = recv(_socketFd, buff, n_bytes, flags);
         if (bytes < 0) {
-            std::stringstream msg;
-            msg << "Error reading bytes, _socketFd: " << _socketFd << ", bytes: "
-                << bytes << ".";
+            const String msg = String::format("Error reading bytes, _socketFd: {}, bytes: {}.",
+                _socketFd, bytes);
 
-            elog << msg.str();
-            __errmsg = msg.str();
+            elog << msg;
+            __errmsg = msg;
             __errno = 13000 + errno;
         } else if (bytes == 0) {
             dlog << "No bytes were read.";
@@ -238,23 +313,21 @@ public:
         __errno = 0;
 
         if (_socketFd < 0) {
-            std::stringstream msg;
-            msg << "Socket send error, tried sending without valid socket file "
-                << "descriptor: " << _socketFd << ".";
-            elog << msg.str();
-            __errmsg = msg.str();
+            const String msg = String::format("Socket send error, tried sending without valid socket file "
+                "descriptor: {}.", _socketFd);
+            elog << msg;
+            __errmsg = msg;
             __errno = 101;
             return -1;
         }
 
         int bytes = send(_socketFd, buff, n_bytes, flags);
         if (bytes < 0) {
-            std::stringstream msg;
-            msg << "Error sending bytes, _socketFd: " << _socketFd << ", bytes: "
-                << bytes << ".";
+            const String msg = String::format("Error sending bytes, _socketFd: {}, bytes: {}.",
+                _socketFd, bytes);
 
-            elog << msg.str();
-            __errmsg = msg.str();
+            elog << msg;
+            __errmsg = msg;
             __errno = 13000 + errno;
         } else if (bytes == 0) {
             wlog << "No bytes were sent.";
@@ -265,6 +338,33 @@ public:
         return bytes;
     }
 
+    /**
+     * @brief   Make 'Read' give up after waiting MILLISECONDS for bytes,
+     *          returning -1 with error code 13000 + EAGAIN, or wait for as
+     *          long as it takes if MILLISECONDS is 0. Sets __errmsg and
+     *          __errno on error.
+     *
+     * @return true     if the timeout was set,
+     * @return false    otherwise.
+     */
+    bool SetReadTimeout(const int milliseconds) {
+        return SetTimeout(SO_RCVTIMEO, "read", milliseconds);
+    }
+
+    /**
+     * @brief   Make 'Send' give up after waiting MILLISECONDS for room in
+     *          the socket's send buffer, returning what it had sent by then,
+     *          or -1 with error code 13000 + EAGAIN if that was nothing. 0
+     *          waits for as long as it takes. Sets __errmsg and __errno on
+     *          error.
+     *
+     * @return true     if the timeout was set,
+     * @return false    otherwise.
+     */
+    bool SetSendTimeout(const int milliseconds) {
+        return SetTimeout(SO_SNDTIMEO, "send", milliseconds);
+    }
+
     /**
      * Returns the number of bytes available to read on the socket, or
      * -1 on error.
@@ -276,23 +376,21 @@ public:
         __errno = 0;
 
         if (_socketFd < 0) {
-            std::stringstream msg;
-            msg << "Socket read error, tried checking for available bytes on "
-                << "without valid socket file descriptor: " << _socketFd << ".";
-            elog << msg.str();
-            __errmsg = msg.str();
+            const String msg = String::format("Socket read error, tried checking for available bytes on "
+                "without valid socket file descriptor: {}.", _socketFd);
+            elog << msg;
+            __errmsg = msg;
             __errno = 101;
             return -1;
         }
         
         int bytesAvailable;
         if (ioctl(_socketFd, FIONREAD, &bytesAvailable) < 0) {
-            std::stringstream msg;
-            msg << "Error reading available byte count, _socketFd: "
-                << _socketFd << ".";
+            const String msg = String::format("Error reading available byte count, _socketFd: {}.",
+                _socketFd);
 
-            elog << msg.str();
-            __errmsg = msg.str();
+            elog << msg;
+            __errmsg = msg;
             __errno = 13000 + errno;
             return -1;
         }
@@ -300,6 +398,12 @@ public:
         return bytesAvailable;
     }
 
+    /**
+     * Get the internet protocol version, or 'local', the client was
+     * constructed with.
+     */
+    InternetProtocol GetProtocol() { return _ipv; }
+
     /**
      * Get this client socket's file descriptor value.
      */
@@ -321,6 +425,38 @@ public:
     int ERR_NO() { return __errno; }
 
 protected:
+    /**
+     * Set the socket timeout OPTION, for the WHAT direction, to
+     * MILLISECONDS.
+     */
+    bool SetTimeout(const int option, const char* what, const int milliseconds) {
+        __errmsg = "";
+        __errno = 0;
+
+        if (_socketFd < 0) {
+            const String msg = String::format("Socket {} timeout error, tried setting it without valid socket file "
+                "descriptor: {}.", what, _socketFd);
+            elog << msg;
+            __errmsg = msg;
+            __errno = 101;
+            return false;
+        }
+
+        const int clamped = (milliseconds > 0 ? milliseconds : 0);
+        const timeval timeout = { clamped / 1000, (clamped % 1000) * 1000 };
+        if (setsockopt(_socketFd, SOL_SOCKET, option, &timeout, sizeof(timeout)) < 0) {
+            const String msg = String::format("Failed to set the socket {} timeout, _socketFd: {}.",
+                what, _socketFd);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 14000 + errno;
+            return false;
+        }
+
+        return true;
+    }
+
     /**
      * The file descriptor for THIS socket object.
      */
@@ -346,6 +482,11 @@ protected:
      */
     const int _addressLength = sizeof(_address);
 
+    /**
+     * This client socket's Unix domain address, for a local socket.
+     */
+    struct sockaddr_un _localAddress;
+
     /**
      * The last error message set.
      */
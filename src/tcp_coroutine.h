@@ -0,0 +1,1072 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_COROUTINE_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_COROUTINE_H__
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "io_pool.h"
+#include "log.h"
+#include "string.h"
+#include "tcp_event_loop.h"
+#include "tcp_server.h"
+#include "timing_wheel.h"
+
+class TcpScheduler;
+
+/**
+ * What every Task's promise holds: the coroutine to resume when the task
+ * finishes, the exception it finished with, and, once spawned, its place in
+ * its scheduler's list of running tasks.
+ */
+class TaskPromiseBase {
+public:
+
+    /**
+     * Resumes whoever awaited the task once it finishes, or, for a spawned
+     * task, hands it back to its scheduler to be destroyed.
+     */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        inline std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * Tasks start when awaited or spawned, not when called.
+     */
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept { _exception = std::current_exception(); }
+
+protected:
+
+    template<typename T>
+    friend class Task;
+    friend class TcpScheduler;
+
+    /**
+     * Rethrow the exception the task finished with, if any.
+     */
+    void Rethrow() const {
+        if (_exception)
+            std::rethrow_exception(_exception);
+    }
+
+    std::coroutine_handle<> _continuation;
+    std::exception_ptr _exception;
+
+    /**
+     * Set when the task is spawned: its scheduler, its own frame, and its
+     * neighbours in the scheduler's list.
+     */
+    TcpScheduler* _scheduler = nullptr;
+    std::coroutine_handle<> _frame;
+    TaskPromiseBase* _prevTask = nullptr;
+    TaskPromiseBase* _nextTask = nullptr;
+};
+
+/**
+ * A Task's promise, holding the value it returns.
+ */
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+
+    template<typename U>
+    void return_value(U&& value) { _value.emplace(std::forward<U>(value)); }
+
+    /**
+     * Returns the value the task returned, or rethrows its exception.
+     */
+    T Result() {
+        Rethrow();
+        return std::move(*_value);
+    }
+
+private:
+
+    std::optional<T> _value;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+
+    void return_void() const noexcept {}
+
+    /**
+     * Rethrows the exception the task finished with, if any.
+     */
+    void Result() const { Rethrow(); }
+};
+
+/**
+ * A coroutine that returns T. A task does nothing until it is awaited,
+ * from another task, or handed to 'TcpScheduler::Spawn' to run on its own:
+ *
+ *     Task<int> Add(TcpScheduler& scheduler, int a, int b) {
+ *         co_await scheduler.SleepFor(std::chrono::milliseconds(10));
+ *         co_return a + b;
+ *     }
+ *
+ *     Task<> Main(TcpScheduler& scheduler) {
+ *         int sum = co_await Add(scheduler, 1, 2);
+ *     }
+ *
+ *     scheduler.Spawn(Main(scheduler));
+ *
+ * Awaiting a task resumes the awaiter with its value once it returns, or
+ * rethrows the exception it threw. Move-only; destroying a task that has
+ * not been spawned destroys its coroutine.
+ */
+template<typename T = void>
+class Task {
+public:
+
+    struct promise_type : public TaskPromise<T> {
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Task(const Task&) = delete;
+    Task& operator = (const Task&) = delete;
+
+    Task(Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+    Task& operator = (Task&& other) noexcept {
+        if (this != &other) {
+            if (_handle)
+                _handle.destroy();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (_handle)
+            _handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+    /**
+     * Start the task, to resume AWAITER when it finishes.
+     */
+    std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiter) noexcept {
+        _handle.promise()._continuation = awaiter;
+        return _handle;
+    }
+
+    T await_resume() { return _handle.promise().Result(); }
+
+private:
+
+    friend class TcpScheduler;
+
+    explicit Task(const std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+/**
+ * A connection from 'TcpScheduler::Accept' or 'TcpScheduler::Connect',
+ * read and written by awaiting:
+ *
+ *     int n = co_await conn.Read(buff, sizeof(buff));
+ *     bool ok = co_await conn.Write(buff, n);
+ *
+ * 'Read' resumes once bytes have arrived, with their number, 0 once the
+ * peer has closed the connection, or -1 on error. 'Write' queues the bytes
+ * on the underlying TcpConnection and resumes at once, unless that takes
+ * the queue over the scheduler's high watermark, in which case it resumes
+ * when the queue has drained to the low watermark. It resumes with false
+ * if the connection closed instead.
+ *
+ * Move-only. The connection is closed when the last handle to it is
+ * destroyed, or by 'Close'. One task may read while another writes, but
+ * no more than one task at a time may await each, and the handle must
+ * outlive them.
+ */
+class AsyncConnection {
+private:
+
+    struct State;
+
+public:
+
+    /**
+     * Awaited to read from a connection.
+     */
+    class ReadAwaiter {
+    public:
+
+        inline bool await_ready();
+
+        void await_suspend(const std::coroutine_handle<> handle) noexcept {
+            _handle = handle;
+            _state->_reader = this;
+        }
+
+        int await_resume() const noexcept { return _result; }
+
+        ~ReadAwaiter() {
+            if (_state != nullptr && _state->_reader == this)
+                _state->_reader = nullptr;
+        }
+
+    private:
+
+        friend class AsyncConnection;
+        friend class TcpScheduler;
+
+        ReadAwaiter(State* state, void* buff, const std::size_t n_bytes) noexcept :
+            _state(state), _buff(buff), _size(n_bytes) {}
+
+        State* _state;
+        void* _buff;
+        std::size_t _size;
+        int _result = -1;
+        std::coroutine_handle<> _handle;
+    };
+
+    /**
+     * Awaited to write to a connection.
+     */
+    class WriteAwaiter {
+    public:
+
+        inline bool await_ready();
+
+        void await_suspend(const std::coroutine_handle<> handle) noexcept {
+            _handle = handle;
+            _state->_writer = this;
+        }
+
+        bool await_resume() const noexcept { return _result; }
+
+        ~WriteAwaiter() {
+            if (_state != nullptr && _state->_writer == this)
+                _state->_writer = nullptr;
+        }
+
+    private:
+
+        friend class AsyncConnection;
+        friend class TcpScheduler;
+
+        WriteAwaiter(State* state, const void* buff, const std::size_t n_bytes) noexcept :
+            _state(state), _buff(buff), _size(n_bytes) {}
+
+        State* _state;
+        const void* _buff;
+        std::size_t _size;
+        bool _result = false;
+        std::coroutine_handle<> _handle;
+    };
+
+    /**
+     * Construct an empty handle, which reads and writes nothing.
+     */
+    AsyncConnection() = default;
+
+    AsyncConnection(const AsyncConnection&) = delete;
+    AsyncConnection& operator = (const AsyncConnection&) = delete;
+
+    AsyncConnection(AsyncConnection&& other) noexcept :
+        _scheduler(std::exchange(other._scheduler, nullptr)), _state(std::move(other._state)) {}
+
+    AsyncConnection& operator = (AsyncConnection&& other) noexcept {
+        if (this != &other) {
+            Close();
+            _scheduler = std::exchange(other._scheduler, nullptr);
+            _state = std::move(other._state);
+        }
+        return *this;
+    }
+
+    /**
+     * Close the connection.
+     */
+    ~AsyncConnection() { Close(); }
+
+    /**
+     * @brief   Read up to N_BYTES into BUFF, waiting until there are bytes to
+     *          read. BUFF must stay valid until the read resumes.
+     *
+     * @return  An awaitable for the number of bytes read, 0 if the peer
+     *          closed the connection, or -1 if it failed or was closed.
+     */
+    ReadAwaiter Read(void* buff, const std::size_t n_bytes) noexcept {
+        return ReadAwaiter(_state.get(), buff, n_bytes);
+    }
+
+    /**
+     * @brief   Write N_BYTES of BUFF, which are copied, so BUFF can be reused
+     *          once the write resumes.
+     *
+     * @return  An awaitable for true once the bytes are sent or queued
+     *          within the high watermark, or false if the connection closed.
+     */
+    WriteAwaiter Write(const void* buff, const std::size_t n_bytes) noexcept {
+        return WriteAwaiter(_state.get(), buff, n_bytes);
+    }
+
+    WriteAwaiter Write(const std::string_view bytes) noexcept { return Write(bytes.data(), bytes.size()); }
+
+    /**
+     * Close the connection, leaving this handle empty. A task still
+     * awaiting it resumes as though it had failed.
+     */
+    inline void Close();
+
+    /**
+     * Returns true if the handle holds a connection that is not closing.
+     */
+    bool IsOpen() const noexcept {
+        return _state && _state->_connection != nullptr && !_state->_connection->IsClosing();
+    }
+
+    explicit operator bool() const noexcept { return IsOpen(); }
+
+    /**
+     * Returns the underlying connection, to set its timeouts or deadlines,
+     * or null if it has closed. Do not read from it, or set its user data.
+     */
+    TcpConnection* Connection() const noexcept { return (_state ? _state->_connection : nullptr); }
+
+    /**
+     * Get the connection's socket file descriptor value, or -1 once closed.
+     */
+    int GetSocketFd() const noexcept { return (Connection() != nullptr ? Connection()->GetSocketFd() : -1); }
+
+    /**
+     * Get the last error message set on the connection.
+     */
+    std::string ERR_MSG() {
+        if (Connection() != nullptr)
+            return Connection()->ERR_MSG();
+        return (_state ? _state->__errmsg : std::string());
+    }
+
+    /**
+     * Get the last error code set on the connection, kept when it closes.
+     */
+    int ERR_NO() {
+        if (Connection() != nullptr)
+            return Connection()->ERR_NO();
+        return (_state ? _state->__errno : 0);
+    }
+
+private:
+
+    friend class TcpScheduler;
+
+    /**
+     * A connection's state between the scheduler and its handle, pointed
+     * to by the TcpConnection's user data while it is open, and pooled by
+     * the scheduler.
+     */
+    struct State {
+        TcpConnection* _connection = nullptr;
+        ReadAwaiter* _reader = nullptr;
+        WriteAwaiter* _writer = nullptr;
+        std::string __errmsg;
+        int __errno = 0;
+    };
+
+    AsyncConnection(TcpScheduler* scheduler, std::unique_ptr<State> state) noexcept :
+        _scheduler(scheduler), _state(std::move(state)) {}
+
+    TcpScheduler* _scheduler = nullptr;
+    std::unique_ptr<State> _state;
+};
+
+/**
+ * Runs Tasks over a TcpEventLoop, so sequential protocol code can be
+ * written as though it blocked, with one thread serving every connection:
+ *
+ *     Task<> Echo(AsyncConnection conn) {
+ *         char buff[4096];
+ *         int n;
+ *         while ((n = co_await conn.Read(buff, sizeof(buff))) > 0)
+ *             co_await conn.Write(buff, n);
+ *     }
+ *
+ *     Task<> Serve(TcpScheduler& scheduler, TcpServer& server) {
+ *         while (true)
+ *             scheduler.Spawn(Echo(co_await scheduler.Accept(server)));
+ *     }
+ *
+ *     TcpScheduler scheduler;
+ *     scheduler.Spawn(Serve(scheduler, server));
+ *     scheduler.Run();
+ *
+ * A task runs until it awaits something that is not ready, such as a read
+ * with nothing to read. Its coroutine is then resumed by 'RunOnce' once
+ * the loop reports what it was waiting for. 'SleepFor' waits on the loop's
+ * timing wheel. Resumed tasks run after the loop has handled its batch of
+ * events, so a task never runs inside one of the loop's handlers.
+ *
+ * A spawned task is destroyed when it finishes; an exception it throws is
+ * logged. Tasks still suspended when the scheduler is destroyed are
+ * destroyed with it, closing their connections. The scheduler, its loop
+ * and its tasks belong to the thread running it. Only 'Stop' may be called
+ * from another thread.
+ *
+ * __errno and __errmsg are set on error. 'Connect' uses the TcpClient codes:
+ * - 10xxx = creating the socket failed.
+ * - 11xxx = the address is invalid or not supported.
+ * - 12xxx = connecting failed.
+ * Failing to listen on or wait for the loop copies the TcpEventLoop code.
+ */
+class TcpScheduler {
+private:
+
+    struct Listener;
+
+public:
+
+    /**
+     * Awaited to accept a connection.
+     */
+    class AcceptAwaiter {
+    public:
+
+        /**
+         * Take the oldest connection kept for the listener, if any, only
+         * once awaited, so an awaiter that never is leaves it for the next.
+         */
+        bool await_ready() noexcept {
+            if (_listener == nullptr || _state)
+                return true;
+            if (_listener->_backlog.empty())
+                return false;
+            _state = std::move(_listener->_backlog.front());
+            _listener->_backlog.pop_front();
+            return true;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle) {
+            _handle = handle;
+            _listener->_acceptors.push_back(this);
+        }
+
+        AsyncConnection await_resume() noexcept { return AsyncConnection(_scheduler, std::move(_state)); }
+
+        /**
+         * Stop waiting, and close a connection handed over but never
+         * resumed with, such as when the task is destroyed first.
+         */
+        ~AcceptAwaiter() {
+            if (_listener != nullptr) {
+                std::deque<AcceptAwaiter*>& acceptors = _listener->_acceptors;
+                acceptors.erase(std::remove(acceptors.begin(), acceptors.end(), this), acceptors.end());
+            }
+            if (_state)
+                AsyncConnection(_scheduler, std::move(_state)).Close();
+        }
+
+    private:
+
+        friend class TcpScheduler;
+
+        AcceptAwaiter(TcpScheduler* scheduler, TcpServer& server) noexcept :
+            _scheduler(scheduler), _listener(scheduler->FindListener(server)) {}
+
+        TcpScheduler* _scheduler;
+        Listener* _listener = nullptr;
+        std::unique_ptr<AsyncConnection::State> _state;
+        std::coroutine_handle<> _handle;
+    };
+
+    /**
+     * Awaited to connect to a server.
+     */
+    class ConnectAwaiter {
+    public:
+
+        bool await_ready() const noexcept { return !_state || _state->_connection == nullptr; }
+
+        void await_suspend(const std::coroutine_handle<> handle) noexcept {
+            _handle = handle;
+            _scheduler->_connecting.push_back(this);
+        }
+
+        inline AsyncConnection await_resume() noexcept;
+
+        /**
+         * Stop waiting, and close the connection if it was never resumed
+         * with, such as when the task is destroyed first.
+         */
+        ~ConnectAwaiter() {
+            std::vector<ConnectAwaiter*>& connecting = _scheduler->_connecting;
+            connecting.erase(std::remove(connecting.begin(), connecting.end(), this), connecting.end());
+            if (_state)
+                AsyncConnection(_scheduler, std::move(_state)).Close();
+        }
+
+    private:
+
+        friend class TcpScheduler;
+
+        ConnectAwaiter(TcpScheduler* scheduler, std::unique_ptr<AsyncConnection::State> state) noexcept :
+            _scheduler(scheduler), _state(std::move(state)) {}
+
+        TcpScheduler* _scheduler;
+        std::unique_ptr<AsyncConnection::State> _state;
+        bool _connected = false;
+        std::coroutine_handle<> _handle;
+    };
+
+    /**
+     * Awaited to sleep.
+     */
+    class SleepAwaiter {
+    public:
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(const std::coroutine_handle<> handle) {
+            _timer.SetCallback([this, handle]() { _scheduler->Ready(handle); });
+            _scheduler->_loop.Timers().Arm(_timer, _duration);
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        friend class TcpScheduler;
+
+        SleepAwaiter(TcpScheduler* scheduler, const std::chrono::milliseconds duration) noexcept :
+            _scheduler(scheduler), _duration(duration) {}
+
+        TcpScheduler* _scheduler;
+        std::chrono::milliseconds _duration;
+        WheelTimer _timer;
+    };
+
+    /**
+     * @brief   Construct a scheduler with its own event loop.
+     *
+     * @throw runtime_error if the loop could not be created.
+     */
+    TcpScheduler() {
+        __errmsg = "";
+        __errno = 0;
+
+        _loop.OnReadable([this](TcpConnection& conn) { Readable(conn); });
+        _loop.OnWritable([this](TcpConnection& conn) { Writable(conn); });
+        _loop.OnDrain([this](TcpConnection& conn) { Drained(conn); });
+        _loop.OnClose([this](TcpConnection& conn) { Closed(conn); });
+    }
+
+    TcpScheduler(const TcpScheduler&) = delete;
+    TcpScheduler& operator = (const TcpScheduler&) = delete;
+
+    /**
+     * Destroy the scheduler, destroying every task still suspended and
+     * closing every connection.
+     */
+    ~TcpScheduler() {
+        dlog << "TCP scheduler destruction, destroying " << _taskCount << " tasks...";
+        while (_tasks != nullptr) {
+            TaskPromiseBase* task = _tasks;
+            Unlink(*task);
+            task->_frame.destroy();
+        }
+        _ready.clear();
+        for (std::unique_ptr<Listener>& listener : _listeners) {
+            for (std::unique_ptr<AsyncConnection::State>& state : listener->_backlog) {
+                if (state->_connection != nullptr)
+                    state->_connection->SetUserData(nullptr);
+            }
+        }
+
+        //  The loop closes what is left without calling back into a
+        //  scheduler that is going
+        _loop.OnReadable(nullptr);
+        _loop.OnWritable(nullptr);
+        _loop.OnDrain(nullptr);
+        _loop.OnClose(nullptr);
+    }
+
+    /**
+     * Start TASK, and keep it until it finishes. It runs on the calling
+     * thread until it first suspends.
+     */
+    template<typename T>
+    void Spawn(Task<T> task) {
+        TaskPromiseBase& promise = task._handle.promise();
+        promise._scheduler = this;
+        promise._frame = std::exchange(task._handle, nullptr);
+        promise._nextTask = _tasks;
+        if (_tasks != nullptr)
+            _tasks->_prevTask = &promise;
+        _tasks = &promise;
+        _taskCount++;
+        promise._frame.resume();
+    }
+
+    /**
+     * @brief   Accept connections from SERVER, which must already be
+     *          listening. 'Accept' does this itself the first time it is
+     *          awaited for a server. Connections accepted before a task
+     *          awaits them are kept for it.
+     *
+     * @return true     if the server was added to the loop,
+     * @return false    otherwise.
+     */
+    bool Listen(TcpServer& server) {
+        __errmsg = "";
+        __errno = 0;
+
+        Listener* listener = new Listener{ &server, {}, {} };
+        _listeners.emplace_back(listener);
+        if (!_loop.Listen(server, [this, listener](TcpConnection& conn) { Accepted(*listener, conn); })) {
+            _listeners.pop_back();
+            __errno = _loop.ERR_NO();
+            __errmsg = _loop.ERR_MSG();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Returns an awaitable for the next connection accepted from SERVER,
+     * listening on it first if need be. The connection is empty if the
+     * scheduler could not listen on it.
+     */
+    AcceptAwaiter Accept(TcpServer& server) {
+        if (FindListener(server) == nullptr)
+            Listen(server);
+        return AcceptAwaiter(this, server);
+    }
+
+    /**
+     * @brief   Connect to PORT_NUMBER at the IPv4 address IP without
+     *          blocking.
+     *
+     * @return  An awaitable for the connection, which is empty if
+     *          connecting failed.
+     */
+    ConnectAwaiter Connect(const int portNumber, const char* ip = "127.0.0.1") {
+        __errmsg = "";
+        __errno = 0;
+
+        llog << "Connecting to " << ip << ":" << portNumber << "...";
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(portNumber);
+        if (inet_pton(AF_INET, ip, &address.sin_addr) <= 0) {
+            __errno = 11000 + errno;
+            const String msg = String::format("Address invalid / not supported: {}.", ip);
+            __errmsg = msg;
+            elog << msg;
+            return ConnectAwaiter(this, nullptr);
+        }
+
+        const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            __errno = 10000 + errno;
+            const String msg = String::format("Client socket creation failed: fd: {}.", fd);
+            __errmsg = msg;
+            elog << msg;
+            return ConnectAwaiter(this, nullptr);
+        }
+
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 && errno != EINPROGRESS) {
+            __errno = 12000 + errno;
+            const String msg = String::format("Connection failed: fd: {}.", fd);
+            __errmsg = msg;
+            elog << msg;
+            close(fd);
+            return ConnectAwaiter(this, nullptr);
+        }
+
+        //  The connection is complete, or has failed, once it is writable
+        TcpConnection* connection = _loop.Adopt(fd);
+        if (connection == nullptr) {
+            __errno = _loop.ERR_NO();
+            __errmsg = _loop.ERR_MSG();
+            return ConnectAwaiter(this, nullptr);
+        }
+        return ConnectAwaiter(this, NewState(*connection));
+    }
+
+    /**
+     * Returns an awaitable that resumes after DURATION, to the resolution
+     * of the loop's timing wheel.
+     */
+    SleepAwaiter SleepFor(const std::chrono::milliseconds duration) noexcept {
+        return SleepAwaiter(this, duration);
+    }
+
+    /**
+     * @brief   Wait up to TIMEOUT_MILLISECONDS for events, handle them, then
+     *          resume the tasks they were waiting for.
+     *
+     * @return  The number of events handled, or -1 on error.
+     */
+    int RunOnce(const int timeout_milliseconds = -1) {
+        const int count = _loop.RunOnce(_ready.empty() ? timeout_milliseconds : 0);
+        if (count < 0) {
+            __errno = _loop.ERR_NO();
+            __errmsg = _loop.ERR_MSG();
+            return -1;
+        }
+
+        //  Tasks resumed here can make more ready, which run now too
+        while (!_ready.empty()) {
+            _resuming.swap(_ready);
+            for (const std::coroutine_handle<> handle : _resuming)
+                handle.resume();
+            _resuming.clear();
+        }
+        return count;
+    }
+
+    /**
+     * Run until every spawned task has finished, or 'Stop' is called.
+     * Returns false if waiting for events failed, true otherwise.
+     */
+    bool Run() {
+        while (_taskCount > 0 && !_stopping.exchange(false)) {
+            if (RunOnce(-1) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Make 'Run' return once the events it is handling are done. Safe to call
+     * from any thread, including from a task.
+     */
+    void Stop() noexcept {
+        _stopping.store(true);
+        _loop.Stop();
+    }
+
+    /**
+     * Returns the number of spawned tasks that have not finished.
+     */
+    std::size_t TaskCount() const noexcept { return _taskCount; }
+
+    /**
+     * Returns the scheduler's event loop, to set its watermarks, limits and
+     * timeouts. Do not set its handlers.
+     */
+    TcpEventLoop& Loop() noexcept { return _loop; }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    friend class TaskPromiseBase;
+    friend class AsyncConnection;
+
+    /**
+     * A server being accepted from: the connections accepted before a task
+     * awaited them, and the tasks awaiting one.
+     */
+    struct Listener {
+        TcpServer* _server;
+        std::deque<std::unique_ptr<AsyncConnection::State>> _backlog;
+        std::deque<AcceptAwaiter*> _acceptors;
+    };
+
+    /**
+     * Returns the listener for SERVER, or null if it has none.
+     */
+    Listener* FindListener(const TcpServer& server) const noexcept {
+        for (const std::unique_ptr<Listener>& listener : _listeners) {
+            if (listener->_server == &server)
+                return listener.get();
+        }
+        return nullptr;
+    }
+
+    /**
+     * Returns a pooled state for CONNECTION, which then points to it.
+     */
+    std::unique_ptr<AsyncConnection::State> NewState(TcpConnection& connection) {
+        std::unique_ptr<AsyncConnection::State> state = _statePool.acquire();
+        state->_connection = &connection;
+        state->_reader = nullptr;
+        state->_writer = nullptr;
+        state->__errmsg.clear();
+        state->__errno = 0;
+        connection.SetUserData(state.get());
+        return state;
+    }
+
+    /**
+     * Resume HANDLE once the current batch of events is handled.
+     */
+    void Ready(const std::coroutine_handle<> handle) { _ready.push_back(handle); }
+
+    /**
+     * Hand a connection accepted from LISTENER to the first task awaiting
+     * one, or keep it for the next.
+     */
+    void Accepted(Listener& listener, TcpConnection& conn) {
+        std::unique_ptr<AsyncConnection::State> state = NewState(conn);
+        if (listener._acceptors.empty()) {
+            listener._backlog.push_back(std::move(state));
+            return;
+        }
+        AcceptAwaiter* acceptor = listener._acceptors.front();
+        listener._acceptors.pop_front();
+        acceptor->_state = std::move(state);
+        Ready(acceptor->_handle);
+    }
+
+    /**
+     * Resume the task waiting for CONN to connect, if any, with whether it
+     * did.
+     */
+    void Connected(TcpConnection& conn) {
+        for (std::size_t i = 0; i < _connecting.size(); i++) {
+            ConnectAwaiter* connector = _connecting[i];
+            if (connector->_state->_connection != &conn)
+                continue;
+
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (getsockopt(conn.GetSocketFd(), SOL_SOCKET, SO_ERROR, &error, &length) < 0)
+                error = errno;
+            connector->_connected = (error == 0);
+            if (error != 0) {
+                __errno = 12000 + error;
+                const String msg = String::format("Connection failed: fd: {}, errno: {}.", conn.GetSocketFd(), error);
+                __errmsg = msg;
+                elog << msg;
+                conn.Close();
+            }
+            _connecting.erase(_connecting.begin() + static_cast<std::ptrdiff_t>(i));
+            Ready(connector->_handle);
+            return;
+        }
+    }
+
+    void Readable(TcpConnection& conn) {
+        AsyncConnection::State* state = static_cast<AsyncConnection::State*>(conn.GetUserData());
+        if (state == nullptr)
+            return;
+        if (!_connecting.empty())
+            Connected(conn);
+        AsyncConnection::ReadAwaiter* reader = state->_reader;
+        if (reader == nullptr || conn.IsClosing())
+            return;
+
+        const int n = conn.Read(reader->_buff, reader->_size);
+        if (n < 0 && conn.WouldBlock())
+            return;
+        reader->_result = n;
+        state->_reader = nullptr;
+        Ready(reader->_handle);
+    }
+
+    void Writable(TcpConnection& conn) {
+        if (!_connecting.empty() && conn.GetUserData() != nullptr)
+            Connected(conn);
+    }
+
+    void Drained(TcpConnection& conn) {
+        AsyncConnection::State* state = static_cast<AsyncConnection::State*>(conn.GetUserData());
+        if (state == nullptr || state->_writer == nullptr)
+            return;
+        state->_writer->_result = true;
+        Ready(state->_writer->_handle);
+        state->_writer = nullptr;
+    }
+
+    /**
+     * Resume anything waiting on CONN, which is being closed, as failed,
+     * keeping its error for the handle.
+     */
+    void Closed(TcpConnection& conn) {
+        AsyncConnection::State* state = static_cast<AsyncConnection::State*>(conn.GetUserData());
+        if (state == nullptr)
+            return;
+        if (!_connecting.empty())
+            Connected(conn);
+        state->__errno = conn.ERR_NO();
+        state->__errmsg = conn.ERR_MSG();
+        Fail(*state);
+        state->_connection = nullptr;
+        conn.SetUserData(nullptr);
+    }
+
+    /**
+     * Resume the tasks reading or writing STATE's connection as failed.
+     */
+    void Fail(AsyncConnection::State& state) {
+        if (state._reader != nullptr) {
+            state._reader->_result = (state.__errno != 0 ? -1 : 0);
+            Ready(state._reader->_handle);
+            state._reader = nullptr;
+        }
+        if (state._writer != nullptr) {
+            state._writer->_result = false;
+            Ready(state._writer->_handle);
+            state._writer = nullptr;
+        }
+    }
+
+    /**
+     * Take TASK out of the list of running tasks.
+     */
+    void Unlink(TaskPromiseBase& task) noexcept {
+        if (task._prevTask != nullptr)
+            task._prevTask->_nextTask = task._nextTask;
+        else
+            _tasks = task._nextTask;
+        if (task._nextTask != nullptr)
+            task._nextTask->_prevTask = task._prevTask;
+        task._prevTask = task._nextTask = nullptr;
+        _taskCount--;
+    }
+
+    /**
+     * Log the exception spawned task TASK finished with, if any, and forget
+     * it. Its frame is destroyed by the caller.
+     */
+    void Finished(TaskPromiseBase& task) noexcept {
+        Unlink(task);
+        if (!task._exception)
+            return;
+        try {
+            std::rethrow_exception(task._exception);
+        }
+        catch (std::exception& err) {
+            elog << "Scheduled task threw an exception: " << err.what();
+        }
+        catch (...) {
+            elog << "Scheduled task threw an unknown exception.";
+        }
+    }
+
+    TcpEventLoop _loop;
+    std::atomic<bool> _stopping{false};
+
+    /**
+     * The spawned tasks that have not finished, as a list through their
+     * promises.
+     */
+    TaskPromiseBase* _tasks = nullptr;
+    std::size_t _taskCount = 0;
+
+    /**
+     * The coroutines to resume once the current batch of events is handled,
+     * and those being resumed now.
+     */
+    std::vector<std::coroutine_handle<>> _ready;
+    std::vector<std::coroutine_handle<>> _resuming;
+
+    std::vector<std::unique_ptr<Listener>> _listeners;
+    std::vector<ConnectAwaiter*> _connecting;
+    ObjectPool<AsyncConnection::State> _statePool{ []() { return new AsyncConnection::State(); } };
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+template<typename Promise>
+std::coroutine_handle<> TaskPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    TaskPromiseBase& promise = handle.promise();
+    if (promise._continuation)
+        return promise._continuation;
+    if (promise._scheduler != nullptr) {
+        promise._scheduler->Finished(promise);
+        handle.destroy();
+    }
+    return std::noop_coroutine();
+}
+
+bool AsyncConnection::ReadAwaiter::await_ready() {
+    TcpConnection* connection = (_state != nullptr ? _state->_connection : nullptr);
+    if (connection == nullptr || connection->IsClosing()) {
+        _result = (_state != nullptr && _state->__errno == 0 && connection == nullptr ? 0 : -1);
+        return true;
+    }
+    _result = connection->Read(_buff, _size);
+    return _result >= 0 || !connection->WouldBlock();
+}
+
+bool AsyncConnection::WriteAwaiter::await_ready() {
+    TcpConnection* connection = (_state != nullptr ? _state->_connection : nullptr);
+    if (connection == nullptr) {
+        _result = false;
+        return true;
+    }
+    _result = connection->Write(_buff, _size);
+    return _result || connection->IsClosing();
+}
+
+void AsyncConnection::Close() {
+    if (!_state)
+        return;
+    if (_state->_connection != nullptr) {
+        _state->_connection->SetUserData(nullptr);
+        _state->_connection->Close();
+        _state->_connection = nullptr;
+    }
+    _scheduler->Fail(*_state);
+    _scheduler->_statePool.release(std::move(_state));
+}
+
+AsyncConnection TcpScheduler::ConnectAwaiter::await_resume() noexcept {
+    if (!_state)
+        return AsyncConnection();
+    if (!_connected) {
+        //  Already closing, just not yet closed by the loop
+        if (_state->_connection != nullptr)
+            _state->_connection->SetUserData(nullptr);
+        _scheduler->_statePool.release(std::move(_state));
+        return AsyncConnection();
+    }
+    return AsyncConnection(_scheduler, std::move(_state));
+}
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_COROUTINE_H__
@@ -0,0 +1,1111 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_EVENT_LOOP_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_EVENT_LOOP_H__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "io_pool.h"
+#include "log.h"
+#include "string.h"
+#include "tcp_server.h"
+#include "timing_wheel.h"
+
+/**
+ * One non-blocking connection owned by a TcpEventLoop, handed to the loop's
+ * handlers. 'Read' and 'Send' never block: when the socket has nothing to
+ * read, or no room to send, they return -1 and 'WouldBlock' is true, and the
+ * loop calls the readable or writable handler again once that changes.
+ *
+ * 'Write' never drops bytes: whatever the socket does not take straight
+ * away is queued, in buffers leased from 'BufferPool::Global', and sent by
+ * the loop as the socket drains. Once more than the loop's high watermark is
+ * queued the connection is write-paused: 'Write' returns false to tell the
+ * producer to stop, and the loop stops calling the readable handler, so a
+ * request/response handler stops reading requests from a client that is
+ * not reading its responses. When the queue drains to the low watermark the
+ * drain handler is called, then the readable handler if reading was held
+ * back. Do not mix 'Send' with 'Write' on a connection with bytes queued.
+ *
+ * Connections are owned and closed by their loop. Call 'Close' to have the
+ * loop close the connection once the current handler returns; the close
+ * handler is then called with it one last time. The loop then keeps the
+ * object, and the buffer from 'ReadBuffer', to reuse for a later
+ * connection, so do not keep pointers to a connection after it closes.
+ *
+ * A connection can be given an idle timeout, and read and write deadlines,
+ * on its loop's timing wheel. One that runs out is closed like any other,
+ * with its error code set to 13000 + ETIMEDOUT.
+ *
+ * __errno and __errmsg are set on error, using the same 13xxx codes as
+ * TcpClient for failed reads and sends.
+ */
+class TcpConnection {
+public:
+
+    TcpConnection(const TcpConnection&) = delete;
+    TcpConnection& operator = (const TcpConnection&) = delete;
+
+    /**
+     * Get this connection's socket file descriptor value.
+     */
+    int GetSocketFd() const noexcept { return _fd; }
+
+    /**
+     * @brief   Read up to N_BYTES into BUFF without blocking. With an
+     *          edge-triggered loop, keep reading until this returns 0 or -1
+     *          with 'WouldBlock' true, or the readable handler will not be
+     *          called again for the bytes left behind.
+     *
+     * @return  The number of bytes read, 0 if the peer closed the
+     *          connection, or -1 if nothing is available ('WouldBlock') or on
+     *          error.
+     */
+    int Read(void* buff, const size_t n_bytes) {
+        _wouldBlock = false;
+        const ssize_t bytes = recv(_fd, buff, n_bytes, 0);
+        if (bytes < 0)
+            return Failed("Error reading bytes", errno);
+        if (bytes > 0)
+            _lastActive = _timers->CurrentTick();
+        return static_cast<int>(bytes);
+    }
+
+    /**
+     * @brief   Send up to N_BYTES of BUFF without blocking. Writing to a
+     *          connection the peer has closed fails with an error rather than
+     *          raising SIGPIPE.
+     *
+     * @return  The number of bytes the kernel accepted, which may be fewer
+     *          than N_BYTES, or -1 if there is no room ('WouldBlock') or on
+     *          error.
+     */
+    int Send(const void* buff, const size_t n_bytes) {
+        _wouldBlock = false;
+        const ssize_t bytes = send(_fd, buff, n_bytes, MSG_NOSIGNAL);
+        if (bytes < 0)
+            return Failed("Error sending bytes", errno);
+        if (bytes > 0)
+            _lastActive = _timers->CurrentTick();
+        return static_cast<int>(bytes);
+    }
+
+    /**
+     * @brief   Send N_BYTES of BUFF, queueing whatever the socket does not
+     *          take now to be sent by the loop as it drains, after any bytes
+     *          already queued. The bytes are copied, so BUFF can be reused
+     *          straight away. A failed send closes the connection.
+     *
+     * @return true     if the bytes were sent or queued and the queue is
+     *                  within the high watermark,
+     * @return false    if the connection is now write-paused, with the bytes
+     *                  still queued, or is closing, in which case they were
+     *                  dropped. Stop producing until the drain handler is
+     *                  called.
+     */
+    bool Write(const void* buff, const size_t n_bytes) {
+        if (_closing)
+            return false;
+
+        const char* bytes = static_cast<const char*>(buff);
+        std::size_t remaining = n_bytes;
+
+        //  Nothing queued to keep in order behind, so try the socket first
+        while (_queuedBytes == 0 && remaining > 0) {
+            const int sent = Send(bytes, remaining);
+            if (sent < 0) {
+                if (!_wouldBlock) {
+                    Close();
+                    return false;
+                }
+                break;
+            }
+            bytes += sent;
+            remaining -= static_cast<std::size_t>(sent);
+        }
+
+        while (remaining > 0) {
+            if (_writeQueue.empty() || _writeTail == _writeQueue.back().size()) {
+                _writeQueue.push_back(BufferPool::Global().lease(BufferPool::MEDIUM_BUFFER_SIZE));
+                _writeTail = 0;
+            }
+            const std::size_t chunk = std::min(remaining, _writeQueue.back().size() - _writeTail);
+            memcpy(_writeQueue.back().data() + _writeTail, bytes, chunk);
+            _writeTail += chunk;
+            _queuedBytes += chunk;
+            bytes += chunk;
+            remaining -= chunk;
+        }
+
+        if (_queuedBytes > _highWatermark)
+            _writePaused = true;
+        return !_writePaused;
+    }
+
+    /**
+     * Returns the number of bytes 'Write' has queued that the socket has not
+     * yet taken.
+     */
+    std::size_t QueuedBytes() const noexcept { return _queuedBytes; }
+
+    /**
+     * Returns true from when more than the high watermark is queued until
+     * the queue drains to the low watermark.
+     */
+    bool IsWritePaused() const noexcept { return _writePaused; }
+
+    /**
+     * Returns a read buffer for this connection, leased from
+     * 'BufferPool::Global' the first time it is asked for and returned when
+     * the connection closes, so the same buffers serve connection after
+     * connection. Its size is set by 'TcpEventLoop::SetReadBufferSize'.
+     */
+    IoBuffer& ReadBuffer() {
+        if (!_readBuffer)
+            _readBuffer = BufferPool::Global().lease(_readBufferSize);
+        return _readBuffer;
+    }
+
+    /**
+     * Returns true if the last 'Read' or 'Send' returned -1 only because it
+     * would have blocked, rather than because of an error.
+     */
+    bool WouldBlock() const noexcept { return _wouldBlock; }
+
+    /**
+     * Ask the loop to close this connection once the current handler
+     * returns. Can be called on any of the loop's connections, such as from
+     * another connection's handler.
+     */
+    void Close() {
+        if (_closing)
+            return;
+        _closing = true;
+        _closeQueue->push_back(this);
+    }
+
+    /**
+     * Returns true once 'Close' has been called or the loop has seen the
+     * connection fail.
+     */
+    bool IsClosing() const noexcept { return _closing; }
+
+    /**
+     * Close the connection once nothing has been read from or sent on it
+     * for TIMEOUT, to the resolution of the loop's timing wheel, or stop
+     * doing so if TIMEOUT is 0. Reading and sending only note the time, so
+     * a busy connection costs nothing more until the timer runs out.
+     */
+    void SetIdleTimeout(const std::chrono::milliseconds timeout) {
+        _idleTimeout = timeout;
+        if (timeout.count() <= 0) {
+            _timers->Cancel(_idleTimer);
+            return;
+        }
+        _lastActive = _timers->CurrentTick();
+        _timers->Arm(_idleTimer, timeout);
+    }
+
+    /**
+     * Close the connection if it is still open TIMEOUT from now, such as to
+     * bound how long a client has to send a whole request, or clear the
+     * deadline if TIMEOUT is 0. Call again with 0 once the request is in.
+     */
+    void SetReadDeadline(const std::chrono::milliseconds timeout) {
+        if (timeout.count() <= 0)
+            _timers->Cancel(_readTimer);
+        else
+            _timers->Arm(_readTimer, timeout);
+    }
+
+    /**
+     * Close the connection if bytes queued by 'Write' are still waiting to
+     * be sent TIMEOUT from now, such as to bound how long a client has to
+     * read a whole response, or clear the deadline if TIMEOUT is 0. Nothing
+     * happens at the deadline if the queue has drained.
+     */
+    void SetWriteDeadline(const std::chrono::milliseconds timeout) {
+        if (timeout.count() <= 0)
+            _timers->Cancel(_writeTimer);
+        else
+            _timers->Arm(_writeTimer, timeout);
+    }
+
+    /**
+     * Attach DATA to this connection, such as per-connection protocol state.
+     * The loop never reads or frees it.
+     */
+    void SetUserData(void* data) noexcept { _userData = data; }
+
+    /**
+     * Get the data attached with 'SetUserData', or null.
+     */
+    void* GetUserData() const noexcept { return _userData; }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    friend class TcpEventLoop;
+
+    TcpConnection() {
+        _idleTimer.SetCallback([this]() { Idle(); });
+        _readTimer.SetCallback([this]() { TimedOut("Read deadline passed"); });
+        _writeTimer.SetCallback([this]() {
+            if (_queuedBytes > 0)
+                TimedOut("Write deadline passed");
+        });
+    }
+
+    /**
+     * Make this object, new or reused, the connection for socket FD, with
+     * write watermarks LOW_WATERMARK and HIGH_WATERMARK, to be put on
+     * CLOSE_QUEUE when it is closed, and timed on TIMERS.
+     */
+    void Reset(const int fd, std::vector<TcpConnection*>* closeQueue, TimingWheel* timers,
+        const std::size_t readBufferSize, const std::size_t lowWatermark, const std::size_t highWatermark) noexcept {
+        _fd = fd;
+        _closeQueue = closeQueue;
+        _timers = timers;
+        _idleTimeout = std::chrono::milliseconds(0);
+        _lastActive = timers->CurrentTick();
+        _closing = false;
+        _wouldBlock = false;
+        _userData = nullptr;
+        _readBufferSize = readBufferSize;
+        _writeHead = 0;
+        _writeTail = 0;
+        _queuedBytes = 0;
+        _lowWatermark = lowWatermark;
+        _highWatermark = highWatermark;
+        _writePaused = false;
+        _readPending = false;
+        __errmsg.clear();
+        __errno = 0;
+    }
+
+    /**
+     * Send queued bytes until the queue is empty or the socket is full,
+     * returning each buffer to the pool once it has all gone. A failed send
+     * closes the connection.
+     */
+    void Flush() {
+        while (_queuedBytes > 0) {
+            IoBuffer& front = _writeQueue.front();
+            const std::size_t end = (_writeQueue.size() == 1 ? _writeTail : front.size());
+            const int sent = Send(front.data() + _writeHead, end - _writeHead);
+            if (sent < 0) {
+                if (!_wouldBlock)
+                    Close();
+                return;
+            }
+            _writeHead += static_cast<std::size_t>(sent);
+            _queuedBytes -= static_cast<std::size_t>(sent);
+            if (_writeHead == end) {
+                _writeQueue.pop_front();
+                _writeHead = 0;
+                if (_writeQueue.empty())
+                    _writeTail = 0;
+            }
+        }
+    }
+
+    /**
+     * Called when the idle timer runs out. The timer is only armed for the
+     * whole timeout, so if the connection was active since, it is armed
+     * again for what is left from then.
+     */
+    void Idle() {
+        const uint64_t timeout = static_cast<uint64_t>((_idleTimeout + _timers->Tick() - std::chrono::milliseconds(1))
+            / _timers->Tick());
+        const uint64_t idle = _timers->CurrentTick() - _lastActive;
+        if (idle < timeout)
+            _timers->Arm(_idleTimer, _timers->Tick() * (timeout - idle));
+        else
+            TimedOut("Idle timeout");
+    }
+
+    /**
+     * Record that the connection ran out of time for WHAT, and close it.
+     */
+    void TimedOut(const char* what) {
+        if (_closing)
+            return;
+        __errno = 13000 + ETIMEDOUT;
+        const String msg = String::format("{}, closing _socketFd: {}.", what, _fd);
+        __errmsg = msg;
+        wlog << msg;
+        Close();
+    }
+
+    /**
+     * Record a failed read or send with ERROR, or only set '_wouldBlock' if
+     * the socket was just not ready. Returns -1.
+     */
+    int Failed(const char* what, const int error) {
+        if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR) {
+            _wouldBlock = true;
+            return -1;
+        }
+        __errno = 13000 + error;
+        const String msg = String::format("{}, _socketFd: {}, errno: {}.", what, _fd, error);
+        __errmsg = msg;
+        elog << msg;
+        return -1;
+    }
+
+    int _fd = -1;
+    std::vector<TcpConnection*>* _closeQueue = nullptr;
+    bool _closing = false;
+    bool _wouldBlock = false;
+    void* _userData = nullptr;
+    std::size_t _readBufferSize = BufferPool::MEDIUM_BUFFER_SIZE;
+    IoBuffer _readBuffer;
+
+    /**
+     * The bytes 'Write' queued, from '_writeHead' in the first buffer to
+     * '_writeTail' in the last.
+     */
+    std::deque<IoBuffer> _writeQueue;
+    std::size_t _writeHead = 0;
+    std::size_t _writeTail = 0;
+    std::size_t _queuedBytes = 0;
+    std::size_t _lowWatermark = 0;
+    std::size_t _highWatermark = 0;
+    bool _writePaused = false;
+
+    /**
+     * Set when the connection was readable while write-paused, so the
+     * readable handler is called once it resumes.
+     */
+    bool _readPending = false;
+
+    /**
+     * The loop's timing wheel, and the timers this connection arms on it.
+     * '_lastActive' is the tick of the last read or send.
+     */
+    TimingWheel* _timers = nullptr;
+    WheelTimer _idleTimer;
+    WheelTimer _readTimer;
+    WheelTimer _writeTimer;
+    std::chrono::milliseconds _idleTimeout{0};
+    uint64_t _lastActive = 0;
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+/**
+ * An edge-triggered epoll reactor, so one thread can serve tens of
+ * thousands of concurrent connections. Give it one or more listening
+ * TcpServers and handlers for the events it reports, then run it:
+ *
+ *     TcpServer server;
+ *     server.StartListening(8080);
+ *     TcpEventLoop loop;
+ *     loop.Listen(server);
+ *     loop.OnReadable([](TcpConnection& conn) {
+ *         char buff[4096];
+ *         int n;
+ *         while ((n = conn.Read(buff, sizeof(buff))) > 0)
+ *             conn.Send(buff, n);
+ *         if (n == 0 || !conn.WouldBlock())
+ *             conn.Close();
+ *     });
+ *     loop.Run();
+ *
+ * Every listening and accepted socket is non-blocking. New connections are
+ * accepted with accept4 until the queue is empty, up to 'SetAcceptBatchSize'
+ * per listener per wakeup so a connection storm cannot starve the open
+ * connections, with the rest taken on the next turn of the loop. Each is
+ * registered for input, output and peer hang-up in edge-triggered mode, and
+ * the accept handler is called with it. The readable and writable handlers are then
+ * called only when a socket becomes readable or writable again, so they
+ * must read or write until 'WouldBlock'. A connection is closed, and the
+ * close handler called, after 'Close' is called on it, after a hang-up or
+ * error the handlers did not deal with, or when the loop is destroyed.
+ *
+ * Bytes queued by 'TcpConnection::Write' are sent when the socket becomes
+ * writable, before the writable handler is called, within the watermarks
+ * set by 'SetWriteWatermarks'.
+ *
+ * 'SetConnectionLimit' caps the open connections, with an overload policy
+ * for new ones beyond it: 'reject' accepts and resets them at once, so
+ * clients fail fast, and 'shed' stops accepting until connections close,
+ * leaving new ones in the listen queue and letting the kernel drop the rest.
+ *
+ * Each loop drives a TimingWheel, which 'Timers' returns for handlers to
+ * arm timers of their own on. The wheel is turned on every pass of the
+ * loop, which waits for events no longer than until the next timer is due.
+ * Connections are closed with it after an idle timeout, set for every new
+ * connection with 'SetIdleTimeout' or for one with
+ * 'TcpConnection::SetIdleTimeout', or when a read or write deadline set on
+ * one passes.
+ *
+ * The loop and its connections belong to the thread running it. Only 'Stop'
+ * may be called from another thread.
+ *
+ * __errno and __errmsg are set on error:
+ * - 30xxx = creating the epoll or wake-up descriptor failed (thrown).
+ * - 31xxx = adding a socket to epoll failed.
+ * - 32xxx = waiting for events failed.
+ * - 33xxx = accepting a connection failed for a reason other than an empty
+ *           queue, such as running out of file descriptors. The listener is
+ *           paused until a connection closes.
+ * - 101 = a server without a valid socket file descriptor was given.
+ */
+class TcpEventLoop {
+public:
+
+    /**
+     * A handler for an event on a connection.
+     */
+    using Handler = std::function<void(TcpConnection&)>;
+
+    /**
+     * The most events taken from epoll per wait.
+     */
+    static constexpr int MAX_EVENTS = 256;
+
+    /**
+     * The default most connections accepted per listener per wakeup.
+     */
+    static constexpr std::size_t DEFAULT_ACCEPT_BATCH_SIZE = 64;
+
+    /**
+     * The default queued bytes above which a connection is write-paused,
+     * and to which it must drain to resume.
+     */
+    static constexpr std::size_t DEFAULT_HIGH_WATERMARK = 1024 * 1024;
+    static constexpr std::size_t DEFAULT_LOW_WATERMARK = 256 * 1024;
+
+    /**
+     * What to do with new connections once 'SetConnectionLimit' is reached.
+     */
+    enum class OverloadPolicy : uint8_t {
+        /**
+         * Accept and reset them straight away, so clients fail fast.
+         */
+        reject,
+        /**
+         * Leave them in the listen queue until connections close.
+         */
+        shed
+    };
+
+    /**
+     * @brief   Construct a loop with its own epoll instance.
+     *
+     * @throw TcpError    if the epoll or wake-up descriptors could not be
+     *                      created, with the 30xxx code.
+     */
+    TcpEventLoop() {
+        __errmsg = "";
+        __errno = 0;
+
+        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+        _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_epollFd < 0 || _wakeFd < 0 || !Register(_wakeFd, EPOLLIN | EPOLLET, Tag(Kind::wake, _wakeFd))) {
+            __errno = 30000 + errno;
+            const String msg = String::format("Event loop creation failed: _epollFd: {}, _wakeFd: {}. ERROR CODE: {}.",
+                _epollFd, _wakeFd, __errno);
+            __errmsg = msg;
+            flog << msg;
+            if (_epollFd >= 0) close(_epollFd);
+            if (_wakeFd >= 0) close(_wakeFd);
+            throw TcpError(msg, __errno);
+        }
+
+        llog << "TCP event loop initialised.";
+    }
+
+    TcpEventLoop(const TcpEventLoop&) = delete;
+    TcpEventLoop& operator = (const TcpEventLoop&) = delete;
+
+    /**
+     * Destroy the loop, closing every connection it still holds and calling
+     * the close handler for each.
+     */
+    ~TcpEventLoop() {
+        dlog << "TCP event loop destruction, closing " << _connectionCount << " connections...";
+        for (std::unique_ptr<TcpConnection>& connection : _connections) {
+            if (connection)
+                CloseConnection(*connection);
+        }
+        close(_wakeFd);
+        close(_epollFd);
+    }
+
+    /**
+     * @brief   Accept connections from SERVER, which must already be
+     *          listening. Its socket is made non-blocking with
+     *          'SetNonBlocking', so 'NextConnection' no longer blocks either.
+     *
+     * @param server    The listening server. Must outlive the loop.
+     * @param onAccept  If set, called with the connections accepted from
+     *                  this server instead of the loop's accept handler.
+     * @return true     if the server's socket was added to the loop,
+     * @return false    otherwise.
+     */
+    bool Listen(TcpServer& server, Handler onAccept = nullptr) {
+        __errmsg = "";
+        __errno = 0;
+
+        const int fd = server.GetSocketFd();
+        if (fd < 0) {
+            const String msg = String::format("Event loop listen error, server has no valid socket file descriptor: {}.", fd);
+            __errmsg = msg;
+            elog << msg;
+            __errno = 101;
+            return false;
+        }
+
+        server.SetNonBlocking();
+        if (!Register(fd, EPOLLIN | EPOLLET, Tag(Kind::listener, static_cast<int>(_listeners.size())))) {
+            __errno = 31000 + errno;
+            const String msg = String::format("Failed to add listening socket {} to the event loop.", fd);
+            __errmsg = msg;
+            elog << msg;
+            return false;
+        }
+
+        _listeners.push_back(&server);
+        _listenerAccept.push_back(std::move(onAccept));
+        llog << "Event loop listening on server socket " << fd << ".";
+        return true;
+    }
+
+    /**
+     * @brief   Hand an already connected socket, such as one from
+     *          'TcpServer::NextConnection', to the loop. The socket is made
+     *          non-blocking and the loop closes it when the connection ends.
+     *          The accept handler is not called for it.
+     *
+     * @param fd    The connected socket file descriptor.
+     * @return      The connection, or null if it could not be added.
+     */
+    TcpConnection* Adopt(const int fd) {
+        __errmsg = "";
+        __errno = 0;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        return AddConnection(fd);
+    }
+
+    /**
+     * Set the most connections accepted from each listener per wakeup. A
+     * larger batch accepts a storm of connections with fewer trips around
+     * the loop, a smaller one keeps the open connections more responsive
+     * while it does.
+     */
+    void SetAcceptBatchSize(const std::size_t size) noexcept { _acceptBatchSize = (size > 0 ? size : 1); }
+
+    /**
+     * @brief   Cap the open connections at LIMIT, handling new connections
+     *          beyond it with POLICY.
+     *
+     * @param limit     The most open connections, or 0 for no limit.
+     * @param policy    What to do with new connections beyond the limit.
+     */
+    void SetConnectionLimit(const std::size_t limit, const OverloadPolicy policy = OverloadPolicy::shed) noexcept {
+        _connectionLimit = limit;
+        _overloadPolicy = policy;
+    }
+
+    /**
+     * Set the size of the buffer each connection's 'ReadBuffer' leases, up
+     * to 'BufferPool::LARGE_BUFFER_SIZE'. Applies to connections added
+     * after the call.
+     *
+     * @throw invalid_argument if SIZE is more than
+     *                         'BufferPool::LARGE_BUFFER_SIZE'.
+     */
+    void SetReadBufferSize(const std::size_t size) {
+        if (size > BufferPool::LARGE_BUFFER_SIZE)
+            throw std::invalid_argument("TcpEventLoop read buffers are at most 64 KB");
+        _readBufferSize = size;
+    }
+
+    /**
+     * Set the write watermarks of connections added after the call. A
+     * connection is write-paused once 'TcpConnection::Write' has queued more
+     * than HIGH_WATERMARK bytes, and resumed once they drain to
+     * LOW_WATERMARK, which is capped at HIGH_WATERMARK.
+     */
+    void SetWriteWatermarks(const std::size_t lowWatermark, const std::size_t highWatermark) noexcept {
+        _highWatermark = highWatermark;
+        _lowWatermark = std::min(lowWatermark, highWatermark);
+    }
+
+    /**
+     * Close connections added after the call once nothing has been read
+     * from or sent on them for TIMEOUT, or not if TIMEOUT is 0, which is the
+     * default. A connection's own timeout can be changed with
+     * 'TcpConnection::SetIdleTimeout'.
+     */
+    void SetIdleTimeout(const std::chrono::milliseconds timeout) noexcept { _idleTimeout = timeout; }
+
+    /**
+     * Returns the loop's timing wheel, to arm timers that are called on the
+     * loop's thread like its handlers.
+     */
+    TimingWheel& Timers() noexcept { return _timers; }
+
+    /**
+     * Returns the number of connection objects made, which stops growing
+     * once as many have been made as were ever open at once.
+     */
+    std::size_t ConnectionObjectCount() const noexcept { return _connectionPool.created_count(); }
+
+    /**
+     * Returns the number of connections reset by the 'reject' overload
+     * policy.
+     */
+    std::size_t RejectedCount() const noexcept { return _rejectedCount; }
+
+    /**
+     * Set the handler called with each newly accepted connection.
+     */
+    void OnAccept(Handler handler) { _onAccept = std::move(handler); }
+
+    /**
+     * Set the handler called when a connection becomes readable, including
+     * when the peer closes it, which a 'Read' of 0 reports.
+     */
+    void OnReadable(Handler handler) { _onReadable = std::move(handler); }
+
+    /**
+     * Set the handler called when a connection becomes writable: once after
+     * it is added, and again whenever its send buffer drains after a 'Send'
+     * would have blocked.
+     */
+    void OnWritable(Handler handler) { _onWritable = std::move(handler); }
+
+    /**
+     * Set the handler called when a write-paused connection's queue drains
+     * to the low watermark, for the producer to resume writing to it.
+     */
+    void OnDrain(Handler handler) { _onDrain = std::move(handler); }
+
+    /**
+     * Set the handler called with a connection just before the loop closes
+     * it.
+     */
+    void OnClose(Handler handler) { _onClose = std::move(handler); }
+
+    /**
+     * @brief   Wait up to TIMEOUT_MILLISECONDS for events, call any timers
+     *          that have expired, then handle the events. The wait is cut
+     *          short when the next timer is due.
+     *
+     * @param timeout_milliseconds  The longest to wait, 0 to only handle
+     *                              events already waiting, or -1 to wait
+     *                              until there is one.
+     * @return                      The number of events handled, or -1 on
+     *                              error.
+     */
+    int RunOnce(const int timeout_milliseconds = -1) {
+        //  Listeners left with connections waiting by the last batch are
+        //  not reported again, so do not wait for events while there are any,
+        //  nor while connections closed outside a handler wait to be closed
+        _acceptNow.swap(_acceptReady);
+        _acceptReady.clear();
+
+        int timeout = (_acceptNow.empty() && _closing.empty() ? timeout_milliseconds : 0);
+        const int next = _timers.NextTimeout();
+        if (next >= 0 && (timeout < 0 || next < timeout))
+            timeout = next;
+
+        const int count = epoll_wait(_epollFd, _events.data(), MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR)
+                return 0;
+            __errno = 32000 + errno;
+            const String msg = String::format("Waiting for events failed: _epollFd: {}.", _epollFd);
+            __errmsg = msg;
+            elog << msg;
+            return -1;
+        }
+
+        //  Before the events, so the handlers see the wheel's current tick
+        //  when they note activity or arm timers
+        _timers.Advance();
+
+        for (int i = 0; i < count; i++) {
+            const uint64_t tag = _events[i].data.u64;
+            const int fd = static_cast<int>(tag & 0xFFFFFFFF);
+            switch (static_cast<Kind>(tag >> 32)) {
+            case Kind::listener:
+                Accept(static_cast<std::size_t>(fd));
+                break;
+            case Kind::wake: {
+                uint64_t value;
+                while (read(_wakeFd, &value, sizeof(value)) > 0) {}
+                break;
+            }
+            case Kind::connection:
+                if (static_cast<std::size_t>(fd) < _connections.size() && _connections[fd])
+                    Dispatch(*_connections[fd], _events[i].events);
+                break;
+            }
+        }
+
+        for (const std::size_t listener : _acceptNow)
+            Accept(listener);
+        _acceptNow.clear();
+
+        //  Closed after the whole batch, so a later event in it never finds
+        //  a descriptor number reused by a new connection. A close handler
+        //  can close more, which are closed here too
+        for (std::size_t i = 0; i < _closing.size(); i++)
+            CloseConnection(*_closing[i]);
+
+        //  Paused listeners are retried once there is room again
+        if (!_closing.empty() && !_acceptPaused.empty() && !AtConnectionLimit()) {
+            for (const std::size_t listener : _acceptPaused)
+                Queue(_acceptReady, listener);
+            _acceptPaused.clear();
+        }
+        _closing.clear();
+
+        return count;
+    }
+
+    /**
+     * Handle events until 'Stop' is called, returning straight away if it
+     * already was since the last 'Run'. Returns false if waiting for events
+     * failed, true if stopped.
+     */
+    bool Run() {
+        while (!_stopping.exchange(false)) {
+            if (RunOnce(-1) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Make 'Run' return once the events it is handling are done. Safe to call
+     * from any thread, including from a handler.
+     */
+    void Stop() noexcept {
+        _stopping.store(true);
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(_wakeFd, &one, sizeof(one));
+    }
+
+    /**
+     * Returns the number of open connections the loop holds.
+     */
+    std::size_t ConnectionCount() const noexcept { return _connectionCount; }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    /**
+     * What a registered descriptor is, kept in the top half of its epoll
+     * data next to the descriptor itself.
+     */
+    enum class Kind : uint32_t { listener, connection, wake };
+
+    /**
+     * Returns the epoll data for FD of KIND. For a listener, FD is its index
+     * in '_listeners'.
+     */
+    static uint64_t Tag(const Kind kind, const int fd) noexcept {
+        return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(fd);
+    }
+
+    /**
+     * Add FD to epoll for EVENTS with TAG. Returns false on error.
+     */
+    bool Register(const int fd, const uint32_t events, const uint64_t tag) noexcept {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = tag;
+        return epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    /**
+     * Wrap the non-blocking socket FD in a connection and add it to epoll.
+     * Closes FD and returns null on error.
+     */
+    TcpConnection* AddConnection(const int fd) {
+        if (!Register(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, Tag(Kind::connection, fd))) {
+            __errno = 31000 + errno;
+            const String msg = String::format("Failed to add connection {} to the event loop.", fd);
+            __errmsg = msg;
+            elog << msg;
+            close(fd);
+            return nullptr;
+        }
+
+        if (static_cast<std::size_t>(fd) >= _connections.size())
+            _connections.resize(static_cast<std::size_t>(fd) + 1);
+        _connections[fd] = _connectionPool.acquire();
+        _connections[fd]->Reset(fd, &_closing, &_timers, _readBufferSize, _lowWatermark, _highWatermark);
+        if (_idleTimeout.count() > 0)
+            _connections[fd]->SetIdleTimeout(_idleTimeout);
+        _connectionCount++;
+        return _connections[fd].get();
+    }
+
+    /**
+     * Returns true if the connection limit is set and reached.
+     */
+    bool AtConnectionLimit() const noexcept {
+        return _connectionLimit > 0 && _connectionCount >= _connectionLimit;
+    }
+
+    /**
+     * Accept up to a batch of the connections waiting on listener LISTENER.
+     * An edge-triggered listener is not reported again until a new
+     * connection arrives, so if the batch is filled it is queued to be
+     * accepted from again on the next turn of the loop.
+     */
+    void Accept(const std::size_t listener) {
+        TcpServer& server = *_listeners[listener];
+
+        std::size_t batch = _acceptBatchSize;
+        if (_overloadPolicy == OverloadPolicy::shed && _connectionLimit > 0) {
+            if (AtConnectionLimit()) {
+                Queue(_acceptPaused, listener);
+                return;
+            }
+            batch = std::min(batch, _connectionLimit - _connectionCount);
+        }
+
+        _accepted.clear();
+        const int count = server.NextConnections(_accepted, batch);
+        const bool failed = (count < 0 || server.ERR_NO() != 0);
+        if (failed) {
+            __errno = 33000 + (server.ERR_NO() - 17000);
+            const String msg = String::format("Failed to accept new connection: listening socket: {}.",
+                server.GetSocketFd());
+            __errmsg = msg;
+            elog << msg;
+            Queue(_acceptPaused, listener);
+        }
+        else if (static_cast<std::size_t>(count) == batch) {
+            Queue(_acceptReady, listener);
+        }
+
+        for (const int fd : _accepted) {
+            if (AtConnectionLimit()) {
+                Reject(fd);
+                continue;
+            }
+
+            TcpConnection* connection = AddConnection(fd);
+            if (connection == nullptr)
+                continue;
+            //  Looked up for each, as a handler can add listeners
+            if (_listenerAccept[listener])
+                _listenerAccept[listener](*connection);
+            else if (_onAccept)
+                _onAccept(*connection);
+        }
+    }
+
+    /**
+     * Add LISTENER to QUEUE if it is not already in it, as a paused listener
+     * is reported again by every new connection.
+     */
+    static void Queue(std::vector<std::size_t>& queue, const std::size_t listener) {
+        if (std::find(queue.begin(), queue.end(), listener) == queue.end())
+            queue.push_back(listener);
+    }
+
+    /**
+     * Close the new connection FD with a reset rather than a graceful close,
+     * so its client sees the refusal at once.
+     */
+    void Reject(const int fd) noexcept {
+        const linger reset = { 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        close(fd);
+        _rejectedCount++;
+    }
+
+    /**
+     * Call the handlers for EVENTS on CONNECTION.
+     */
+    void Dispatch(TcpConnection& connection, const uint32_t events) {
+        if (connection._closing)
+            return;
+
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            Readable(connection);
+        if ((events & EPOLLOUT) && !connection._closing) {
+            connection.Flush();
+            if (connection._writePaused && !connection._closing
+                && connection._queuedBytes <= connection._lowWatermark) {
+                connection._writePaused = false;
+                if (_onDrain)
+                    _onDrain(connection);
+                if (connection._readPending && !connection._closing)
+                    Readable(connection);
+            }
+            if (!connection._closing && _onWritable)
+                _onWritable(connection);
+        }
+
+        //  Both directions are gone, nothing more can happen on it
+        if (events & (EPOLLHUP | EPOLLERR))
+            connection.Close();
+    }
+
+    /**
+     * Call the readable handler for CONNECTION, unless it is write-paused,
+     * in which case it is called once the connection resumes.
+     */
+    void Readable(TcpConnection& connection) {
+        connection._readPending = connection._writePaused;
+        if (connection._writePaused || !_onReadable)
+            return;
+        _onReadable(connection);
+        //  Stopped reading part way because its writes paused
+        connection._readPending = connection._writePaused;
+    }
+
+    /**
+     * Call the close handler for CONNECTION, then close and free it.
+     */
+    void CloseConnection(TcpConnection& connection) {
+        const int fd = connection._fd;
+        if (_onClose)
+            _onClose(connection);
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        _timers.Cancel(connection._idleTimer);
+        _timers.Cancel(connection._readTimer);
+        _timers.Cancel(connection._writeTimer);
+        connection._readBuffer.release();
+        connection._writeQueue.clear();
+        _connectionPool.release(std::move(_connections[fd]));
+        _connectionCount--;
+    }
+
+    int _epollFd = -1;
+    int _wakeFd = -1;
+    std::atomic<bool> _stopping{false};
+    std::array<epoll_event, MAX_EVENTS> _events;
+
+    /**
+     * The loop's timers, declared before the connections so it outlives the
+     * timers they hold.
+     */
+    TimingWheel _timers;
+    std::chrono::milliseconds _idleTimeout{0};
+
+    /**
+     * The open connections, indexed by socket file descriptor, which the
+     * kernel keeps small and dense.
+     */
+    std::vector<std::unique_ptr<TcpConnection>> _connections;
+    std::size_t _connectionCount = 0;
+
+    /**
+     * Closed connection objects, kept for the next connections.
+     */
+    ObjectPool<TcpConnection> _connectionPool{ []() { return new TcpConnection(); } };
+    std::size_t _readBufferSize = BufferPool::MEDIUM_BUFFER_SIZE;
+    std::size_t _lowWatermark = DEFAULT_LOW_WATERMARK;
+    std::size_t _highWatermark = DEFAULT_HIGH_WATERMARK;
+
+    /**
+     * The connections to close at the end of the current batch of events,
+     * put here by 'TcpConnection::Close'.
+     */
+    std::vector<TcpConnection*> _closing;
+
+    /**
+     * The listening servers, indexed by the tag they are registered with,
+     * and the accept handler given for each, if any.
+     */
+    std::vector<TcpServer*> _listeners;
+    std::vector<Handler> _listenerAccept;
+
+    /**
+     * The listeners that filled their accept batch, to accept from again
+     * on the next turn of the loop, and those being accepted from now.
+     */
+    std::vector<std::size_t> _acceptReady;
+    std::vector<std::size_t> _acceptNow;
+
+    /**
+     * The listeners not accepted from until a connection closes, because
+     * the connection limit was reached or accepting failed.
+     */
+    std::vector<std::size_t> _acceptPaused;
+
+    /**
+     * The socket file descriptors accepted by the current batch.
+     */
+    std::vector<int> _accepted;
+
+    std::size_t _acceptBatchSize = DEFAULT_ACCEPT_BATCH_SIZE;
+    std::size_t _connectionLimit = 0;
+    OverloadPolicy _overloadPolicy = OverloadPolicy::shed;
+    std::size_t _rejectedCount = 0;
+
+    Handler _onAccept;
+    Handler _onReadable;
+    Handler _onWritable;
+    Handler _onDrain;
+    Handler _onClose;
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_EVENT_LOOP_H__
@@ -0,0 +1,1177 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_IO_SERVICE_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_IO_SERVICE_H__
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io_pool.h"
+#include "log.h"
+#include "string.h"
+#include "tcp_event_loop.h"
+#include "tcp_server.h"
+
+class TcpIoService;
+
+/**
+ * One connection served by a TcpIoService. Incoming bytes are handed to the
+ * service's data handler as they arrive, so there is no 'Read'. 'Send'
+ * queues bytes and returns straight away; the service sends them in order
+ * as the socket allows.
+ *
+ * Once more than the service's high watermark is queued the connection is
+ * write-paused: 'Send' returns false to tell the producer to stop, and the
+ * service stops receiving on it, so a client that does not read what it is
+ * sent cannot make the server buffer without limit. When the queue drains
+ * to the low watermark the drain handler is called and receiving resumes.
+ *
+ * Connections are owned, closed and reused by their service, as
+ * TcpConnections are by a TcpEventLoop, so do not keep pointers to one after
+ * its close handler has run.
+ *
+ * __errno and __errmsg are set on error, using the same 13xxx codes as
+ * TcpClient for failed reads and sends.
+ */
+class IoConnection {
+public:
+
+    IoConnection(const IoConnection&) = delete;
+    IoConnection& operator = (const IoConnection&) = delete;
+
+    /**
+     * Get this connection's socket file descriptor value.
+     */
+    int GetSocketFd() const noexcept { return _fd; }
+
+    /**
+     * @brief   Queue LENGTH bytes at DATA to be sent after any already
+     *          queued. The bytes are copied, so DATA can be reused straight
+     *          away.
+     *
+     * @return true     if the bytes were queued and the queue is within the
+     *                  high watermark,
+     * @return false    if the connection is now write-paused, with the bytes
+     *                  still queued, or is closing, in which case they were
+     *                  dropped. Stop producing until the drain handler is
+     *                  called.
+     */
+    inline bool Send(const void* data, std::size_t length);
+
+    /**
+     * Queue DATA to be sent, as 'Send(data, length)'.
+     */
+    bool Send(const std::string_view data) { return Send(data.data(), data.size()); }
+
+    /**
+     * Returns the number of bytes queued by 'Send' that the kernel has not
+     * yet taken.
+     */
+    std::size_t PendingBytes() const noexcept {
+        if (_connection != nullptr)
+            return _connection->QueuedBytes();
+        return (_outbox.size() + _sending.size()) - _sent;
+    }
+
+    /**
+     * Returns true from when more than the high watermark is queued until
+     * the queue drains to the low watermark.
+     */
+    bool IsWritePaused() const noexcept {
+        return (_connection != nullptr ? _connection->IsWritePaused() : _writePaused);
+    }
+
+    /**
+     * Ask the service to close this connection. Bytes already queued may not
+     * be sent. The close handler is called once the service has finished
+     * with it.
+     */
+    inline void Close();
+
+    /**
+     * Returns true once 'Close' has been called or the service has seen the
+     * connection end.
+     */
+    bool IsClosing() const noexcept {
+        return _closing || (_connection != nullptr && _connection->IsClosing());
+    }
+
+    /**
+     * Attach DATA to this connection. The service never reads or frees it.
+     */
+    void SetUserData(void* data) noexcept { _userData = data; }
+
+    /**
+     * Get the data attached with 'SetUserData', or null.
+     */
+    void* GetUserData() const noexcept { return _userData; }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    friend class TcpIoService;
+
+    IoConnection() = default;
+
+    /**
+     * Make this object, new or reused, the connection for socket FD on
+     * SERVICE. CONNECTION is the event loop's connection with the epoll
+     * backend, or null with io_uring.
+     */
+    void Reset(TcpIoService* service, const int fd, TcpConnection* connection) noexcept {
+        _service = service;
+        _fd = fd;
+        _connection = connection;
+        _closing = false;
+        _userData = nullptr;
+        _outbox.clear();
+        _sending.clear();
+        _sent = 0;
+        _writePaused = false;
+        _receiving = false;
+        _pendingOps = 0;
+        __errmsg.clear();
+        __errno = 0;
+    }
+
+    /**
+     * Record a failed read or send with ERROR.
+     */
+    void Failed(const char* what, const int error) {
+        __errno = 13000 + error;
+        const String msg = String::format("{}, _socketFd: {}, errno: {}.", what, _fd, error);
+        __errmsg = msg;
+        elog << msg;
+    }
+
+    TcpIoService* _service = nullptr;
+    int _fd = -1;
+    TcpConnection* _connection = nullptr;
+    bool _closing = false;
+    void* _userData = nullptr;
+
+    /**
+     * Bytes queued by 'Send' and not yet handed to the kernel, and the bytes
+     * being sent now, of which '_sent' have gone. Swapped rather than copied
+     * when a send finishes, so both keep their capacity.
+     */
+    std::string _outbox;
+    std::string _sending;
+    std::size_t _sent = 0;
+    bool _writePaused = false;
+
+    /**
+     * Set while a multishot receive is armed on the connection.
+     */
+    bool _receiving = false;
+
+    /**
+     * The io_uring operations in flight on this connection. It is only
+     * closed once none are left.
+     */
+    int _pendingOps = 0;
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+/**
+ * A completion-based TCP server that runs on io_uring where the kernel has
+ * it, and otherwise on a TcpEventLoop (epoll), behind one API:
+ *
+ *     TcpIoService service;
+ *     service.Listen(server);
+ *     service.OnData([](IoConnection& conn, const char* data, std::size_t n) {
+ *         conn.Send(data, n);
+ *     });
+ *     service.Run();
+ *
+ * With io_uring, the kernel does the socket work itself and only reports
+ * what completed, so serving a connection costs no system call per
+ * operation: one multishot accept per listener keeps accepting, one
+ * multishot receive per connection keeps receiving into whichever buffer
+ * of a ring registered with the kernel is free (leased from
+ * 'BufferPool::Global' and shared by every connection, and given back by
+ * writing it to the ring once handled), and sends, socket shutdowns and
+ * closes are submitted in batches with one io_uring_enter per turn of the
+ * loop. This needs Linux 6.0 or later.
+ *
+ * With epoll, the event loop's readable events are turned into the same
+ * data handler calls, and bytes are sent with 'TcpConnection::Write'.
+ *
+ * Each connection's queued bytes are kept within the watermarks set by
+ * 'SetWriteWatermarks'. Above the high watermark the service stops
+ * receiving on the connection: with io_uring its multishot receive is
+ * cancelled, and with epoll the loop stops reading it.
+ *
+ * The service and its connections belong to the thread running it. Only
+ * 'Stop' may be called from another thread.
+ *
+ * __errno and __errmsg are set on error, or copied from the event loop
+ * with the epoll backend:
+ * - 34xxx = setting up io_uring failed (thrown if io_uring was asked for).
+ * - 35xxx = submitting to or waiting on io_uring failed.
+ * - 36xxx = an io_uring accept failed. The listener is paused until a
+ *           connection closes.
+ * - 101 = a server without a valid socket file descriptor was given.
+ */
+class TcpIoService {
+public:
+
+    /**
+     * The kernel interface the service runs on.
+     */
+    enum class Backend : uint8_t {
+        /**
+         * io_uring if the kernel supports it, otherwise epoll.
+         */
+        automatic,
+        io_uring,
+        epoll
+    };
+
+    /**
+     * A handler for an event on a connection.
+     */
+    using Handler = std::function<void(IoConnection&)>;
+
+    /**
+     * A handler for LENGTH bytes received at DATA on a connection. The bytes
+     * are only valid until the handler returns.
+     */
+    using DataHandler = std::function<void(IoConnection&, const char* data, std::size_t length)>;
+
+    /**
+     * The number of submission queue entries in the ring.
+     */
+    static constexpr unsigned int RING_ENTRIES = 256;
+
+    /**
+     * The number of receive buffers in the ring registered with the kernel,
+     * shared by all connections.
+     */
+    static constexpr unsigned int RECV_BUFFER_COUNT = 64;
+    static_assert((RECV_BUFFER_COUNT & (RECV_BUFFER_COUNT - 1)) == 0,
+        "A buffer ring's size must be a power of 2");
+
+    /**
+     * The size of each receive buffer.
+     */
+    static constexpr std::size_t RECV_BUFFER_SIZE = BufferPool::MEDIUM_BUFFER_SIZE;
+
+    /**
+     * @brief   Construct a service on BACKEND.
+     *
+     * @throw runtime_error if io_uring was asked for and could not be set
+     *                      up, or the event loop could not be created.
+     */
+    explicit TcpIoService(const Backend backend = Backend::automatic) {
+        __errmsg = "";
+        __errno = 0;
+
+        if (backend != Backend::epoll && (backend == Backend::io_uring || UringSupported())) {
+            if (SetupUring()) {
+                _backend = Backend::io_uring;
+                llog << "TCP IO service initialised with io_uring.";
+                return;
+            }
+            if (backend == Backend::io_uring)
+                throw std::runtime_error(__errmsg);
+            wlog << "io_uring could not be set up, falling back to epoll: " << __errmsg;
+        }
+
+        SetupEpoll();
+        _backend = Backend::epoll;
+        llog << "TCP IO service initialised with epoll.";
+    }
+
+    TcpIoService(const TcpIoService&) = delete;
+    TcpIoService& operator = (const TcpIoService&) = delete;
+
+    /**
+     * Destroy the service, closing every connection it still holds and
+     * calling the close handler for each.
+     */
+    ~TcpIoService() {
+        if (_backend != Backend::io_uring) {
+            //  Before the handlers and pool its close handler uses are gone
+            _loop.reset();
+            return;
+        }
+
+        dlog << "TCP IO service destruction, closing " << _connectionCount << " connections...";
+        _destroying = true;
+        for (std::unique_ptr<IoConnection>& connection : _connections) {
+            if (connection)
+                Close(*connection);
+        }
+        for (int i = 0; i < 100 && _connectionCount > 0; i++) {
+            if (RunOnce(10) < 0)
+                break;
+        }
+        for (int i = 0; i < 100 && (_toSubmit > 0 || !_overflow.empty()); i++) {
+            if (RunOnce(0) < 0)
+                break;
+        }
+
+        //  Closing the ring cancels anything still in flight, so whatever did
+        //  not finish closing can then be closed directly
+        close(_ringFd);
+        for (std::unique_ptr<IoConnection>& connection : _connections) {
+            if (!connection)
+                continue;
+            if (_onClose)
+                _onClose(*connection);
+            close(connection->_fd);
+        }
+        close(_wakeFd);
+        munmap(_bufRing, _bufRingSize);
+        munmap(_sqRing, _sqRingSize);
+        if (_cqRing != _sqRing)
+            munmap(_cqRing, _cqRingSize);
+        munmap(_sqes, _sqesSize);
+    }
+
+    /**
+     * Returns true if this kernel has everything the io_uring backend needs,
+     * and io_uring is not disabled.
+     */
+    static bool UringSupported() {
+        static const bool supported = []() {
+            utsname name;
+            int major = 0, minor = 0;
+            if (uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6)
+                return false;
+
+            io_uring_params params{};
+            const int fd = static_cast<int>(syscall(__NR_io_uring_setup, 4, &params));
+            if (fd < 0)
+                return false;
+
+            const std::size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+            std::unique_ptr<char[]> probeBuffer(new char[probeSize]());
+            io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.get());
+            bool result = (params.features & IORING_FEAT_EXT_ARG)
+                && syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) >= 0;
+            for (const int op : { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_SHUTDOWN,
+                    IORING_OP_CLOSE, IORING_OP_READ, IORING_OP_ASYNC_CANCEL }) {
+                result = result && op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+            }
+            close(fd);
+            return result;
+        }();
+        return supported;
+    }
+
+    /**
+     * Returns the backend the service is running on.
+     */
+    Backend GetBackend() const noexcept { return _backend; }
+
+    /**
+     * @brief   Accept connections from SERVER, which must already be
+     *          listening.
+     *
+     * @param server    The listening server. Must outlive the service.
+     * @return true     if the server was added,
+     * @return false    otherwise.
+     */
+    bool Listen(TcpServer& server) {
+        __errmsg = "";
+        __errno = 0;
+
+        if (_backend == Backend::epoll) {
+            if (_loop->Listen(server))
+                return true;
+            __errmsg = _loop->ERR_MSG();
+            __errno = _loop->ERR_NO();
+            return false;
+        }
+
+        if (server.GetSocketFd() < 0) {
+            const String msg = String::format("IO service listen error, server has no valid socket file "
+                "descriptor: {}.", server.GetSocketFd());
+            __errmsg = msg;
+            elog << msg;
+            __errno = 101;
+            return false;
+        }
+
+        _listeners.push_back(&server);
+        SubmitAccept(_listeners.size() - 1);
+        llog << "IO service listening on server socket " << server.GetSocketFd() << ".";
+        return true;
+    }
+
+    /**
+     * Set the handler called with each newly accepted connection.
+     */
+    void OnAccept(Handler handler) { _onAccept = std::move(handler); }
+
+    /**
+     * Set the handler called with bytes received on a connection.
+     */
+    void OnData(DataHandler handler) { _onData = std::move(handler); }
+
+    /**
+     * Set the handler called when a write-paused connection's queue drains
+     * to the low watermark, for the producer to resume sending to it.
+     */
+    void OnDrain(Handler handler) { _onDrain = std::move(handler); }
+
+    /**
+     * Set the handler called with a connection once the service has
+     * finished with it, just before its socket is closed.
+     */
+    void OnClose(Handler handler) { _onClose = std::move(handler); }
+
+    /**
+     * Set the write watermarks of connections accepted after the call. A
+     * connection is write-paused once more than HIGH_WATERMARK bytes are
+     * queued on it, and resumed once they drain to LOW_WATERMARK, which is
+     * capped at HIGH_WATERMARK.
+     */
+    void SetWriteWatermarks(const std::size_t lowWatermark, const std::size_t highWatermark) noexcept {
+        _highWatermark = highWatermark;
+        _lowWatermark = std::min(lowWatermark, highWatermark);
+        if (_loop)
+            _loop->SetWriteWatermarks(lowWatermark, highWatermark);
+    }
+
+    /**
+     * @brief   Wait up to TIMEOUT_MILLISECONDS for completions, or events,
+     *          and handle them.
+     *
+     * @param timeout_milliseconds  The longest to wait, 0 to only handle
+     *                              those already waiting, or -1 to wait
+     *                              until there is one.
+     * @return                      The number handled, or -1 on error.
+     */
+    int RunOnce(const int timeout_milliseconds = -1) {
+        if (_backend == Backend::epoll) {
+            const int count = _loop->RunOnce(timeout_milliseconds);
+            if (count < 0) {
+                __errmsg = _loop->ERR_MSG();
+                __errno = _loop->ERR_NO();
+            }
+            return count;
+        }
+
+        FlushOverflow();
+        //  Entries still held back are submitted next turn, so don't wait
+        const bool ready = (LoadAcquire(_cqTail) != *_cqHead || !_overflow.empty());
+        unsigned int flags = IORING_ENTER_GETEVENTS;
+        unsigned int minimum = (ready || timeout_milliseconds == 0 ? 0 : 1);
+        io_uring_getevents_arg argument{};
+        __kernel_timespec timeout{};
+        void* argumentPointer = nullptr;
+        std::size_t argumentSize = 0;
+        if (timeout_milliseconds > 0 && minimum > 0) {
+            timeout.tv_sec = timeout_milliseconds / 1000;
+            timeout.tv_nsec = (timeout_milliseconds % 1000) * 1000000L;
+            argument.ts = reinterpret_cast<uint64_t>(&timeout);
+            argumentPointer = &argument;
+            argumentSize = sizeof(argument);
+            flags |= IORING_ENTER_EXT_ARG;
+        }
+
+        if (!Enter(_toSubmit, minimum, flags, argumentPointer, argumentSize))
+            return -1;
+        return Reap();
+    }
+
+    /**
+     * Handle completions until 'Stop' is called, returning straight away if
+     * it already was since the last 'Run'. Returns false if waiting failed,
+     * true if stopped.
+     */
+    bool Run() {
+        if (_backend == Backend::epoll)
+            return _loop->Run();
+
+        while (!_stopping.exchange(false)) {
+            if (RunOnce(-1) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Make 'Run' return once the completions it is handling are done. Safe
+     * to call from any thread, including from a handler.
+     */
+    void Stop() noexcept {
+        if (_backend == Backend::epoll) {
+            _loop->Stop();
+            return;
+        }
+        _stopping.store(true);
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(_wakeFd, &one, sizeof(one));
+    }
+
+    /**
+     * Returns the number of open connections the service holds.
+     */
+    std::size_t ConnectionCount() const noexcept {
+        return (_backend == Backend::epoll ? _loop->ConnectionCount() : _connectionCount);
+    }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    friend class IoConnection;
+
+    /**
+     * What a submission was for, kept in the top byte of its user data next
+     * to the connection's socket, or the listener's index.
+     */
+    enum class Operation : uint8_t { accept, recv, send, shutdown, close, wake, cancel };
+
+    static uint64_t Tag(const Operation operation, const int fd) noexcept {
+        return (static_cast<uint64_t>(operation) << 56) | static_cast<uint32_t>(fd);
+    }
+
+    static unsigned int LoadAcquire(const unsigned int* value) noexcept {
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    static void StoreRelease(unsigned int* value, const unsigned int newValue) noexcept {
+        __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+    }
+
+    //  ###### epoll backend ######
+    //  ######################################################################
+
+    /**
+     * Run on a TcpEventLoop, turning its events into this service's
+     * handlers.
+     */
+    void SetupEpoll() {
+        _loop.reset(new TcpEventLoop());
+        _loop->OnAccept([this](TcpConnection& conn) {
+            std::unique_ptr<IoConnection> connection = _connectionPool.acquire();
+            connection->Reset(this, conn.GetSocketFd(), &conn);
+            conn.SetUserData(connection.release());
+            if (_onAccept)
+                _onAccept(*static_cast<IoConnection*>(conn.GetUserData()));
+        });
+        _loop->OnReadable([this](TcpConnection& conn) {
+            IoConnection& connection = *static_cast<IoConnection*>(conn.GetUserData());
+            IoBuffer& buff = conn.ReadBuffer();
+            //  A pause stops reading part way, and the loop calls this again
+            //  once the connection resumes
+            while (!conn.IsClosing() && !conn.IsWritePaused()) {
+                const int bytes = conn.Read(buff.data(), buff.size());
+                if (bytes > 0) {
+                    if (_onData)
+                        _onData(connection, buff.data(), static_cast<std::size_t>(bytes));
+                    continue;
+                }
+                if (bytes == 0 || !conn.WouldBlock()) {
+                    if (bytes < 0)
+                        connection.Failed("Error reading bytes", conn.ERR_NO() - 13000);
+                    conn.Close();
+                }
+                break;
+            }
+        });
+        _loop->OnDrain([this](TcpConnection& conn) {
+            if (_onDrain)
+                _onDrain(*static_cast<IoConnection*>(conn.GetUserData()));
+        });
+        _loop->OnClose([this](TcpConnection& conn) {
+            IoConnection* connection = static_cast<IoConnection*>(conn.GetUserData());
+            connection->_closing = true;
+            if (_onClose)
+                _onClose(*connection);
+            _connectionPool.release(std::unique_ptr<IoConnection>(connection));
+        });
+    }
+
+    //  ###### io_uring backend ######
+    //  ######################################################################
+
+    /**
+     * Set up the ring, map its queues, register the receive buffers and arm
+     * the wake-up read. Sets __errmsg and __errno and returns false on error,
+     * undoing what was done.
+     */
+    bool SetupUring() {
+        io_uring_params params{};
+        params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = RING_ENTRIES * 8;
+        params.flags |= IORING_SETUP_CQSIZE;
+        _ringFd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+        if (_ringFd < 0 && errno == EINVAL) {
+            params = io_uring_params{};
+            _ringFd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+        }
+        if (_ringFd < 0)
+            return UringFailed("io_uring_setup");
+
+        _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+
+        _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            _ringFd, IORING_OFF_SQ_RING);
+        if (_sqRing == MAP_FAILED)
+            return UringFailed("mapping the submission queue");
+        _cqRing = _sqRing;
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+            _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                _ringFd, IORING_OFF_CQ_RING);
+            if (_cqRing == MAP_FAILED)
+                return UringFailed("mapping the completion queue");
+        }
+        _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        _sqes = static_cast<io_uring_sqe*>(mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES));
+        if (_sqes == MAP_FAILED)
+            return UringFailed("mapping the submission queue entries");
+
+        char* sq = static_cast<char*>(_sqRing);
+        _sqHead = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        _sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        _sqEntries = params.sq_entries;
+        _sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(_cqRing);
+        _cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        //  The ring of receive buffers the kernel picks from for each
+        //  multishot receive completion, filled before any receive is
+        //  submitted
+        _bufRingSize = RECV_BUFFER_COUNT * sizeof(io_uring_buf);
+        void* bufRing = mmap(nullptr, _bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufRing == MAP_FAILED)
+            return UringFailed("mapping the receive buffer ring");
+        _bufRing = static_cast<io_uring_buf*>(bufRing);
+        io_uring_buf_reg registration{};
+        registration.ring_addr = reinterpret_cast<uint64_t>(_bufRing);
+        registration.ring_entries = RECV_BUFFER_COUNT;
+        registration.bgid = 0;
+        if (syscall(__NR_io_uring_register, _ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+            return UringFailed("registering the receive buffer ring");
+        for (unsigned int i = 0; i < RECV_BUFFER_COUNT; i++) {
+            _recvBuffers.push_back(BufferPool::Global().lease(RECV_BUFFER_SIZE));
+            RecycleBuffer(static_cast<uint16_t>(i));
+        }
+
+        _wakeFd = eventfd(0, EFD_CLOEXEC);
+        if (_wakeFd < 0)
+            return UringFailed("creating the wake-up descriptor");
+        SubmitWake();
+        return true;
+    }
+
+    /**
+     * Record that setting up io_uring failed at WHAT, undo the setup so far
+     * and return false.
+     */
+    bool UringFailed(const char* what) {
+        __errno = 34000 + errno;
+        const String msg = String::format("io_uring setup failed {}, ERROR CODE: {}.", what, __errno);
+        __errmsg = msg;
+        elog << msg;
+
+        _recvBuffers.clear();
+        if (_bufRing != nullptr)
+            munmap(_bufRing, _bufRingSize);
+        if (_sqes != nullptr && _sqes != MAP_FAILED)
+            munmap(_sqes, _sqesSize);
+        if (_cqRing != nullptr && _cqRing != MAP_FAILED && _cqRing != _sqRing)
+            munmap(_cqRing, _cqRingSize);
+        if (_sqRing != nullptr && _sqRing != MAP_FAILED)
+            munmap(_sqRing, _sqRingSize);
+        if (_ringFd >= 0)
+            close(_ringFd);
+        _bufRing = nullptr;
+        _sqes = nullptr;
+        _sqRing = _cqRing = nullptr;
+        _ringFd = -1;
+        return false;
+    }
+
+    /**
+     * Call io_uring_enter to submit TO_SUBMIT entries and wait for MINIMUM
+     * completions. Returns false and sets __errmsg and __errno on error.
+     */
+    bool Enter(const unsigned int toSubmit, const unsigned int minimum, const unsigned int flags,
+        void* argument, const std::size_t argumentSize) {
+        const long result = syscall(__NR_io_uring_enter, _ringFd, toSubmit, minimum, flags, argument, argumentSize);
+        if (result < 0) {
+            if (errno == EINTR || errno == ETIME || errno == EBUSY || errno == EAGAIN)
+                return true;
+            __errno = 35000 + errno;
+            const String msg = String::format("io_uring_enter failed: _ringFd: {}.", _ringFd);
+            __errmsg = msg;
+            elog << msg;
+            return false;
+        }
+        _toSubmit -= static_cast<unsigned int>(result);
+        return true;
+    }
+
+    /**
+     * Returns a cleared submission queue entry with OPERATION on FD, for
+     * the next 'Enter' to submit, submitting the queue first if it is full.
+     * If the kernel takes none of it (it is busy), the entry is held back in
+     * order in '_overflow' until 'FlushOverflow' finds room, so nothing is
+     * ever written over an entry that was not submitted.
+     */
+    io_uring_sqe* Prepare(const uint8_t opcode, const int fd, const uint64_t tag) {
+        if (_overflow.empty() && SubmissionSpace() == 0)
+            Enter(_toSubmit, 0, 0, nullptr, 0);
+
+        io_uring_sqe* sqe;
+        if (_overflow.empty() && SubmissionSpace() > 0) {
+            sqe = ClaimEntry();
+        } else {
+            _overflow.emplace_back();
+            sqe = &_overflow.back();
+        }
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->user_data = tag;
+        return sqe;
+    }
+
+    /**
+     * Returns the number of free entries in the submission queue.
+     */
+    unsigned int SubmissionSpace() const noexcept {
+        return _sqEntries - (*_sqTail - LoadAcquire(_sqHead));
+    }
+
+    /**
+     * Returns the next free submission queue entry, added to the queue for
+     * the next 'Enter' to submit. The queue must not be full.
+     */
+    io_uring_sqe* ClaimEntry() noexcept {
+        const unsigned int tail = *_sqTail;
+        const unsigned int index = tail & _sqMask;
+        _sqArray[index] = index;
+        StoreRelease(_sqTail, tail + 1);
+        _toSubmit++;
+        return &_sqes[index];
+    }
+
+    /**
+     * Move the entries held back by 'Prepare' into the submission queue, in
+     * order, for as many as there is room for.
+     */
+    void FlushOverflow() {
+        while (!_overflow.empty() && SubmissionSpace() > 0) {
+            *ClaimEntry() = _overflow.front();
+            _overflow.pop_front();
+        }
+    }
+
+    void SubmitAccept(const std::size_t listener) {
+        io_uring_sqe* sqe = Prepare(IORING_OP_ACCEPT, _listeners[listener]->GetSocketFd(),
+            Tag(Operation::accept, static_cast<int>(listener)));
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    }
+
+    void SubmitRecv(IoConnection& connection) {
+        io_uring_sqe* sqe = Prepare(IORING_OP_RECV, connection._fd, Tag(Operation::recv, connection._fd));
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        connection._receiving = true;
+        connection._pendingOps++;
+    }
+
+    /**
+     * Cancel CONNECTION's multishot receive, while it is write-paused.
+     */
+    void CancelRecv(IoConnection& connection) {
+        io_uring_sqe* sqe = Prepare(IORING_OP_ASYNC_CANCEL, -1, Tag(Operation::cancel, connection._fd));
+        sqe->addr = Tag(Operation::recv, connection._fd);
+        connection._pendingOps++;
+    }
+
+    void SubmitSend(IoConnection& connection) {
+        io_uring_sqe* sqe = Prepare(IORING_OP_SEND, connection._fd, Tag(Operation::send, connection._fd));
+        sqe->addr = reinterpret_cast<uint64_t>(connection._sending.data() + connection._sent);
+        sqe->len = static_cast<uint32_t>(std::min<std::size_t>(connection._sending.size() - connection._sent,
+            UINT32_MAX));
+        sqe->msg_flags = MSG_NOSIGNAL;
+        connection._pendingOps++;
+    }
+
+    void SubmitWake() {
+        io_uring_sqe* sqe = Prepare(IORING_OP_READ, _wakeFd, Tag(Operation::wake, _wakeFd));
+        sqe->addr = reinterpret_cast<uint64_t>(&_wakeValue);
+        sqe->len = sizeof(_wakeValue);
+    }
+
+    /**
+     * Give receive buffer BUFFER_ID back to the kernel, for the next
+     * receive, by adding it to the buffer ring. Nothing is submitted.
+     */
+    void RecycleBuffer(const uint16_t bufferId) noexcept {
+        //  Field by field, as the ring's tail overlays the first entry's
+        //  reserved field
+        io_uring_buf& buffer = _bufRing[_bufTail & (RECV_BUFFER_COUNT - 1)];
+        buffer.addr = reinterpret_cast<uint64_t>(_recvBuffers[bufferId].data());
+        buffer.len = static_cast<uint32_t>(RECV_BUFFER_SIZE);
+        buffer.bid = bufferId;
+        _bufTail++;
+        __atomic_store_n(&reinterpret_cast<io_uring_buf_ring*>(_bufRing)->tail, _bufTail, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * Handle every completion waiting. Returns how many there were.
+     */
+    int Reap() {
+        int count = 0;
+        unsigned int head = *_cqHead;
+        while (head != LoadAcquire(_cqTail)) {
+            const io_uring_cqe cqe = _cqes[head & _cqMask];
+            head++;
+            StoreRelease(_cqHead, head);
+            count++;
+            Complete(cqe);
+        }
+        return count;
+    }
+
+    /**
+     * Handle the completion CQE.
+     */
+    void Complete(const io_uring_cqe& cqe) {
+        const Operation operation = static_cast<Operation>(cqe.user_data >> 56);
+        const int fd = static_cast<int>(cqe.user_data & 0xFFFFFFFF);
+        const bool more = (cqe.flags & IORING_CQE_F_MORE);
+
+        if (operation == Operation::wake) {
+            SubmitWake();
+            return;
+        }
+        if (operation == Operation::accept) {
+            CompleteAccept(static_cast<std::size_t>(fd), cqe.res, more);
+            return;
+        }
+        if (operation == Operation::close) {
+            //  Paused listeners are retried once a descriptor is free again
+            for (const std::size_t listener : _acceptPaused)
+                SubmitAccept(listener);
+            _acceptPaused.clear();
+            return;
+        }
+
+        if (static_cast<std::size_t>(fd) >= _connections.size() || !_connections[fd])
+            return;
+        IoConnection& connection = *_connections[fd];
+
+        switch (operation) {
+        case Operation::recv:
+            if (!more) {
+                connection._pendingOps--;
+                connection._receiving = false;
+            }
+            if (cqe.res > 0) {
+                const uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (!connection._closing && _onData)
+                    _onData(connection, _recvBuffers[bufferId].data(), static_cast<std::size_t>(cqe.res));
+                RecycleBuffer(bufferId);
+                if (!more && !connection._closing && !connection._writePaused)
+                    SubmitRecv(connection);
+            }
+            else if ((cqe.res == -ENOBUFS || cqe.res == -ECANCELED) && !connection._closing) {
+                //  Cancelled by a pause, which re-arms it when it resumes
+                if (!more && !connection._writePaused)
+                    SubmitRecv(connection);
+            }
+            else {
+                if (cqe.res < 0 && !connection._closing)
+                    connection.Failed("Error reading bytes", -cqe.res);
+                connection.Close();
+            }
+            break;
+        case Operation::send:
+            connection._pendingOps--;
+            if (cqe.res < 0) {
+                if (!connection._closing)
+                    connection.Failed("Error sending bytes", -cqe.res);
+                connection.Close();
+                break;
+            }
+            connection._sent += static_cast<std::size_t>(cqe.res);
+            if (connection._closing)
+                break;
+            if (connection._sent < connection._sending.size()) {
+                SubmitSend(connection);
+                break;
+            }
+            connection._sending.clear();
+            connection._sent = 0;
+            if (!connection._outbox.empty()) {
+                connection._sending.swap(connection._outbox);
+                SubmitSend(connection);
+            }
+            if (connection._writePaused && connection.PendingBytes() <= _lowWatermark) {
+                connection._writePaused = false;
+                if (_onDrain)
+                    _onDrain(connection);
+                if (!connection._closing && !connection._writePaused && !connection._receiving)
+                    SubmitRecv(connection);
+            }
+            break;
+        case Operation::shutdown:
+        case Operation::cancel:
+            connection._pendingOps--;
+            break;
+        default:
+            break;
+        }
+
+        FinishClose(connection);
+    }
+
+    void CompleteAccept(const std::size_t listener, const int result, const bool more) {
+        if (_destroying) {
+            if (result >= 0)
+                close(result);
+            return;
+        }
+        if (result < 0) {
+            __errno = 36000 - result;
+            const String msg = String::format("Failed to accept new connection: listening socket: {}.",
+                _listeners[listener]->GetSocketFd());
+            __errmsg = msg;
+            elog << msg;
+            //  Accepting again straight away would fail the same way
+            if (!more && result != -EBADF && result != -EINVAL)
+                _acceptPaused.push_back(listener);
+            return;
+        }
+
+        if (static_cast<std::size_t>(result) >= _connections.size())
+            _connections.resize(static_cast<std::size_t>(result) + 1);
+        _connections[result] = _connectionPool.acquire();
+        IoConnection& connection = *_connections[result];
+        connection.Reset(this, result, nullptr);
+        _connectionCount++;
+        SubmitRecv(connection);
+        if (_onAccept)
+            _onAccept(connection);
+        if (!more)
+            SubmitAccept(listener);
+        FinishClose(connection);
+    }
+
+    /**
+     * Queue LENGTH bytes at DATA on CONNECTION, sending straight away if
+     * nothing else is being sent. Returns false if the connection is
+     * write-paused or closing.
+     */
+    bool Send(IoConnection& connection, const void* data, const std::size_t length) {
+        if (_backend == Backend::epoll) {
+            TcpConnection& conn = *connection._connection;
+            const bool written = conn.Write(data, length);
+            if (!written && conn.ERR_NO() != 0) {
+                connection.__errmsg = conn.ERR_MSG();
+                connection.__errno = conn.ERR_NO();
+            }
+            return written;
+        }
+
+        connection._outbox.append(static_cast<const char*>(data), length);
+        if (connection._sending.empty()) {
+            connection._sending.swap(connection._outbox);
+            connection._sent = 0;
+            SubmitSend(connection);
+        }
+        if (!connection._writePaused && connection.PendingBytes() > _highWatermark) {
+            connection._writePaused = true;
+            if (connection._receiving)
+                CancelRecv(connection);
+        }
+        return !connection._writePaused;
+    }
+
+    /**
+     * Start closing CONNECTION, shutting its socket down so that every
+     * operation in flight on it completes.
+     */
+    void Close(IoConnection& connection) {
+        if (_backend == Backend::epoll) {
+            connection._connection->Close();
+            connection._closing = true;
+            return;
+        }
+        if (connection._closing)
+            return;
+        connection._closing = true;
+        io_uring_sqe* sqe = Prepare(IORING_OP_SHUTDOWN, connection._fd, Tag(Operation::shutdown, connection._fd));
+        sqe->len = SHUT_RDWR;
+        connection._pendingOps++;
+    }
+
+    /**
+     * Close CONNECTION's socket once it is closing and nothing is in flight
+     * on it, and put the object back in the pool. Nothing else completes on
+     * the socket, so its slot is free for the next connection straight away,
+     * even if accept hands out the same descriptor before the close reports.
+     */
+    void FinishClose(IoConnection& connection) {
+        if (!connection._closing || connection._pendingOps > 0)
+            return;
+        if (_onClose)
+            _onClose(connection);
+        const int fd = connection._fd;
+        Prepare(IORING_OP_CLOSE, fd, Tag(Operation::close, fd));
+        _connectionPool.release(std::move(_connections[fd]));
+        _connectionCount--;
+    }
+
+    Backend _backend = Backend::epoll;
+
+    /**
+     * The event loop, with the epoll backend.
+     */
+    std::unique_ptr<TcpEventLoop> _loop;
+
+    int _ringFd = -1;
+    void* _sqRing = nullptr;
+    void* _cqRing = nullptr;
+    std::size_t _sqRingSize = 0;
+    std::size_t _cqRingSize = 0;
+    io_uring_sqe* _sqes = nullptr;
+    std::size_t _sqesSize = 0;
+    unsigned int* _sqHead = nullptr;
+    unsigned int* _sqTail = nullptr;
+    unsigned int* _sqArray = nullptr;
+    unsigned int _sqMask = 0;
+    unsigned int _sqEntries = 0;
+    unsigned int* _cqHead = nullptr;
+    unsigned int* _cqTail = nullptr;
+    unsigned int _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    /**
+     * The entries prepared but not yet submitted.
+     */
+    unsigned int _toSubmit = 0;
+
+    /**
+     * The entries prepared while the submission queue was full, oldest
+     * first.
+     */
+    std::deque<io_uring_sqe> _overflow;
+
+    std::vector<IoBuffer> _recvBuffers;
+
+    /**
+     * The ring the receive buffers are given to the kernel through, and its
+     * tail as written here. Its entries are indexed directly rather than
+     * through 'io_uring_buf_ring::bufs', which the kernel header's flexible
+     * array declaration puts at the wrong offset when compiled as C++.
+     */
+    io_uring_buf* _bufRing = nullptr;
+    std::size_t _bufRingSize = 0;
+    uint16_t _bufTail = 0;
+
+    int _wakeFd = -1;
+    uint64_t _wakeValue = 0;
+    std::atomic<bool> _stopping{false};
+    bool _destroying = false;
+
+    std::vector<TcpServer*> _listeners;
+    std::vector<std::size_t> _acceptPaused;
+
+    /**
+     * The open connections with io_uring, indexed by socket file
+     * descriptor.
+     */
+    std::vector<std::unique_ptr<IoConnection>> _connections;
+    std::size_t _connectionCount = 0;
+    ObjectPool<IoConnection> _connectionPool{ []() { return new IoConnection(); } };
+
+    std::size_t _lowWatermark = TcpEventLoop::DEFAULT_LOW_WATERMARK;
+    std::size_t _highWatermark = TcpEventLoop::DEFAULT_HIGH_WATERMARK;
+
+    Handler _onAccept;
+    DataHandler _onData;
+    Handler _onDrain;
+    Handler _onClose;
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+bool IoConnection::Send(const void* data, const std::size_t length) {
+    if (IsClosing())
+        return false;
+    if (length == 0)
+        return !IsWritePaused();
+    return _service->Send(*this, data, length);
+}
+
+void IoConnection::Close() {
+    _service->Close(*this);
+}
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_IO_SERVICE_H__
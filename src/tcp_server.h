@@ -7,11 +7,40 @@
 #define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_SERVER_H__
 
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <linux/filter.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <vector>
 
 #include "log.h"
+#include "string.h"
+
+/**
+ * The std::runtime_error thrown when constructing a TCP object fails,
+ * carrying the code its 'ERR_NO' would have returned, as there is no object
+ * left to ask.
+ */
+class TcpError : public std::runtime_error {
+public:
+    TcpError(const std::string& message, const int code) : std::runtime_error(message), _code(code) {}
+
+    /**
+     * Get the error code of the failure.
+     */
+    int ERR_NO() const noexcept { return _code; }
+
+private:
+    int _code;
+};
 
 /**
  * The custom TCP Socket class is designed to simplify the process of using and
@@ -25,6 +54,11 @@
  * should be used to initialise a custom TCP Client class object or to send bytes
  * via your own commands.
  *
+ * Constructed with 'InternetProtocol::local', the server listens on a Unix
+ * domain stream socket at a path instead of a port, for peers on the same
+ * host. The connections it accepts are read and written the same way, but
+ * skip the TCP/IP stack.
+ *
  * __errno and __errmsg are local private variables that are set upon error, and
  * can be accessed using ERR_NO() and ERR_MSG() functions.
  *
@@ -48,20 +82,21 @@
 class TcpServer {
 public:
     /**
-     * The internet protocol version.
+     * The internet protocol version, or 'local' for a Unix domain socket.
      */
-    enum InternetProtocol : uint8_t { v4, v6 };
+    enum InternetProtocol : uint8_t { v4, v6, local };
 
     /**
      * @brief   Construct a new Tcp Server object with a socket file descriptor
      *          and some default parameters for a TCP type connection:
      *          'socket(AF_INET, SOCK_STREAM, 0)' and 'setsockopt(_serverFd,
      *          SOL_SOCKET, SO_REUSEADDR, &_opt, sizeof(_opt))'. Address Options:
-     *          AF_INET family, INADDR_ANY s_addr.
+     *          AF_INET family, INADDR_ANY s_addr. With 'local', the socket is
+     *          'socket(AF_UNIX, SOCK_STREAM, 0)' instead.
      *
-     * @throw runtime_error if the socket failed to initialise and we did not
+     * @throw TcpError    if the socket failed to initialise and we did not
      *                      receive a file descriptor or if the socket options
-     *                      failed to set.
+     *                      failed to set, with the 10xxx or 14xxx code.
      */
     TcpServer(InternetProtocol ipv = InternetProtocol::v4) {
         __errmsg = "";
@@ -73,33 +108,32 @@ public:
         llog << "Initialise new TCP server object...";
 
         _ipv = ipv;
-        _serverFd = socket((_ipv == InternetProtocol::v4 ? AF_INET : AF_INET6), SOCK_STREAM, 0);
+        _serverFd = socket(Family(_ipv), SOCK_STREAM, 0);
         if (_serverFd < 0) {
             __errno = 10000 + errno;
 
-            std::stringstream msg;
-            msg << "Server socket creation failed: _serverFd: "
-                << _serverFd << ". ERROR CODE: " << __errno << ".";
+            const String msg = String::format("Server socket creation failed: _serverFd: {}. ERROR CODE: {}.",
+                _serverFd, __errno);
 
-            flog << msg.str();
+            flog << msg;
             //  This prevents the object being initialised and throws seg fault
             //  if attempting to call the object.
-            throw std::runtime_error(msg.str());
+            throw TcpError(msg, __errno);
         }
+        _ownedFd = _serverFd;
 
         const int sockOptResult =
             setsockopt(_serverFd, SOL_SOCKET, SO_REUSEADDR, &_opt, sizeof(_opt));
         if (sockOptResult < 0) {
             __errno = 14000 + errno;
 
-            std::stringstream msg;
-            msg << "Socket options failed: sockOptResult: "
-                << sockOptResult << ". ERROR CODE: " << __errno << ".";
+            const String msg = String::format("Socket options failed: sockOptResult: {}. ERROR CODE: {}.",
+                sockOptResult, __errno);
 
-            flog << msg.str();
+            flog << msg;
             //  This prevents the object being initialised and throws seg fault
             //  if attempting to call the object.
-            throw std::runtime_error(msg.str());
+            throw TcpError(msg, __errno);
         }
 
         _address.sin_family = (_ipv == InternetProtocol::v4 ? AF_INET : AF_INET6);
@@ -109,11 +143,15 @@ public:
     }
 
     /**
-     * Destroy the Tcp Server object and perform necessary clean up.
+     * Destroy the Tcp Server object and perform necessary clean up,
+     * closing the socket, which also frees an abstract local name for the
+     * next server.
      */
     ~TcpServer() {
         dlog << "TCP Server destruction...";
         this->Shutdown();
+        if (_ownedFd >= 0)
+            close(_ownedFd);
     }
 
     /**
@@ -124,6 +162,12 @@ public:
         dlog << "Shutting down TCP Server...";
         shutdown(_serverFd, SHUT_RDWR);
         _serverFd = -1;
+
+        //  A socket file outlives its socket, and would stop the next bind
+        if (!_localPath.empty()) {
+            unlink(_localPath.c_str());
+            _localPath.clear();
+        }
     }
 
     /**
@@ -141,28 +185,36 @@ public:
 
         llog << "Start listening on " << portNumber << "...";
 
+        if (_ipv == InternetProtocol::local) {
+            const String msg = String::format("Listen failed on port {}: this is a local socket, "
+                "listen on a path instead.", portNumber);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 102;
+            return false;
+        }
+
         _address.sin_port = htons(portNumber);
 
         const int bindResult =
             bind(_serverFd, (struct sockaddr*) &_address, _addressLength);
         if (bindResult < 0) {
-            std::stringstream msg;
-            msg << "Binding failed: bindResult: " << bindResult << ".";
+            const String msg = String::format("Binding failed: bindResult: {}.", bindResult);
 
-            elog << msg.str();
-            __errmsg = msg.str();
+            elog << msg;
+            __errmsg = msg;
             __errno = 15000 + errno;
             return false;
         }
 
         const int listenResult = listen(_serverFd, _maxQueueLength);
         if (listenResult < 0) {
-            std::stringstream msg;
-            msg << "Listen failed on port " << portNumber << ": listenResult: "
-                << listenResult << ".";
+            const String msg = String::format("Listen failed on port {}: listenResult: {}.",
+                portNumber, listenResult);
 
-            elog << msg.str();
-            __errmsg = msg.str();
+            elog << msg;
+            __errmsg = msg;
             __errno = 16000 + errno;
             return false;
         }
@@ -170,6 +222,160 @@ public:
         return true;
     }
 
+    /**
+     * @brief   Start listening on a Unix domain socket at PATH, for a server
+     *          constructed with 'InternetProtocol::local'. A PATH starting
+     *          with '@' names a socket in the abstract namespace, which has
+     *          no file. Otherwise the socket file is created at PATH and
+     *          removed by 'Shutdown'; a socket file already there is removed
+     *          first if nothing is listening on it, as one left by a server
+     *          that stopped without 'Shutdown' would stop the bind. Sets
+     *          __errmsg and __errno on error.
+     *
+     * @param path      The socket path, at most 107 characters.
+     * @return true     if the socket successfully started listening on the
+     *                  path,
+     * @return false    otherwise.
+     */
+    bool StartListening(const char* path) {
+        __errmsg = "";
+        __errno = 0;
+
+        llog << "Start listening on " << path << "...";
+
+        if (_ipv != InternetProtocol::local) {
+            const String msg = String::format("Listen failed on {}: only a local socket listens on a path.",
+                path);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 102;
+            return false;
+        }
+
+        if (!SetLocalAddress(path)) {
+            const String msg = String::format("Binding failed: the path is too long: {}.", path);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 15000 + ENAMETOOLONG;
+            return false;
+        }
+
+        if (path[0] != '@')
+            RemoveStaleSocket(path);
+
+        const int bindResult =
+            bind(_serverFd, (struct sockaddr*) &_localAddress, _localAddressLength);
+        if (bindResult < 0) {
+            const String msg = String::format("Binding failed: bindResult: {}.", bindResult);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 15000 + errno;
+            return false;
+        }
+        if (path[0] != '@')
+            _localPath = path;
+
+        const int listenResult = listen(_serverFd, _maxQueueLength);
+        if (listenResult < 0) {
+            const String msg = String::format("Listen failed on {}: listenResult: {}.",
+                path, listenResult);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 16000 + errno;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief   Let other sockets listen on the same port, with SO_REUSEPORT.
+     *          The kernel then spreads new connections across every socket
+     *          listening on the port, each with its own accept queue, so
+     *          several threads can accept without sharing one. Must be
+     *          called on every socket in the group before 'StartListening'.
+     *          Sets __errmsg and __errno on error.
+     *
+     * @return true     if the socket option was set,
+     * @return false    otherwise.
+     */
+    bool SetReusePort() {
+        __errmsg = "";
+        __errno = 0;
+
+        const int sockOptResult =
+            setsockopt(_serverFd, SOL_SOCKET, SO_REUSEPORT, &_opt, sizeof(_opt));
+        if (sockOptResult < 0) {
+            const String msg = String::format("Setting SO_REUSEPORT failed: sockOptResult: {}.",
+                sockOptResult);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 14000 + errno;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief   Steer each new connection on this socket's port to the
+     *          listening socket at the index of the CPU that received it,
+     *          modulo GROUP_SIZE, by attaching a classic BPF program to the
+     *          SO_REUSEPORT group. Sockets are indexed in the order they
+     *          started listening, so if the thread accepting on socket N is
+     *          pinned to CPU N, each connection is handled on the core that
+     *          took its packets. Call once, on any socket of the group, after
+     *          'StartListening'. Sets __errmsg and __errno on error.
+     *
+     * @param groupSize     The number of sockets listening on the port.
+     * @return true         if the program was attached,
+     * @return false        otherwise.
+     */
+    bool AttachCpuSteering(const unsigned int groupSize) {
+        //  A = the receiving CPU; A %= groupSize; return A
+        sock_filter code[] = {
+            { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU) },
+            { BPF_ALU | BPF_MOD | BPF_K, 0, 0, (groupSize > 0 ? groupSize : 1) },
+            { BPF_RET | BPF_A, 0, 0, 0 },
+        };
+        return AttachSteeringProgram(code, sizeof(code) / sizeof(code[0]));
+    }
+
+    /**
+     * @brief   Steer each new connection on this socket's port to the
+     *          listening socket SOCKETS[cpu] of the CPU that received it,
+     *          with CPUs past the end of SOCKETS wrapping round, by attaching
+     *          a classic BPF program to the SO_REUSEPORT group. For when the
+     *          accepting threads are not pinned to CPU N for socket N, such
+     *          as when only some CPUs may be used. Call once, on any socket
+     *          of the group, after 'StartListening'. Sets __errmsg and
+     *          __errno on error.
+     *
+     * @param sockets   The index of the listening socket for each CPU, in
+     *                  the order the sockets started listening.
+     * @return true     if the program was attached,
+     * @return false    otherwise.
+     */
+    bool AttachCpuSteering(const std::vector<unsigned int>& sockets) {
+        //  A = the receiving CPU; A %= size; then one compare and return per
+        //  CPU, as classic BPF has no indexed loads from a table
+        std::vector<sock_filter> code;
+        code.reserve(2 * sockets.size() + 3);
+        code.push_back({ BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU) });
+        code.push_back({ BPF_ALU | BPF_MOD | BPF_K, 0, 0, (sockets.empty() ? 1u : static_cast<__u32>(sockets.size())) });
+        for (std::size_t cpu = 0; cpu < sockets.size(); cpu++) {
+            code.push_back({ BPF_JMP | BPF_JEQ | BPF_K, 0, 1, static_cast<__u32>(cpu) });
+            code.push_back({ BPF_RET | BPF_K, 0, 0, sockets[cpu] });
+        }
+        code.push_back({ BPF_RET | BPF_K, 0, 0, 0 });
+        return AttachSteeringProgram(code.data(), code.size());
+    }
+
     /**
      * Return the file descriptor value for the next
      * pending connection in the queue.
@@ -182,18 +388,19 @@ public:
 
         llog << "Accepting next connection in queue...";
 
+        //  A local peer's address would not fit '_address', and is not needed
 #pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
-        int newSocket = accept(_serverFd, (struct sockaddr*) &_address,
-                                (socklen_t*) &_addressLength);
+        int newSocket = (_ipv == InternetProtocol::local
+            ? accept(_serverFd, nullptr, nullptr)
+            : accept(_serverFd, (struct sockaddr*) &_address, (socklen_t*) &_addressLength));
 #pragma GCC diagnostic pop
 
         if (newSocket < 0) {
-            std::stringstream msg;
-            msg << "Failed to accept new connection: _serverFd: "
-                << _serverFd << ".";
+            const String msg = String::format("Failed to accept new connection: _serverFd: {}.",
+                _serverFd);
 
-            flog << msg.str();
-            __errmsg = msg.str();
+            flog << msg;
+            __errmsg = msg;
             __errno = 17000 + errno;
             return -1;
         }
@@ -202,11 +409,143 @@ public:
     }
 
     /**
-     * Set the maximum queue size for this TCP server listener. This
-     * value should be set before 'StartListening' is called. Must be
-     * less than 50, recommended it is at least 2.
+     * @brief   Accept up to MAX_CONNECTIONS waiting connections in one call,
+     *          appending their socket file descriptors to FDS. Each is
+     *          accepted with 'accept4' as non-blocking and close-on-exec,
+     *          ready for an event loop. If this socket is blocking (see
+     *          'SetNonBlocking'), waits like 'NextConnection' for the first
+     *          one, then only takes those already queued. Sets __errmsg and
+     *          __errno on error.
+     *
+     * @param fds               Where to append the new socket file descriptors.
+     * @param maxConnections    The most connections to accept.
+     * @return                  The number accepted, which is less than
+     *                          MAX_CONNECTIONS once the queue is empty, or -1
+     *                          if an error stopped the first accept.
+     */
+    int NextConnections(std::vector<int>& fds, const std::size_t maxConnections) {
+        return AcceptConnections(_serverFd, fds, maxConnections);
+    }
+
+    /**
+     * @brief   Accept connections until this server is shut down, running
+     *          HANDLER with each new socket file descriptor on POOL, such as
+     *          a 'ThreadPool', rather than starting a thread per connection.
+     *          Connections are accepted in batches of up to BATCH_SIZE, as
+     *          'NextConnections'. The handler owns the descriptor, which is
+     *          non-blocking. Running out of descriptors or memory is logged
+     *          and retried after a short wait, as closing connections frees
+     *          them. Sets __errmsg and __errno on error.
+     *
+     * @param pool          Anything with a 'Submit' taking a callable and
+     *                      returning false if it refused it.
+     * @param handler       Called on the pool with each new connection.
+     * @param batchSize     The most connections accepted per wakeup.
+     * @return              The number of connections dispatched, once
+     *                      the server is shut down or the pool refuses a
+     *                      connection.
+     */
+    template<typename Pool>
+    std::size_t DispatchConnections(Pool& pool, const std::function<void(int)>& handler,
+        const std::size_t batchSize = 64) {
+        const int serverFd = _serverFd;
+        llog << "Dispatching connections on " << serverFd << "...";
+
+        std::size_t dispatched = 0;
+        std::vector<int> fds;
+        int backoff = 10;
+        while (true) {
+            fds.clear();
+            const int count = AcceptConnections(serverFd, fds, batchSize);
+            if (count < 0) {
+                //  Shut down, or never a listening socket
+                const int error = __errno - 17000;
+                if (error == EBADF || error == EINVAL || error == ENOTSOCK || error == EOPNOTSUPP)
+                    break;
+
+                //  The waiting connection stays queued, so back off rather
+                //  than spin on it until descriptors or memory are freed
+                wlog << "Retrying accepting connections on " << serverFd << " in " << backoff << " ms...";
+                poll(nullptr, 0, backoff);
+                backoff = (backoff < 500 ? backoff * 2 : 1000);
+                continue;
+            }
+            backoff = 10;
+
+            //  A non-blocking socket returns with an empty queue
+            if (count == 0) {
+                pollfd ready = { serverFd, POLLIN, 0 };
+                poll(&ready, 1, -1);
+                continue;
+            }
+
+            for (std::size_t i = 0; i < fds.size(); i++) {
+                const int fd = fds[i];
+                if (pool.Submit([handler, fd]() { handler(fd); })) {
+                    dispatched++;
+                    continue;
+                }
+
+                //  Nothing will handle the rest of the batch either
+                for (std::size_t j = i; j < fds.size(); j++)
+                    close(fds[j]);
+                const String msg = String::format("Failed to dispatch new connections, the pool refused "
+                    "connection: {}, closed: {}.", fd, fds.size() - i);
+                elog << msg;
+                __errmsg = msg;
+                __errno = 103;
+                return dispatched;
+            }
+        }
+
+        return dispatched;
+    }
+
+    /**
+     * Make 'NextConnection' and 'NextConnections' return straight away when
+     * no connection is waiting, instead of blocking. 'TcpEventLoop::Listen'
+     * does this.
+     */
+    void SetNonBlocking() {
+        fcntl(_serverFd, F_SETFL, fcntl(_serverFd, F_GETFL, 0) | O_NONBLOCK);
+        _nonBlocking = true;
+    }
+
+    /**
+     * Set the maximum queue size for this TCP server listener, clamped to
+     * between 1 and 'MaximumQueueSizeLimit'. This value should be set
+     * before 'StartListening' is called. A deep queue lets a burst of
+     * connections wait to be accepted rather than have their SYNs dropped
+     * and retried by the client seconds later.
+     */
+    void SetMaximumQueueSize(int len) {
+        const int limit = MaximumQueueSizeLimit();
+        _maxQueueLength = (len > limit ? limit : (len < 1 ? 1 : len));
+    }
+
+    /**
+     * Get the largest queue size the kernel allows, from
+     * '/proc/sys/net/core/somaxconn', or SOMAXCONN if that cannot be read.
+     */
+    static int MaximumQueueSizeLimit() {
+        static const int limit = []() {
+            int value = 0;
+            std::ifstream file("/proc/sys/net/core/somaxconn");
+            return (file >> value && value > 0 ? value : SOMAXCONN);
+        }();
+        return limit;
+    }
+
+    /**
+     * Get the maximum queue size set for this TCP server listener.
+     */
+    int GetMaximumQueueSize() { return _maxQueueLength; }
+
+    /**
+     * Get the internet protocol version, or 'local', the server was
+     * constructed with.
      */
-    void SetMaximumQueueSize(int len) { _maxQueueLength = (len > 50 ? 50 : len); }
+    InternetProtocol GetProtocol() { return _ipv; }
 
     /**
      * Get this server socket's file descriptor value.
@@ -224,11 +563,136 @@ public:
     int ERR_NO() { return __errno; }
 
 protected:
+    /**
+     * Returns the socket address family for IPV.
+     */
+    static int Family(const InternetProtocol ipv) {
+        return (ipv == InternetProtocol::local ? AF_UNIX : (ipv == InternetProtocol::v4 ? AF_INET : AF_INET6));
+    }
+
+    /**
+     * Set '_localAddress' and '_localAddressLength' for the socket PATH,
+     * in the abstract namespace if it starts with '@'. Returns false if
+     * PATH is too long.
+     */
+    bool SetLocalAddress(const char* path) {
+        const std::size_t length = strlen(path);
+        if (length == 0 || length >= sizeof(_localAddress.sun_path))
+            return false;
+
+        memset(&_localAddress, 0, sizeof(_localAddress));
+        _localAddress.sun_family = AF_UNIX;
+        memcpy(_localAddress.sun_path, path, length);
+        //  An abstract name is every byte given after a leading null, so it
+        //  is not null terminated; a file path is
+        if (path[0] == '@') {
+            _localAddress.sun_path[0] = '\0';
+            _localAddressLength = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length);
+        } else {
+            _localAddressLength = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length + 1);
+        }
+        return true;
+    }
+
+    /**
+     * Remove the socket file at PATH if connecting to it is refused, which
+     * means its server has gone. Anything else at PATH is left for the
+     * bind to fail on.
+     */
+    void RemoveStaleSocket(const char* path) {
+        struct stat info;
+        if (stat(path, &info) < 0 || !S_ISSOCK(info.st_mode))
+            return;
+
+        const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0)
+            return;
+        if (connect(probe, (struct sockaddr*) &_localAddress, _localAddressLength) < 0 && errno == ECONNREFUSED) {
+            wlog << "Removing stale socket file " << path << ".";
+            unlink(path);
+        }
+        close(probe);
+    }
+
+    /**
+     * Attach the LENGTH instructions of CODE to this socket's SO_REUSEPORT
+     * group, to pick the listening socket for each new connection.
+     */
+    bool AttachSteeringProgram(sock_filter* code, const std::size_t length) {
+        __errmsg = "";
+        __errno = 0;
+
+        sock_fprog program = { static_cast<unsigned short>(length), code };
+        const int sockOptResult =
+            setsockopt(_serverFd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program));
+        if (sockOptResult < 0) {
+            const String msg = String::format("Attaching the CPU steering program failed: sockOptResult: {}.",
+                sockOptResult);
+
+            elog << msg;
+            __errmsg = msg;
+            __errno = 14000 + errno;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Accept up to MAX_CONNECTIONS from the listening socket SERVER_FD into
+     * FDS, as 'NextConnections'. Takes the descriptor as an argument so
+     * 'DispatchConnections' keeps using it while 'Shutdown' resets
+     * '_serverFd' from another thread.
+     */
+    int AcceptConnections(const int serverFd, std::vector<int>& fds, const std::size_t maxConnections) {
+        __errmsg = "";
+        __errno = 0;
+
+        std::size_t accepted = 0;
+        while (accepted < maxConnections) {
+            //  Only the first accept on a blocking socket may wait
+            if (accepted > 0 && !_nonBlocking) {
+                pollfd ready = { serverFd, POLLIN, 0 };
+                if (poll(&ready, 1, 0) <= 0)
+                    break;
+            }
+
+            const int newSocket = accept4(serverFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (newSocket < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    const String msg = String::format("Failed to accept new connections: _serverFd: {}, accepted: {}.",
+                        serverFd, accepted);
+
+                    elog << msg;
+                    __errmsg = msg;
+                    __errno = 17000 + errno;
+                    if (accepted == 0)
+                        return -1;
+                }
+                break;
+            }
+
+            fds.push_back(newSocket);
+            accepted++;
+        }
+
+        return static_cast<int>(accepted);
+    }
+
     /**
      * The file descriptor for this server-side socket.
      */
     int _serverFd = -1;
 
+    /**
+     * The socket this object created, closed when it is destroyed rather
+     * than by 'Shutdown', which resets '_serverFd' while another thread may
+     * still be accepting on the socket.
+     */
+    int _ownedFd = -1;
+
     /**
      * The set Internet Protocol version number (or IPv number).
      */
@@ -244,6 +708,19 @@ protected:
      */
     const int _addressLength = sizeof(_address);
 
+    /**
+     * This server socket's Unix domain address, and its byte length, for a
+     * local socket.
+     */
+    struct sockaddr_un _localAddress;
+    socklen_t _localAddressLength = 0;
+
+    /**
+     * The socket file created by 'StartListening', removed by 'Shutdown',
+     * or empty if there is none.
+     */
+    std::string _localPath;
+
     /**
      * For setting socket option value. Specified as a const integer so
      * it can be used as a reference parameter.
@@ -255,6 +732,11 @@ protected:
      */
     int _maxQueueLength = 10;
 
+    /**
+     * Whether 'SetNonBlocking' has been called.
+     */
+    bool _nonBlocking = false;
+
     /**
      * The last error message set.
      */
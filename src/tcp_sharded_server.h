@@ -0,0 +1,273 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_SHARDED_SERVER_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_SHARDED_SERVER_H__
+
+#include <pthread.h>
+#include <sched.h>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "string.h"
+#include "tcp_event_loop.h"
+#include "tcp_server.h"
+
+/**
+ * A TCP server sharded across worker threads. Each worker has its own
+ * TcpServer listening on the same port with SO_REUSEPORT, and its own
+ * TcpEventLoop, so the kernel spreads new connections across separate
+ * accept queues and no two threads ever share a socket, a queue or a lock:
+ *
+ *     TcpShardedServer server(4);
+ *     server.StartListening(8080, [](TcpEventLoop& loop, std::size_t worker) {
+ *         loop.OnReadable([](TcpConnection& conn) { ... });
+ *     });
+ *     ...
+ *     server.Stop();
+ *
+ * The setup function is called once per worker, on the calling thread and
+ * before any worker starts, to set that worker's handlers. The handlers then
+ * only ever run on that worker's thread.
+ *
+ * With 'SetCpuSteering', worker N is pinned to the Nth CPU the process may
+ * run on (modulo their number) and a BPF program sends each connection to
+ * the worker pinned to the CPU that received it, so a connection stays on
+ * one core from the network stack to its handlers. Connections received on
+ * a CPU with no worker are spread over the workers, and workers beyond the
+ * number of CPUs receive none, so steering works best with one worker per
+ * CPU.
+ *
+ * __errno and __errmsg are set on error, copied from the TcpServer or
+ * TcpEventLoop that failed, or:
+ * - 102 = 'StartListening' was called while already listening.
+ */
+class TcpShardedServer {
+public:
+
+    /**
+     * Sets up the handlers of worker WORKER's event loop.
+     */
+    using Setup = std::function<void(TcpEventLoop& loop, std::size_t worker)>;
+
+    /**
+     * @brief   Construct a sharded server with WORKERS worker threads.
+     *
+     * @param workers   The number of workers, and listening sockets. 0 uses
+     *                  one per CPU.
+     * @param ipv       The internet protocol version to listen with.
+     */
+    explicit TcpShardedServer(const std::size_t workers = 0,
+        const TcpServer::InternetProtocol ipv = TcpServer::InternetProtocol::v4) : _ipv(ipv) {
+        _workerCount = (workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    TcpShardedServer(const TcpShardedServer&) = delete;
+    TcpShardedServer& operator = (const TcpShardedServer&) = delete;
+
+    /**
+     * Destroy the server, stopping every worker.
+     */
+    ~TcpShardedServer() { Stop(); }
+
+    /**
+     * Pin each worker to a CPU and steer connections to the worker on the CPU
+     * that received them. Must be set before 'StartListening'. Best with no
+     * more workers than CPUs, as the extra workers are sent no connections.
+     */
+    void SetCpuSteering(const bool enabled) noexcept { _cpuSteering = enabled; }
+
+    /**
+     * Set the accept queue size of each worker's listening socket. Must be
+     * set before 'StartListening'.
+     */
+    void SetMaximumQueueSize(const int len) noexcept { _maxQueueLength = len; }
+
+    /**
+     * @brief   Open one listening socket and event loop per worker on
+     *          PORT_NUMBER, call SETUP for each and start the workers.
+     *          Sets __errmsg and __errno on error, in which case nothing is
+     *          left running.
+     *
+     * @param portNumber    The port number for every worker to listen on.
+     * @param setup         Sets the handlers of each worker's loop.
+     * @return true         if every worker started,
+     * @return false        otherwise.
+     */
+    bool StartListening(const int portNumber, const Setup& setup) {
+        __errmsg = "";
+        __errno = 0;
+
+        if (!_threads.empty()) {
+            const String msg = String::format("Sharded server is already listening on port {}.", portNumber);
+            elog << msg;
+            __errmsg = msg;
+            __errno = 102;
+            return false;
+        }
+
+        llog << "Start listening on " << portNumber << " with " << _workerCount << " workers...";
+
+        try {
+            for (std::size_t i = 0; i < _workerCount; i++) {
+                _servers.emplace_back(new TcpServer(_ipv));
+                TcpServer& server = *_servers.back();
+                server.SetMaximumQueueSize(_maxQueueLength);
+                if (!server.SetReusePort() || !server.StartListening(portNumber))
+                    return Failed(server.ERR_MSG(), server.ERR_NO());
+
+                _loops.emplace_back(new TcpEventLoop());
+                if (!_loops.back()->Listen(server))
+                    return Failed(_loops.back()->ERR_MSG(), _loops.back()->ERR_NO());
+                if (setup)
+                    setup(*_loops.back(), i);
+            }
+        }
+        catch (TcpError& err) {
+            return Failed(err.what(), err.ERR_NO());
+        }
+
+        //  Sockets are indexed in the order they started listening, which is
+        //  the worker order, so the table maps each CPU to the worker 'Work'
+        //  pins to it. CPUs with no worker wrap round the workers
+        if (_cpuSteering) {
+            _cpus = AllowedCpus();
+            std::vector<unsigned int> sockets(_cpus.back() + 1);
+            for (std::size_t cpu = 0; cpu < sockets.size(); cpu++)
+                sockets[cpu] = static_cast<unsigned int>(cpu % _workerCount);
+            for (std::size_t i = 0; i < _cpus.size(); i++)
+                sockets[_cpus[i]] = static_cast<unsigned int>(i % _workerCount);
+            if (!_servers.front()->AttachCpuSteering(sockets))
+                return Failed(_servers.front()->ERR_MSG(), _servers.front()->ERR_NO());
+        }
+
+        for (std::size_t i = 0; i < _workerCount; i++)
+            _threads.emplace_back(&TcpShardedServer::Work, this, i);
+
+        return true;
+    }
+
+    /**
+     * Stop every worker, waiting for each to finish the events it is
+     * handling, and close the listening sockets and connections.
+     */
+    void Stop() {
+        for (std::unique_ptr<TcpEventLoop>& loop : _loops)
+            loop->Stop();
+        for (std::thread& thread : _threads)
+            thread.join();
+        _threads.clear();
+        _loops.clear();
+        _servers.clear();
+    }
+
+    /**
+     * Returns the number of workers.
+     */
+    std::size_t WorkerCount() const noexcept { return _workerCount; }
+
+    /**
+     * Returns worker WORKER's event loop. Only safe to use from that worker's
+     * handlers, or to 'Stop'.
+     */
+    TcpEventLoop& GetLoop(const std::size_t worker) { return *_loops.at(worker); }
+
+    /**
+     * Returns worker WORKER's listening server.
+     */
+    TcpServer& GetServer(const std::size_t worker) { return *_servers.at(worker); }
+
+    /**
+     * Get the last error message set on this object.
+     */
+    std::string ERR_MSG() { return __errmsg; }
+
+    /**
+     * Get the last error code set on this object.
+     */
+    int ERR_NO() { return __errno; }
+
+private:
+
+    /**
+     * Record an error from starting a worker and undo the workers already
+     * set up. Returns false.
+     */
+    bool Failed(const std::string& message, const int code) {
+        elog << "Sharded server failed to start: " << message;
+        __errmsg = message;
+        __errno = code;
+        _loops.clear();
+        _servers.clear();
+        return false;
+    }
+
+    /**
+     * Returns the CPUs the calling thread may run on, in order, or every
+     * online CPU if they cannot be read.
+     */
+    static std::vector<unsigned int> AllowedCpus() {
+        std::vector<unsigned int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            for (unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    /**
+     * The body of worker WORKER's thread.
+     */
+    void Work(const std::size_t worker) {
+        if (_cpuSteering) {
+            const unsigned int cpu = _cpus[worker % _cpus.size()];
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                wlog << "Could not pin worker " << worker << " to CPU " << cpu << ".";
+        }
+
+        if (!_loops[worker]->Run())
+            elog << "Worker " << worker << " stopped: " << _loops[worker]->ERR_MSG();
+    }
+
+    TcpServer::InternetProtocol _ipv;
+    std::size_t _workerCount = 1;
+    int _maxQueueLength = 10;
+    bool _cpuSteering = false;
+
+    /**
+     * The CPUs the workers are pinned to in turn when steering.
+     */
+    std::vector<unsigned int> _cpus;
+
+    std::vector<std::unique_ptr<TcpServer>> _servers;
+    std::vector<std::unique_ptr<TcpEventLoop>> _loops;
+    std::vector<std::thread> _threads;
+
+    /**
+     * The last error message set.
+     */
+    std::string __errmsg;
+
+    /**
+     * The last error code set.
+     */
+    int __errno = 0;
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TCP_SHARDED_SERVER_H__
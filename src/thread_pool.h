@@ -0,0 +1,293 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_THREAD_POOL_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_THREAD_POOL_H__
+
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+
+/**
+ * A work-stealing thread pool. Every worker has its own deque of tasks:
+ *
+ *     ThreadPool pool(8);
+ *     pool.Submit([]() { ... });
+ *     pool.WaitIdle();
+ *
+ * A task submitted from one of the pool's workers, such as a request
+ * handler splitting up its work, goes on the back of that worker's own
+ * deque, and a worker takes its own tasks from the back, so related work
+ * stays on one core while its data is still in cache. A task submitted from
+ * any other thread is spread over the workers in turn. A worker with nothing
+ * to do steals from the front of another worker's deque, starting from a
+ * random one so idle workers do not all queue up on the same victim, which
+ * keeps every core busy however unevenly the work arrives.
+ *
+ * Each deque has its own lock, only ever contended by a thief, and idle
+ * workers sleep until there is work rather than spin.
+ *
+ * Exceptions thrown by a task are caught and logged, so one failed task
+ * does not stop its worker.
+ */
+class ThreadPool {
+public:
+
+    /**
+     * A unit of work.
+     */
+    using Task = std::function<void()>;
+
+    /**
+     * @brief   Construct a pool and start its workers.
+     *
+     * @param workers       The number of worker threads. 0 uses one per CPU.
+     * @param pinToCpus     Pin worker N to CPU N (modulo the number of CPUs),
+     *                      so the scheduler never moves a worker away from
+     *                      its cache.
+     */
+    explicit ThreadPool(const std::size_t workers = 0, const bool pinToCpus = false) {
+        const unsigned int cpus = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t count = (workers > 0 ? workers : cpus);
+
+        llog << "Initialise new thread pool with " << count << " workers...";
+
+        for (std::size_t i = 0; i < count; i++)
+            _workers.emplace_back(new Worker());
+        for (std::size_t i = 0; i < count; i++) {
+            _workers[i]->_thread = std::thread(&ThreadPool::Work, this, i);
+            if (pinToCpus) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(i % cpus, &set);
+                if (pthread_setaffinity_np(_workers[i]->_thread.native_handle(), sizeof(set), &set) != 0)
+                    wlog << "Could not pin worker " << i << " to CPU " << i % cpus << ".";
+            }
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    /**
+     * Destroy the pool, after running every task already submitted.
+     */
+    ~ThreadPool() { Stop(); }
+
+    /**
+     * @brief   Queue TASK to run on one of the workers.
+     *
+     * @param task  The task to run.
+     * @return true     if the task was queued,
+     * @return false    if the pool has been stopped. Its own workers can
+     *                  still submit while it stops, so a task that splits
+     *                  up its work always finishes.
+     */
+    bool Submit(Task task) {
+        const Current& current = CurrentThread();
+        if (current._pool != this && _stopping.load())
+            return false;
+
+        const std::size_t index = (current._pool == this
+            ? current._index
+            : _nextWorker.fetch_add(1, std::memory_order_relaxed) % _workers.size());
+
+        //  Counted before the task is published, so a worker taking it
+        //  straight away never brings '_queued' below zero. It pairs with the
+        //  sleeper count being raised before '_queued' is checked in 'Work',
+        //  so either this sees a sleeper or it sees the task
+        _unfinished.fetch_add(1);
+        _queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(_workers[index]->_mutex);
+            _workers[index]->_tasks.push_back(std::move(task));
+        }
+
+        if (_sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _wake.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * Block until every task submitted so far, and every task those submit,
+     * has finished. Must not be called from a worker.
+     */
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _idle.wait(lock, [this]() { return _unfinished.load() == 0; });
+    }
+
+    /**
+     * Stop accepting tasks, run those already queued and join the workers.
+     * Must not be called from a worker.
+     */
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            if (_stopping.exchange(true))
+                return;
+            _wake.notify_all();
+        }
+        for (std::unique_ptr<Worker>& worker : _workers)
+            worker->_thread.join();
+    }
+
+    /**
+     * Returns the number of worker threads.
+     */
+    std::size_t WorkerCount() const noexcept { return _workers.size(); }
+
+    /**
+     * Returns the number of tasks taken from another worker's deque.
+     */
+    std::size_t StolenCount() const noexcept { return _stolen.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the index of the calling worker in its pool, or -1 if the
+     * caller is not a pool worker.
+     */
+    static int CurrentWorker() noexcept {
+        const Current& current = CurrentThread();
+        return (current._pool != nullptr ? static_cast<int>(current._index) : -1);
+    }
+
+private:
+
+    struct Worker {
+        std::mutex _mutex;
+        std::deque<Task> _tasks;
+        std::thread _thread;
+    };
+
+    /**
+     * The pool and worker index of a worker thread.
+     */
+    struct Current {
+        ThreadPool* _pool = nullptr;
+        std::size_t _index = 0;
+    };
+
+    /**
+     * The calling thread's pool and worker index, with no pool outside one.
+     */
+    static Current& CurrentThread() noexcept {
+        static thread_local Current current;
+        return current;
+    }
+
+    /**
+     * Take the newest task from worker INDEX's own deque.
+     */
+    bool Pop(const std::size_t index, Task& task) {
+        Worker& worker = *_workers[index];
+        std::lock_guard<std::mutex> lock(worker._mutex);
+        if (worker._tasks.empty())
+            return false;
+        task = std::move(worker._tasks.back());
+        worker._tasks.pop_back();
+        return true;
+    }
+
+    /**
+     * Take the oldest task from another worker's deque, trying each in turn
+     * from a random one.
+     */
+    bool Steal(const std::size_t index, std::minstd_rand& random, Task& task) {
+        const std::size_t count = _workers.size();
+        const std::size_t start = random() % count;
+        for (std::size_t i = 0; i < count; i++) {
+            const std::size_t victim = (start + i) % count;
+            if (victim == index)
+                continue;
+
+            Worker& worker = *_workers[victim];
+            std::lock_guard<std::mutex> lock(worker._mutex);
+            if (worker._tasks.empty())
+                continue;
+            task = std::move(worker._tasks.front());
+            worker._tasks.pop_front();
+            _stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * The body of worker INDEX's thread.
+     */
+    void Work(const std::size_t index) {
+        CurrentThread() = Current{ this, index };
+        std::minstd_rand random(static_cast<std::minstd_rand::result_type>(index + 1));
+
+        while (true) {
+            Task task;
+            if (Pop(index, task) || Steal(index, random, task)) {
+                _queued.fetch_sub(1);
+                Run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _sleeping.fetch_add(1);
+            _wake.wait(lock, [this]() { return _queued.load() > 0 || _stopping.load(); });
+            _sleeping.fetch_sub(1);
+            if (_queued.load() == 0 && _stopping.load())
+                return;
+        }
+    }
+
+    /**
+     * Run TASK, logging anything it throws, and wake 'WaitIdle' if it was
+     * the last one.
+     */
+    void Run(Task& task) {
+        try {
+            task();
+        }
+        catch (std::exception& err) {
+            elog << "Thread pool task threw an exception: " << err.what();
+        }
+        catch (...) {
+            elog << "Thread pool task threw an unknown exception.";
+        }
+
+        if (_unfinished.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _idle.notify_all();
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    /**
+     * Tasks sitting in a deque, and tasks submitted but not yet finished.
+     */
+    std::atomic<std::size_t> _queued{0};
+    std::atomic<std::size_t> _unfinished{0};
+
+    std::atomic<std::size_t> _sleeping{0};
+    std::atomic<std::size_t> _nextWorker{0};
+    std::atomic<std::size_t> _stolen{0};
+    std::atomic<bool> _stopping{false};
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+};
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_THREAD_POOL_H__
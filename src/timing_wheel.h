@@ -0,0 +1,371 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TIMING_WHEEL_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TIMING_WHEEL_H__
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+class TimingWheel;
+
+/**
+ * A timer for a TimingWheel. The timer is its own list node, so arming and
+ * cancelling it never allocates. Embed one wherever the state it times out
+ * lives, such as a connection, and set its callback once.
+ *
+ * A timer must not be moved or copied while armed, and cancels itself when
+ * destroyed.
+ */
+class WheelTimer {
+public:
+
+    /**
+     * Called when the timer expires.
+     */
+    using Callback = std::function<void()>;
+
+    WheelTimer() = default;
+
+    /**
+     * Construct a timer that calls CALLBACK when it expires.
+     */
+    explicit WheelTimer(Callback callback) : _callback(std::move(callback)) {}
+
+    WheelTimer(const WheelTimer&) = delete;
+    WheelTimer& operator = (const WheelTimer&) = delete;
+
+    /**
+     * Cancel the timer if it is armed.
+     */
+    inline ~WheelTimer();
+
+    /**
+     * Set the function called when the timer expires.
+     */
+    void SetCallback(Callback callback) { _callback = std::move(callback); }
+
+    /**
+     * Returns true while the timer is armed and has not expired.
+     */
+    bool IsArmed() const noexcept { return _wheel != nullptr; }
+
+private:
+
+    friend class TimingWheel;
+
+    /**
+     * Remove the timer from the slot list it is in.
+     */
+    void Unlink() noexcept {
+        _prev->_next = _next;
+        _next->_prev = _prev;
+        _prev = _next = this;
+    }
+
+    /**
+     * Add the timer to the end of the slot list headed by HEAD.
+     */
+    void Link(WheelTimer& head) noexcept {
+        _prev = head._prev;
+        _next = &head;
+        head._prev->_next = this;
+        head._prev = this;
+    }
+
+    WheelTimer* _prev = this;
+    WheelTimer* _next = this;
+    TimingWheel* _wheel = nullptr;
+    uint64_t _expiry = 0;
+    Callback _callback;
+};
+
+/**
+ * A hierarchical hashed timing wheel: 4 levels of 64 slots, each slot a
+ * list of timers. Level 0 holds the timers due in the next 64 ticks, one
+ * slot per tick; each level above holds 64 times the span of the one below
+ * in the same number of slots. A timer is armed by linking it into the slot
+ * for its expiry, and cancelled by unlinking it, both in constant time
+ * however many timers there are. Each time level 0 goes round, the next
+ * slot of level 1 is emptied down into it, and so on up, so every timer is
+ * moved at most 3 times before it fires:
+ *
+ *     TimingWheel wheel;
+ *     WheelTimer timer([]() { ... });
+ *     wheel.Arm(timer, std::chrono::seconds(30));
+ *     ...
+ *     wheel.Advance();
+ *
+ * With the default 10 millisecond tick the wheel spans about 46 hours;
+ * timers due later are held at the top level and moved back down as it
+ * turns. A timer's expiry is counted from the clock when it is armed, not
+ * from the tick the wheel was last turned to, and timers fire on the first
+ * 'Advance' at or after it, so up to a tick late, and never early.
+ *
+ * 'Advance' is driven by whoever owns the wheel, such as a TcpEventLoop
+ * once per turn, which waits no longer than 'NextTimeout' for events so
+ * timers are not left late. Not thread-safe: use each wheel from one
+ * thread.
+ */
+class TimingWheel {
+public:
+
+    /**
+     * The number of levels, and the number of slots in each.
+     */
+    static constexpr unsigned int LEVELS = 4;
+    static constexpr unsigned int SLOTS = 64;
+
+    /**
+     * The default length of one tick, in milliseconds.
+     */
+    static constexpr unsigned int DEFAULT_TICK_MILLISECONDS = 10;
+
+    /**
+     * @brief   Construct a wheel whose current tick is now.
+     *
+     * @param tickMilliseconds  The length of one tick, which is the
+     *                          resolution of every timer on the wheel.
+     */
+    explicit TimingWheel(const unsigned int tickMilliseconds = DEFAULT_TICK_MILLISECONDS) :
+        _tick(std::chrono::milliseconds(tickMilliseconds > 0 ? tickMilliseconds : 1)),
+        _start(std::chrono::steady_clock::now()) {}
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator = (const TimingWheel&) = delete;
+
+    /**
+     * Destroy the wheel, disarming every timer still on it without calling
+     * them.
+     */
+    ~TimingWheel() {
+        for (std::array<WheelTimer, SLOTS>& level : _slots) {
+            for (WheelTimer& head : level) {
+                while (head._next != &head) {
+                    WheelTimer* timer = head._next;
+                    timer->Unlink();
+                    timer->_wheel = nullptr;
+                }
+            }
+        }
+    }
+
+    /**
+     * Arm TIMER to expire after DELAY, rounded up to a whole tick. If it is
+     * already armed it is moved to the new expiry.
+     */
+    template<typename Rep, typename Period>
+    void Arm(WheelTimer& timer, const std::chrono::duration<Rep, Period> delay) {
+        using Duration = std::chrono::steady_clock::duration;
+        const Duration now = std::chrono::steady_clock::now() - _start;
+        const Duration due = now + std::max(std::chrono::ceil<Duration>(delay), Duration::zero());
+        ArmAt(timer, static_cast<uint64_t>(now / _tick), static_cast<uint64_t>((due + _tick - Duration(1)) / _tick));
+    }
+
+    /**
+     * Disarm TIMER without calling it. Does nothing if it is not armed.
+     */
+    void Cancel(WheelTimer& timer) noexcept {
+        if (timer._wheel != this)
+            return;
+        timer.Unlink();
+        timer._wheel = nullptr;
+        _count--;
+    }
+
+    /**
+     * @brief   Turn the wheel to the current time, calling every timer that
+     *          has expired. A callback may arm or cancel any timer, itself
+     *          included.
+     *
+     * @return  The number of timers called.
+     */
+    std::size_t Advance() {
+        const uint64_t target = Elapsed();
+        std::size_t fired = 0;
+
+        //  With nothing armed there is nothing to visit on the way
+        if (_count == 0) {
+            _current = target;
+            return 0;
+        }
+
+        while (_current < target && _count > 0) {
+            _current++;
+
+            //  Empty the slot of each level that starts at this tick down
+            //  into the levels below, highest first, so a timer can fall
+            //  several levels in one tick
+            for (unsigned int level = LEVELS - 1; level > 0; level--) {
+                if ((_current & (SpanOf(level) - 1)) == 0)
+                    Cascade(level, SlotOf(level, _current));
+            }
+
+            WheelTimer& head = _slots[0][_current & (SLOTS - 1)];
+            if (head._next == &head)
+                continue;
+
+            //  Taken off the wheel first, so callbacks arming timers for
+            //  this same tick do not run until the next one
+            WheelTimer expired;
+            expired._next = head._next;
+            expired._prev = head._prev;
+            expired._next->_prev = &expired;
+            expired._prev->_next = &expired;
+            head._next = head._prev = &head;
+            _occupied[0] &= ~(uint64_t(1) << (_current & (SLOTS - 1)));
+
+            while (expired._next != &expired) {
+                WheelTimer* timer = expired._next;
+                timer->Unlink();
+                timer->_wheel = nullptr;
+                _count--;
+                fired++;
+                if (timer->_callback)
+                    timer->_callback();
+            }
+        }
+        _current = target;
+        return fired;
+    }
+
+    /**
+     * Returns the milliseconds until the next tick that has timers to fire
+     * or move down, for use as an event wait timeout, or -1 if no timers are
+     * armed.
+     */
+    int NextTimeout() const {
+        if (_count == 0)
+            return -1;
+
+        //  The next occupied level 0 slot, if any before level 0 goes round,
+        //  and otherwise the end of this round, when level 1 is cascaded
+        uint64_t ticks = SLOTS - (_current & (SLOTS - 1));
+        const unsigned int shift = static_cast<unsigned int>((_current + 1) & (SLOTS - 1));
+        const uint64_t ahead = (_occupied[0] >> shift) | (shift > 0 ? _occupied[0] << (SLOTS - shift) : 0);
+        if (ahead != 0)
+            ticks = std::min<uint64_t>(ticks, static_cast<uint64_t>(__builtin_ctzll(ahead)) + 1);
+
+        const std::chrono::steady_clock::duration due = _tick * (_current + ticks);
+        const std::chrono::steady_clock::duration now = std::chrono::steady_clock::now() - _start;
+        if (due <= now)
+            return 0;
+        return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(due - now).count());
+    }
+
+    /**
+     * Returns the number of armed timers.
+     */
+    std::size_t TimerCount() const noexcept { return _count; }
+
+    /**
+     * Returns the tick the wheel was last turned to, counted from its
+     * construction. Cheaper than reading the clock, for recording when
+     * something last happened.
+     */
+    uint64_t CurrentTick() const noexcept { return _current; }
+
+    /**
+     * Returns the length of one tick.
+     */
+    std::chrono::milliseconds Tick() const noexcept {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(_tick);
+    }
+
+private:
+
+    /**
+     * Returns the number of ticks one slot of LEVEL spans.
+     */
+    static constexpr uint64_t SpanOf(const unsigned int level) noexcept {
+        return uint64_t(1) << (6 * level);
+    }
+
+    /**
+     * Returns the slot of LEVEL that holds TICK.
+     */
+    static constexpr unsigned int SlotOf(const unsigned int level, const uint64_t tick) noexcept {
+        return static_cast<unsigned int>((tick >> (6 * level)) & (SLOTS - 1));
+    }
+
+    /**
+     * Returns the whole ticks since the wheel was constructed.
+     */
+    uint64_t Elapsed() const {
+        return static_cast<uint64_t>((std::chrono::steady_clock::now() - _start) / _tick);
+    }
+
+    /**
+     * Arm TIMER to expire at tick EXPIRY, or the tick after the current one
+     * if that is later, ELAPSED being the tick the clock is on.
+     */
+    void ArmAt(WheelTimer& timer, const uint64_t elapsed, const uint64_t expiry) {
+        if (timer._wheel == this)
+            timer.Unlink();
+        else
+            _count++;
+        //  A wheel with nothing else armed is caught up to the clock first,
+        //  so 'Advance' does not visit the ticks it missed one by one
+        if (_count == 1)
+            _current = std::max(_current, elapsed);
+        timer._wheel = this;
+        timer._expiry = std::max(expiry, _current + 1);
+        Place(timer);
+    }
+
+    /**
+     * Link TIMER into the lowest level whose span reaches its expiry.
+     */
+    void Place(WheelTimer& timer) noexcept {
+        const uint64_t delta = timer._expiry - _current;
+        unsigned int level = 0;
+        while (level < LEVELS - 1 && delta >= SpanOf(level + 1))
+            level++;
+
+        //  Beyond the top level's span, held in its furthest slot and
+        //  placed again when that slot comes round
+        const uint64_t expiry = (delta >= SpanOf(LEVELS) ? _current + SpanOf(LEVELS) - 1 : timer._expiry);
+        const unsigned int slot = SlotOf(level, expiry);
+        timer.Link(_slots[level][slot]);
+        _occupied[level] |= uint64_t(1) << slot;
+    }
+
+    /**
+     * Move every timer in SLOT of LEVEL down to the level its expiry now
+     * falls in.
+     */
+    void Cascade(const unsigned int level, const unsigned int slot) noexcept {
+        WheelTimer& head = _slots[level][slot];
+        _occupied[level] &= ~(uint64_t(1) << slot);
+        while (head._next != &head) {
+            WheelTimer* timer = head._next;
+            timer->Unlink();
+            Place(*timer);
+        }
+    }
+
+    std::chrono::steady_clock::duration _tick;
+    std::chrono::steady_clock::time_point _start;
+    uint64_t _current = 0;
+    std::size_t _count = 0;
+
+    /**
+     * The slot list heads of each level, and a bit per slot set while its
+     * list may not be empty, to find the next timer due without visiting
+     * every slot.
+     */
+    std::array<std::array<WheelTimer, SLOTS>, LEVELS> _slots;
+    std::array<uint64_t, LEVELS> _occupied{};
+};
+
+WheelTimer::~WheelTimer() {
+    if (_wheel != nullptr)
+        _wheel->Cancel(*this);
+}
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_TIMING_WHEEL_H__
@@ -0,0 +1,342 @@
+//
+// Created by Dylan Andrew McAdam (DrengrCoder) on 18/10/26.
+//  v1.1.0
+//
+
+#ifndef __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_UTF8_H__
+#define __DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_UTF8_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * UTF-8 validation, counting and decoding over raw byte ranges, used by the
+ * String class and usable on any buffer (such as a received HTTP body)
+ * without copying it.
+ *
+ * Validation follows the well-formed byte sequences of the Unicode
+ * Standard, Table 3-7, so overlong encodings, UTF-16 surrogates and code
+ * points above U+10FFFF are rejected. Runs of ASCII are skipped 16 bytes at
+ * a time with SSE2 (8 at a time otherwise) and only multi-byte sequences go
+ * through the table-driven state machine, so mostly-ASCII input such as
+ * JSON validates at close to memory bandwidth.
+ */
+class Utf8 {
+private:
+
+    //  ####################### State machine ########################
+    //  ##############################################################
+
+    /**
+     * Byte classes. Bytes in a class always cause the same transition.
+     */
+    enum ByteClass : std::uint8_t {
+        ASCII,          //  00..7F
+        CONT_80_8F,     //  80..8F
+        CONT_90_9F,     //  90..9F
+        CONT_A0_BF,     //  A0..BF
+        INVALID,        //  C0..C1, F5..FF
+        LEAD_2,         //  C2..DF
+        LEAD_E0,        //  E0
+        LEAD_3,         //  E1..EC, EE..EF
+        LEAD_ED,        //  ED
+        LEAD_F0,        //  F0
+        LEAD_4,         //  F1..F3
+        LEAD_F4,        //  F4
+        CLASS_COUNT
+    };
+
+    /**
+     * States: between sequences, rejected, or the continuation bytes still
+     * expected, with the first continuation restricted after E0, ED, F0
+     * and F4.
+     */
+    enum State : std::uint8_t {
+        ACCEPT,
+        REJECT,
+        NEED_1,
+        NEED_2,
+        NEED_2_AFTER_E0,
+        NEED_2_AFTER_ED,
+        NEED_3_AFTER_F0,
+        NEED_3,
+        NEED_3_AFTER_F4,
+        STATE_COUNT
+    };
+
+    using ClassTable = std::array<std::uint8_t, 256>;
+    using TransitionTable = std::array<std::array<std::uint8_t, CLASS_COUNT>, STATE_COUNT>;
+
+    static constexpr ClassTable MakeClasses() {
+        ClassTable classes{};
+        for (int b = 0; b < 256; b++) {
+            if (b <= 0x7F) classes[b] = ASCII;
+            else if (b <= 0x8F) classes[b] = CONT_80_8F;
+            else if (b <= 0x9F) classes[b] = CONT_90_9F;
+            else if (b <= 0xBF) classes[b] = CONT_A0_BF;
+            else if (b <= 0xC1) classes[b] = INVALID;
+            else if (b <= 0xDF) classes[b] = LEAD_2;
+            else if (b == 0xE0) classes[b] = LEAD_E0;
+            else if (b == 0xED) classes[b] = LEAD_ED;
+            else if (b <= 0xEF) classes[b] = LEAD_3;
+            else if (b == 0xF0) classes[b] = LEAD_F0;
+            else if (b <= 0xF3) classes[b] = LEAD_4;
+            else if (b == 0xF4) classes[b] = LEAD_F4;
+            else classes[b] = INVALID;
+        }
+        return classes;
+    }
+
+    static constexpr TransitionTable MakeTransitions() {
+        TransitionTable next{};
+        for (auto& row : next)
+            for (auto& cell : row)
+                cell = REJECT;
+
+        next[ACCEPT][ASCII] = ACCEPT;
+        next[ACCEPT][LEAD_2] = NEED_1;
+        next[ACCEPT][LEAD_E0] = NEED_2_AFTER_E0;
+        next[ACCEPT][LEAD_3] = NEED_2;
+        next[ACCEPT][LEAD_ED] = NEED_2_AFTER_ED;
+        next[ACCEPT][LEAD_F0] = NEED_3_AFTER_F0;
+        next[ACCEPT][LEAD_4] = NEED_3;
+        next[ACCEPT][LEAD_F4] = NEED_3_AFTER_F4;
+
+        for (const std::uint8_t cont : { CONT_80_8F, CONT_90_9F, CONT_A0_BF }) {
+            next[NEED_1][cont] = ACCEPT;
+            next[NEED_2][cont] = NEED_1;
+            next[NEED_3][cont] = NEED_2;
+        }
+        next[NEED_2_AFTER_E0][CONT_A0_BF] = NEED_1;         //  No overlong 3 byte forms
+        next[NEED_2_AFTER_ED][CONT_80_8F] = NEED_1;         //  No UTF-16 surrogates
+        next[NEED_2_AFTER_ED][CONT_90_9F] = NEED_1;
+        next[NEED_3_AFTER_F0][CONT_90_9F] = NEED_2;         //  No overlong 4 byte forms
+        next[NEED_3_AFTER_F0][CONT_A0_BF] = NEED_2;
+        next[NEED_3_AFTER_F4][CONT_80_8F] = NEED_2;         //  Nothing above U+10FFFF
+        return next;
+    }
+
+    /**
+     * The class of every byte and the next state for every state and class,
+     * built at compile time. Defined after the class, as the functions that
+     * build them are not usable inside it.
+     */
+    static const ClassTable CLASSES;
+    static const TransitionTable TRANSITIONS;
+
+    /**
+     * Skip ASCII bytes from I, a block at a time, returning the index of the
+     * first non-ASCII byte or LENGTH.
+     */
+    static std::size_t SkipAscii(const char* data, std::size_t i, const std::size_t length) noexcept {
+#if defined(__SSE2__)
+        for (; i + 16 <= length; i += 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const int mask = _mm_movemask_epi8(block);
+            if (mask != 0)
+                return i + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+#endif
+        for (; i + 8 <= length; i += 8) {
+            std::uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            if ((word & 0x8080808080808080ULL) != 0)
+                break;
+        }
+        while (i < length && static_cast<unsigned char>(data[i]) < 0x80)
+            i++;
+        return i;
+    }
+
+public:
+
+    /**
+     * The code point produced for an ill-formed sequence.
+     */
+    static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    //  ######################### Validation #########################
+    //  ##############################################################
+
+    /**
+     * @brief   Find the first byte of the first ill-formed or truncated
+     *          sequence in LENGTH bytes at DATA.
+     *
+     * @param data      The bytes to check.
+     * @param length    The number of bytes to check.
+     * @return          The offset of the sequence that is not valid UTF-8,
+     *                  or LENGTH if every byte is valid.
+     */
+    static std::size_t find_invalid(const char* data, const std::size_t length) noexcept {
+        std::uint8_t state = ACCEPT;
+        std::size_t sequenceStart = 0;
+        std::size_t i = 0;
+        while (i < length) {
+            if (state == ACCEPT) {
+                i = SkipAscii(data, i, length);
+                if (i >= length)
+                    break;
+                sequenceStart = i;
+            }
+            state = TRANSITIONS[state][CLASSES[static_cast<unsigned char>(data[i])]];
+            if (state == REJECT)
+                return sequenceStart;
+            i++;
+        }
+        return state == ACCEPT ? length : sequenceStart;
+    }
+
+    /**
+     * Returns true if LENGTH bytes at DATA are entirely valid UTF-8.
+     */
+    static bool is_valid(const char* data, const std::size_t length) noexcept {
+        return find_invalid(data, length) == length;
+    }
+
+    //  ########################## Counting ##########################
+    //  ##############################################################
+
+    /**
+     * Returns the number of code points in LENGTH bytes of valid UTF-8 at
+     * DATA, counting every byte that is not a continuation byte, 16 bytes at
+     * a time with SSE2. For ill-formed input the count can differ from the
+     * number of code points the iterator yields.
+     */
+    static std::size_t count(const char* data, const std::size_t length) noexcept {
+        std::size_t count = 0;
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        //  Continuation bytes are 0x80..0xBF, which are below -64 as signed chars
+        const __m128i continuationLimit = _mm_set1_epi8(static_cast<char>(0xBF));
+        for (; i + 16 <= length; i += 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            count += static_cast<std::size_t>(__builtin_popcount(
+                _mm_movemask_epi8(_mm_cmpgt_epi8(block, continuationLimit))));
+        }
+#endif
+        for (; i < length; i++) {
+            if ((static_cast<unsigned char>(data[i]) & 0xC0) != 0x80)
+                count++;
+        }
+        return count;
+    }
+
+    //  ########################## Decoding ##########################
+    //  ##############################################################
+
+    /**
+     * @brief   Decode the code point starting at FIRST.
+     *
+     * An ill-formed or truncated sequence decodes as REPLACEMENT_CHARACTER
+     * and consumes its maximal valid prefix (at least one byte), as the
+     * Unicode Standard recommends, so decoding always makes progress.
+     *
+     * @param first         The first byte of the sequence. Must be before LAST.
+     * @param last          The end of the input.
+     * @param codePoint     Set to the decoded code point.
+     * @return              The first byte after the decoded sequence.
+     */
+    static const char* decode(const char* first, const char* last, char32_t& codePoint) noexcept {
+        std::uint8_t state = ACCEPT;
+        const char* p = first;
+        char32_t value = 0;
+        do {
+            const unsigned char b = static_cast<unsigned char>(*p);
+            const std::uint8_t byteClass = CLASSES[b];
+            if (state == ACCEPT)
+                value = b & (byteClass == ASCII ? 0x7F : byteClass == LEAD_2 ? 0x1F :
+                             byteClass <= LEAD_ED ? 0x0F : 0x07);
+            else
+                value = (value << 6) | (b & 0x3F);
+
+            state = TRANSITIONS[state][byteClass];
+            if (state == REJECT) {
+                codePoint = REPLACEMENT_CHARACTER;
+                return p == first ? first + 1 : p;
+            }
+            p++;
+        } while (state != ACCEPT && p < last);
+
+        codePoint = (state == ACCEPT ? value : REPLACEMENT_CHARACTER);
+        return p;
+    }
+
+    /**
+     * A forward iterator over the code points of a byte range. See 'decode'
+     * for how ill-formed input is handled.
+     */
+    class CodePointIterator {
+    private:
+        const char* _position;
+        const char* _next;
+        const char* _last;
+        char32_t _value;
+
+        void Decode() noexcept {
+            _next = (_position < _last ? decode(_position, _last, _value) : _last);
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char32_t*;
+        using reference = const char32_t&;
+
+        CodePointIterator() noexcept : _position(nullptr), _next(nullptr), _last(nullptr), _value(0) {}
+
+        CodePointIterator(const char* position, const char* last) noexcept :
+            _position(position), _next(position), _last(last), _value(0) {
+            Decode();
+        }
+
+        reference operator*() const noexcept { return _value; }
+
+        /**
+         * Returns the first byte of the current code point.
+         */
+        const char* position() const noexcept { return _position; }
+
+        CodePointIterator& operator++() noexcept {
+            _position = _next;
+            Decode();
+            return *this;
+        }
+
+        CodePointIterator operator++(int) noexcept {
+            CodePointIterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const CodePointIterator& other) const noexcept { return _position == other._position; }
+        bool operator!=(const CodePointIterator& other) const noexcept { return _position != other._position; }
+    };
+
+    /**
+     * A range of the code points in a byte range, for range based for loops.
+     */
+    class CodePoints {
+    private:
+        const char* _first;
+        const char* _last;
+
+    public:
+        CodePoints(const char* first, const char* last) noexcept : _first(first), _last(last) {}
+
+        CodePointIterator begin() const noexcept { return CodePointIterator(_first, _last); }
+        CodePointIterator end() const noexcept { return CodePointIterator(_last, _last); }
+    };
+};
+
+inline constexpr Utf8::ClassTable Utf8::CLASSES = Utf8::MakeClasses();
+inline constexpr Utf8::TransitionTable Utf8::TRANSITIONS = Utf8::MakeTransitions();
+
+#endif //__DAM_DRENGR_CODER_SINGLE_INCLUDE_CUSTOM_UTF8_H__
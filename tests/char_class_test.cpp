@@ -0,0 +1,60 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/char_class.h"
+
+#include <string>
+
+constexpr CharClass Digits([](const char c) { return c >= '0' && c <= '9'; });
+constexpr CharClass FieldValue([](const char c) {
+    return c == '\t' || (c >= 0x20 && c <= 0x7E) || static_cast<unsigned char>(c) >= 0x80;
+});
+constexpr CharClass Token([](const char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        c == '!' || c == '#' || c == '$' || c == '%' || c == '&' || c == '\'' || c == '*' ||
+        c == '+' || c == '-' || c == '.' || c == '^' || c == '_' || c == '`' || c == '|' || c == '~';
+});
+
+TEST_CASE("Char class construction tests", "[single-file]")
+{
+    //  #################### contains ####################
+
+    static_assert(Digits.contains('5'), "Built at compile time");
+    static_assert(!Digits.contains('a'), "Built at compile time");
+
+    REQUIRE(Digits.uses_ranges());
+    REQUIRE(FieldValue.uses_ranges());
+    REQUIRE_FALSE(Token.uses_ranges());
+    REQUIRE(FieldValue.contains('\xE9'));
+    REQUIRE_FALSE(FieldValue.contains('\r'));
+}
+
+TEST_CASE("Char class find first not of tests", "[single-file]")
+{
+    //  #################### find_first_not_of ####################
+
+    //  Every position of a bad byte, across and after the 16 byte blocks
+    for (const CharClass* _class : { &Digits, &FieldValue, &Token }) {
+        for (std::size_t _length = 0; _length < 70; _length++) {
+            const std::string _valid(_length, '7');
+            REQUIRE(_class->all_of(_valid.data(), _valid.size()));
+            for (std::size_t _bad = 0; _bad < _length; _bad++) {
+                std::string _input = _valid;
+                _input[_bad] = '\n';
+                REQUIRE(_class->find_first_not_of(_input.data(), _input.size()) == _bad);
+            }
+        }
+    }
+
+    //  The ranges agree with the table for every byte value
+    for (int b = 0; b < 256; b++) {
+        const std::string _input = std::string(20, 'x') + static_cast<char>(b) + std::string(20, 'x');
+        const bool _allowed = FieldValue.contains(static_cast<char>(b));
+        REQUIRE(FieldValue.all_of(_input.data(), _input.size()) == _allowed);
+    }
+
+    const std::string _header = "Mozilla/5.0 (X11; Linux x86_64) \xC3\xA9t\xC3\xA9";
+    REQUIRE(FieldValue.all_of(_header.data(), _header.size()));
+    REQUIRE(Token.find_first_not_of("content-length: 5", 17) == 14);
+    REQUIRE(Token.all_of("content-length", 14));
+}
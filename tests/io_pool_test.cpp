@@ -0,0 +1,103 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/io_pool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Buffer pool tests", "[single-file]")
+{
+    //  #################### lease ####################
+
+    BufferPool _pool;
+    REQUIRE(_pool.slab_count() == 0);
+
+    IoBuffer _small = _pool.lease(100);
+    REQUIRE(_small);
+    REQUIRE(_small.size() == BufferPool::SMALL_BUFFER_SIZE);
+    REQUIRE(_pool.lease(4096).size() == BufferPool::SMALL_BUFFER_SIZE);
+    REQUIRE(_pool.lease(4097).size() == BufferPool::MEDIUM_BUFFER_SIZE);
+    REQUIRE(_pool.lease(65536).size() == BufferPool::LARGE_BUFFER_SIZE);
+    REQUIRE_THROWS_AS(_pool.lease(65537), std::invalid_argument);
+    REQUIRE(_pool.slab_count() == 3);
+
+    //  Buffers are page aligned and writable end to end
+    REQUIRE(reinterpret_cast<std::uintptr_t>(_small.data()) % 4096 == 0);
+    memset(_small.data(), 'x', _small.size());
+
+    //  #################### release ####################
+
+    //  A released buffer is the next one leased
+    char* _data = _small.data();
+    const std::size_t _free = _pool.free_count(1);
+    _small.release();
+    REQUIRE(_small.empty());
+    REQUIRE(_small.size() == 0);
+    REQUIRE(_pool.free_count(1) == _free + 1);
+    REQUIRE(_pool.lease(1).data() == _data);
+
+    //  Moving a lease moves ownership, returning the buffer once
+    IoBuffer _first = _pool.lease(1);
+    IoBuffer _second(std::move(_first));
+    REQUIRE(_first.empty());
+    REQUIRE(_second.data() == _data);
+    _first = std::move(_second);
+    REQUIRE(_first.data() == _data);
+    REQUIRE(_pool.free_count(1) == _free);
+    _first = IoBuffer();
+    REQUIRE(_pool.free_count(1) == _free + 1);
+
+    //  #################### steady state ####################
+
+    //  Serving the same number of connections again allocates nothing
+    _pool.reserve(BufferPool::MEDIUM_BUFFER_SIZE, 64);
+    const std::size_t _slabs = _pool.slab_count();
+    for (int round = 0; round < 10; round++) {
+        std::vector<IoBuffer> _leases;
+        for (int i = 0; i < 64; i++)
+            _leases.push_back(_pool.lease(BufferPool::MEDIUM_BUFFER_SIZE));
+    }
+    REQUIRE(_pool.slab_count() == _slabs);
+
+    //  #################### threads ####################
+
+    std::vector<std::thread> _threads;
+    for (int t = 0; t < 4; t++) {
+        _threads.emplace_back([&_pool]() {
+            for (int i = 0; i < 1000; i++) {
+                IoBuffer _buff = _pool.lease(BufferPool::LARGE_BUFFER_SIZE);
+                _buff.data()[0] = 'x';
+            }
+        });
+    }
+    for (std::thread& thread : _threads)
+        thread.join();
+    REQUIRE(_pool.free_count(BufferPool::LARGE_BUFFER_SIZE) % (BufferPool::SLAB_SIZE / BufferPool::LARGE_BUFFER_SIZE) == 0);
+}
+
+TEST_CASE("Object pool tests", "[single-file]")
+{
+    int _made = 0;
+    ObjectPool<std::vector<int>> _pool([&_made]() { _made++; return new std::vector<int>(); }, 2);
+
+    std::unique_ptr<std::vector<int>> _first = _pool.acquire();
+    std::unique_ptr<std::vector<int>> _second = _pool.acquire();
+    std::unique_ptr<std::vector<int>> _third = _pool.acquire();
+    REQUIRE(_made == 3);
+    REQUIRE(_pool.created_count() == 3);
+
+    std::vector<int>* _reused = _first.get();
+    _pool.release(std::move(_first));
+    _pool.release(std::move(_second));
+    //  Beyond the limit, released objects are deleted
+    _pool.release(std::move(_third));
+    REQUIRE(_pool.free_count() == 2);
+
+    REQUIRE(_pool.acquire().get() != _reused);
+    REQUIRE(_pool.acquire().get() == _reused);
+    REQUIRE(_pool.free_count() == 0);
+    REQUIRE(_made == 3);
+}
@@ -0,0 +1,102 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/mapped_string.h"
+
+#include <fstream>
+
+LogSettings LOG_SETTINGS;
+
+const std::string TEST_FILE = "./mapped_string_test.csv";
+const std::string EMPTY_FILE = "./mapped_string_test_empty.csv";
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger and test files", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+
+    std::ofstream _csv(TEST_FILE, std::ios::trunc);
+    _csv << "  id,name,level\nerror,disk full,3\ninfo,started,1\nerror,timeout,2\n  ";
+    _csv.close();
+    std::ofstream _empty(EMPTY_FILE, std::ios::trunc);
+    _empty.close();
+}
+
+TEST_CASE("Mapped string open and close tests", "[single-file]")
+{
+    //  #################### Open ####################
+
+    MappedString _file(TEST_FILE);
+    REQUIRE(_file.ERR_NO() == 0);
+    REQUIRE(_file.IsOpen());
+    REQUIRE(_file.size() == 67);
+    REQUIRE(_file.view().substr(0, 4) == "  id");
+    REQUIRE(_file[2] == 'i');
+    REQUIRE(std::distance(_file.begin(), _file.end()) == 67);
+    REQUIRE(_file.Advise(MappedString::AccessPattern::random));
+
+    MappedString _moved = std::move(_file);
+    REQUIRE(_moved.size() == 67);
+    REQUIRE_FALSE(_file.IsOpen());
+    REQUIRE(_file.empty());
+
+    _moved.Close();
+    REQUIRE_FALSE(_moved.IsOpen());
+    REQUIRE(_moved.size() == 0);
+
+    MappedString _empty(EMPTY_FILE);
+    REQUIRE(_empty.IsOpen());
+    REQUIRE(_empty.empty());
+    REQUIRE(_empty.split('\n').size() == 1);
+    REQUIRE(_empty.count("x") == 0);
+
+    MappedString _missing;
+    REQUIRE_FALSE(_missing.Open("./does/not/exist.csv"));
+    REQUIRE(_missing.ERR_NO() == 20000 + ENOENT);
+    REQUIRE_FALSE(_missing.ERR_MSG().empty());
+    REQUIRE_FALSE(_missing.IsOpen());
+}
+
+TEST_CASE("Mapped string search, split and trim tests", "[single-file]")
+{
+    MappedString _file(TEST_FILE);
+
+    //  #################### contains and count ####################
+
+    REQUIRE(_file.contains("disk full"));
+    REQUIRE(_file.contains(','));
+    REQUIRE_FALSE(_file.contains("warning"));
+    REQUIRE(_file.count("error") == 2);
+    REQUIRE(_file.count('\n') == 4);
+    REQUIRE(_file.find("info") == 34);
+
+    //  #################### split ####################
+
+    std::vector<std::string_view> _lines = _file.split('\n');
+    REQUIRE(_lines.size() == 5);
+    REQUIRE(_lines[1] == "error,disk full,3");
+    REQUIRE(_lines[4] == "  ");
+
+    std::vector<std::string_view> _parts = _file.split(",disk full,");
+    REQUIRE(_parts.size() == 2);
+    REQUIRE(_file.split("").size() == 1);
+
+    //  #################### trim ####################
+
+    REQUIRE(_file.trim().substr(0, 2) == "id");
+    REQUIRE(_file.trim().back() == '2');
+    REQUIRE(_file.ltrim().size() == 65);
+    REQUIRE(_file.rtrim().size() == 64);
+
+    //  #################### substr and to_string ####################
+
+    REQUIRE(_file.substr(2, 2) == "id");
+    REQUIRE_THROWS_AS(_file.substr(68), std::out_of_range);
+    String _copy = _file.to_string(2, 13);
+    REQUIRE(strcmp(_copy.c_str(), "id,name,level") == 0);
+
+    std::remove(TEST_FILE.c_str());
+    std::remove(EMPTY_FILE.c_str());
+}
@@ -0,0 +1,92 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/parallel_string.h"
+#include "../src/cpp_utilities.h"
+#include "../src/string.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Split SOURCE on DELIM one delimiter at a time, as 'String::split' does.
+ */
+std::vector<std::string_view> SequentialSplit(const std::string_view source, const std::string_view delim) {
+    std::vector<std::string_view> output;
+    std::size_t start = 0;
+    std::size_t p = 0;
+    while ((p = source.find(delim, start)) != std::string_view::npos) {
+        output.push_back(source.substr(start, p - start));
+        start = p + delim.size();
+    }
+    output.push_back(source.substr(start));
+    return output;
+}
+
+TEST_CASE("Parallel string small input tests", "[single-file]")
+{
+    //  #################### Single chunk ####################
+
+    const std::string _text = "error,disk full\ninfo,started\nerror,timeout\n";
+    REQUIRE(ParallelString::count(_text, "error", 8) == 2);
+    REQUIRE(ParallelString::count(_text, '\n', 8) == 3);
+    REQUIRE(ParallelString::count(_text, "", 8) == 0);
+    REQUIRE(ParallelString::contains(_text, "timeout", 8));
+    REQUIRE_FALSE(ParallelString::contains(_text, "warning", 8));
+    REQUIRE(ParallelString::find(_text, "info", 8) == 16);
+
+    std::vector<std::string_view> _lines = ParallelString::split(_text, '\n', 8);
+    REQUIRE(_lines.size() == 4);
+    REQUIRE(_lines[1] == "info,started");
+    REQUIRE(_lines[3].empty());
+    REQUIRE(ParallelString::split(_text, "", 8).size() == 1);
+    REQUIRE(ParallelString::split("", ',', 8).size() == 1);
+
+    std::vector<String> _expected = String(_text).split('\n');
+    REQUIRE(_expected.size() == _lines.size());
+    for (std::size_t i = 0; i < _lines.size(); i++)
+        REQUIRE(_expected[i] == _lines[i]);
+}
+
+TEST_CASE("Parallel string chunk boundary tests", "[single-file]")
+{
+    //  #################### Random input ####################
+
+    //  A two letter alphabet gives matches, including self-overlapping ones,
+    //  straddling every chunk boundary
+    std::mt19937 _random(42);
+    std::string _text(3 * ParallelString::MIN_CHUNK_SIZE + 7, 'a');
+    for (char& c : _text) c = (_random() % 3 == 0) ? 'b' : 'a';
+
+    for (const std::string _target : {"aa", "aaa", "ab", "aba", "abab", "baab", "bbbbbbbbbbbbbbbbbbbbbbbb"}) {
+        const std::size_t _count = CountOccurrences(_text, _target);
+        const std::vector<std::string_view> _parts = SequentialSplit(_text, _target);
+        for (std::size_t _threads : {1, 2, 3}) {
+            REQUIRE(ParallelString::count(_text, _target, _threads) == _count);
+            REQUIRE(ParallelString::find(_text, _target, _threads) == _text.find(_target));
+            REQUIRE(ParallelString::split(_text, _target, _threads) == _parts);
+        }
+    }
+
+    //  #################### Repeated input ####################
+
+    //  Every chunk boundary splits a match of a self-overlapping target
+    const std::string _same(3 * ParallelString::MIN_CHUNK_SIZE + 3, 'a');
+    for (const std::string _target : {"aa", "aaa", "aaaaaaa"}) {
+        for (std::size_t _threads : {2, 3}) {
+            REQUIRE(ParallelString::count(_same, _target, _threads) == _same.size() / _target.size());
+            REQUIRE(ParallelString::split(_same, _target, _threads) == SequentialSplit(_same, _target));
+        }
+    }
+
+    //  #################### Late and missing matches ####################
+
+    std::string _quiet(4 * ParallelString::MIN_CHUNK_SIZE, '.');
+    REQUIRE_FALSE(ParallelString::contains(_quiet, "needle", 4));
+    _quiet.replace(_quiet.size() / 2 - 3, 6, "needle");
+    _quiet.replace(_quiet.size() - 6, 6, "needle");
+    REQUIRE(ParallelString::find(_quiet, "needle", 4) == _quiet.size() / 2 - 3);
+    REQUIRE(ParallelString::count(_quiet, "needle", 4) == 2);
+    REQUIRE(ParallelString::split(_quiet, "needle", 4).size() == 3);
+}
@@ -0,0 +1,96 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/stream_tokenizer.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Feed SOURCE to TOKENIZER CHUNK bytes at a time and collect every token,
+ * copied, as they become available.
+ */
+std::vector<std::string> Tokenise(StreamTokenizer& tokenizer, const std::string& source, const std::size_t chunk) {
+    std::vector<std::string> tokens;
+    std::string_view token;
+    for (std::size_t i = 0; i < source.size(); i += chunk) {
+        tokenizer.feed(source.data() + i, std::min(chunk, source.size() - i));
+        while (tokenizer.next(token))
+            tokens.emplace_back(token);
+    }
+    tokenizer.finish();
+    while (tokenizer.next(token))
+        tokens.emplace_back(token);
+    return tokens;
+}
+
+TEST_CASE("Stream tokenizer line tests", "[single-file]")
+{
+    //  #################### Whole input ####################
+
+    StreamTokenizer _lines("\r\n");
+    _lines.feed("HTTP/1.1 200 OK\r\nHost: a\r\n\r\nbody");
+    std::string_view _line;
+    REQUIRE(_lines.next(_line));
+    REQUIRE(_line == "HTTP/1.1 200 OK");
+    REQUIRE(_lines.next(_line));
+    REQUIRE(_line == "Host: a");
+    REQUIRE(_lines.next(_line));
+    REQUIRE(_line.empty());
+    REQUIRE_FALSE(_lines.next(_line));
+    REQUIRE(_lines.remainder() == "body");
+
+    _lines.finish();
+    REQUIRE(_lines.next(_line));
+    REQUIRE(_line == "body");
+    REQUIRE_FALSE(_lines.next(_line));
+    REQUIRE(_lines.remainder().empty());
+
+    _lines.reset();
+    REQUIRE(_lines.buffered() == 0);
+    _lines.feed("again\r\n");
+    REQUIRE(_lines.next(_line));
+    REQUIRE(_line == "again");
+
+    //  #################### Split delimiter ####################
+
+    StreamTokenizer _split("\r\n");
+    _split.feed("first\r");
+    REQUIRE_FALSE(_split.next(_line));
+    _split.feed("\nsecond");
+    REQUIRE(_split.next(_line));
+    REQUIRE(_line == "first");
+    REQUIRE_FALSE(_split.next(_line));
+    REQUIRE(_split.remainder() == "second");
+
+    REQUIRE_THROWS_AS(StreamTokenizer(""), std::invalid_argument);
+}
+
+TEST_CASE("Stream tokenizer chunk size tests", "[single-file]")
+{
+    //  #################### Every chunk size ####################
+
+    const std::string _source = "alpha, bravo,, charlie, , delta,, ,echo, ";
+    //  The trailing delimiter leaves nothing for 'finish' to return
+    const std::vector<std::string> _expected = {"alpha", "bravo,", "charlie", "", "delta,", ",echo"};
+    for (std::size_t _chunk = 1; _chunk <= _source.size(); _chunk++) {
+        StreamTokenizer _fields(", ");
+        REQUIRE(Tokenise(_fields, _source, _chunk) == _expected);
+    }
+
+    //  Like std::getline, a trailing delimiter gives no empty last token
+    StreamTokenizer _words(" ");
+    REQUIRE(Tokenise(_words, "a  b ", 2) == std::vector<std::string>{"a", "", "b"});
+
+    //  #################### Long stream ####################
+
+    std::string _stream;
+    for (int i = 0; i < 20000; i++) _stream += "line " + std::to_string(i) + "\n";
+    StreamTokenizer _lines("\n");
+    const std::vector<std::string> _tokens = Tokenise(_lines, _stream, 997);
+    REQUIRE(_tokens.size() == 20000);
+    REQUIRE(_tokens.front() == "line 0");
+    REQUIRE(_tokens.back() == "line 19999");
+    //  Consumed bytes are dropped, so the buffer stays near one chunk
+    REQUIRE(_lines.buffered() < 2 * 997);
+}
@@ -0,0 +1,93 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/string_matcher.h"
+
+TEST_CASE("String matcher contains any tests", "[single-file]")
+{
+    //  #################### contains_any ####################
+
+    StringMatcher _matcher{ "authorization", "cookie", "x-api-key" };
+
+    REQUIRE(_matcher.contains_any(String("host: example\r\ncookie: abc")) == true);
+    REQUIRE(_matcher.contains_any(std::string("x-api-key: 1234")) == true);
+    REQUIRE(_matcher.contains_any(String("content-length: 10")) == false);
+    REQUIRE(_matcher.contains_any(String("")) == false);
+
+    StringMatcher _empty;
+    REQUIRE(_empty.contains_any(String("anything")) == false);
+    REQUIRE(_empty.find_all(String("anything")).empty());
+}
+
+TEST_CASE("String matcher find all tests", "[single-file]")
+{
+    //  #################### find_all ####################
+
+    StringMatcher _matcher{ "he", "she", "his", "hers" };
+    std::vector<StringMatcher::Match> _matches = _matcher.find_all(String("ushers"));
+
+    //  'she' starts before 'he' and 'hers', so it wins and the rest overlap it
+    REQUIRE(_matches.size() == 1);
+    REQUIRE(_matches[0]._position == 1);
+    REQUIRE(_matches[0]._length == 3);
+    REQUIRE(_matches[0]._pattern == 1);
+
+    //  Longest match wins when several patterns start at the same position
+    StringMatcher _longest{ "ab", "abcd", "b", "cd" };
+    _matches = _longest.find_all(String("abcdab"));
+    REQUIRE(_matches.size() == 2);
+    REQUIRE(_matches[0]._position == 0);
+    REQUIRE(_matches[0]._length == 4);
+    REQUIRE(_matches[1]._position == 4);
+    REQUIRE(_matches[1]._pattern == 0);
+
+    //  A partial long pattern must not hide a later shorter match
+    StringMatcher _partial{ "a", "abcdx", "c" };
+    _matches = _partial.find_all(String("abcdy"));
+    REQUIRE(_matches.size() == 2);
+    REQUIRE(_matches[0]._position == 0);
+    REQUIRE(_matches[1]._position == 2);
+
+    _matches = _partial.find_all(String("zzabcdxzz"));
+    REQUIRE(_matches.size() == 1);
+    REQUIRE(_matches[0]._position == 2);
+    REQUIRE(_matches[0]._length == 5);
+}
+
+TEST_CASE("String matcher replace all tests", "[single-file]")
+{
+    //  #################### replace_all ####################
+
+    std::map<std::string, std::string> _placeholders = {
+        { "{host}", "example.com" },
+        { "{port}", "8080" },
+        { "{path}", "/index" }
+    };
+    StringMatcher _matcher(_placeholders);
+
+    String _result = _matcher.replace_all(String("http://{host}:{port}{path}?{unknown}"));
+    REQUIRE(strcmp(_result.c_str(), "http://example.com:8080/index?{unknown}") == 0);
+
+    //  The same compiled matcher can be reused with other replacements
+    _result = _matcher.replace_all(String("{host}{host}"),
+                                    std::map<std::string, std::string>{ { "{host}", "h" } });
+    REQUIRE(strcmp(_result.c_str(), "hh") == 0);
+
+    StringMatcher _scrubber{ "secret", "token" };
+    _result = _scrubber.replace_all(String("token=abc secret=def"),
+                                    std::vector<std::string>{ "***", "***" });
+    REQUIRE(strcmp(_result.c_str(), "***=abc ***=def") == 0);
+
+    _result = _scrubber.replace_all(String("nothing to scrub"),
+                                    std::vector<std::string>{ "***", "***" });
+    REQUIRE(strcmp(_result.c_str(), "nothing to scrub") == 0);
+
+    //  A pattern left alone does not hide a shorter one inside it
+    StringMatcher _nested{ "abc", "b" };
+    _result = _nested.replace_all(String("abc b"), std::map<std::string, std::string>{ { "b", "X" } });
+    REQUIRE(strcmp(_result.c_str(), "aXc X") == 0);
+    _result = _nested.replace_all(String("abc b"), std::vector<std::string>{ "Y" });
+    REQUIRE(strcmp(_result.c_str(), "Y b") == 0);
+    _result = _nested.replace_all(String("abc b"), std::map<std::string, std::string>{});
+    REQUIRE(strcmp(_result.c_str(), "abc b") == 0);
+}
@@ -0,0 +1,70 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/string_pool.h"
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("String pool intern tests", "[single-file]")
+{
+    //  #################### intern ####################
+
+    StringPool _pool;
+    InternedString _host = _pool.intern("host");
+    REQUIRE(_host);
+    REQUIRE(_host.size() == 4);
+    REQUIRE(strcmp(_host.c_str(), "host") == 0);
+    REQUIRE(_host.hash() == String::hash("host"));
+
+    //  The same chars from any source give the same handle
+    REQUIRE(_pool.intern(std::string("host")) == _host);
+    REQUIRE(_pool.intern(String("host")) == _host);
+    REQUIRE(_pool.intern(std::string_view("hostname", 4)) == _host);
+    REQUIRE(_pool.intern("host").c_str() == _host.c_str());
+    REQUIRE(_pool.intern("Host") != _host);
+    REQUIRE(_pool.size() == 2);
+
+    InternedString _empty = _pool.intern("");
+    REQUIRE(_empty);
+    REQUIRE(_empty.size() == 0);
+    REQUIRE(_pool.intern(std::string()) == _empty);
+
+    //  #################### find ####################
+
+    REQUIRE(_pool.find("host") == _host);
+    REQUIRE(_pool.find("accept").empty());
+    REQUIRE(_pool.size() == 3);
+
+    InternedString _blank;
+    REQUIRE(_blank.empty());
+    REQUIRE(_blank == InternedString());
+    REQUIRE(_blank != _host);
+    REQUIRE(strcmp(_blank.c_str(), "") == 0);
+}
+
+TEST_CASE("String pool concurrent intern tests", "[single-file]")
+{
+    //  #################### threads ####################
+
+    StringPool _pool;
+    std::vector<std::string> _names;
+    for (int i = 0; i < 200; i++) _names.push_back("x-header-" + std::to_string(i));
+
+    std::vector<std::vector<InternedString>> _results(8);
+    std::vector<std::thread> _threads;
+    for (std::size_t t = 0; t < _results.size(); t++) {
+        _threads.emplace_back([&_pool, &_names, &_results, t]() {
+            for (int round = 0; round < 20; round++)
+                for (const std::string& name : _names)
+                    _results[t].push_back(_pool.intern(name));
+        });
+    }
+    for (std::thread& thread : _threads) thread.join();
+
+    REQUIRE(_pool.size() == _names.size());
+    for (std::size_t t = 1; t < _results.size(); t++)
+        REQUIRE(_results[t] == _results[0]);
+    for (std::size_t i = 0; i < _names.size(); i++)
+        REQUIRE(_results[0][i].view() == _names[i]);
+}
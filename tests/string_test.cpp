@@ -3,6 +3,13 @@
 #include "../src/catch2/catch.hpp"
 #include "../src/string.h"
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 TEST_CASE("String assignment tests", "[single-file]")
 {
     //  #################### Assignment ####################
@@ -263,6 +270,25 @@ TEST_CASE("String base C++ function tests", "[single-file]")
     _resultString = " substring";
     REQUIRE(strcmp(_customString.substr(14, _customString.length()).c_str(), 
                 _resultString.c_str()) == 0);
+
+    //  #################### mutable access to a blank String ####################
+
+    //  Blank Strings share one buffer, which is never handed out for writing
+    const String _blank;
+    String _written;
+    char* _chars = _written.data();
+    REQUIRE(_chars != _blank.c_str());
+    _chars[0] = 'x';
+    REQUIRE(_blank.c_str()[0] == '\0');
+    _chars[0] = '\0';
+    REQUIRE(_written.empty());
+    String _indexed;
+    REQUIRE(&_indexed[0] != _blank.c_str());
+    String _converted;
+    REQUIRE(static_cast<char*>(_converted) != _blank.c_str());
+    String _iterated;
+    REQUIRE(_iterated.begin() == _iterated.end());
+    REQUIRE(_iterated.c_str() != _blank.c_str());
 }
 
 TEST_CASE("String plus operator tests", "[single-file]")
@@ -310,6 +336,59 @@ TEST_CASE("String plus operator tests", "[single-file]")
     REQUIRE(strcmp(_seventhConcat.c_str(), _resultString.c_str()) == 0);
 }
 
+TEST_CASE("String concatenation expression and join tests", "[single-file]")
+{
+    //  #################### chained operators + ####################
+
+    String _host = "example.com";
+    std::string _path = "/index";
+    String _url = String("http://") + _host + ':' + "8080" + _path + String("?q=") + 'x';
+    REQUIRE(strcmp(_url.c_str(), "http://example.com:8080/index?q=x") == 0);
+    REQUIRE(_url.size() == 33);
+
+    //  The target may appear in the expression, with or without reallocating
+    String _wrapped = "body";
+    _wrapped = "<" + _wrapped + ">";
+    REQUIRE(strcmp(_wrapped.c_str(), "<body>") == 0);
+    _wrapped.reserve(64);
+    _wrapped = _wrapped + _wrapped;
+    REQUIRE(strcmp(_wrapped.c_str(), "<body><body>") == 0);
+
+    _wrapped += "-" + _wrapped + '-';
+    REQUIRE(strcmp(_wrapped.c_str(), "<body><body>-<body><body>-") == 0);
+
+    String _small = "ab";
+    _small += _small + _small + _small;
+    REQUIRE(strcmp(_small.c_str(), "abababab") == 0);
+    _small += "c";
+    _small += 'd';
+    REQUIRE(strcmp(_small.c_str(), "ababababcd") == 0);
+
+    String _blank;
+    _blank = _blank + "";
+    REQUIRE(_blank.empty());
+
+    std::string _asString = _host + ".org";
+    REQUIRE(_asString == "example.com.org");
+
+    std::stringstream _ss;
+    _ss << _host + '/' + _path;
+    REQUIRE(_ss.str() == "example.com//index");
+
+    //  #################### join ####################
+
+    std::vector<String> _parts = { "a", "bc", "", "d" };
+    String _joined = String::join(_parts, ", ");
+    REQUIRE(strcmp(_joined.c_str(), "a, bc, , d") == 0);
+    REQUIRE(_joined.size() == 10);
+
+    std::vector<std::string> _headers = { "host: example.com", "accept: */*" };
+    REQUIRE(strcmp(String::join(_headers, String("\r\n")).c_str(), "host: example.com\r\naccept: */*") == 0);
+    REQUIRE(strcmp(String::join(_parts, '/').c_str(), "a/bc//d") == 0);
+    REQUIRE(String::join(std::vector<String>(), ",").empty());
+    REQUIRE(strcmp(String::join(std::vector<const char*>{ "one" }, ",").c_str(), "one") == 0);
+}
+
 TEST_CASE("String plus-equals operator tests", "[single-file]")
 {
     //  #################### operators += ####################
@@ -383,6 +462,190 @@ TEST_CASE("String to lower and to upper test", "[single-file]")
     REQUIRE(strcmp(_string.c_str(), "ThIs is A string WitH UPPER AnD lower CaSe ChArS") == 0);
 }
 
+TEST_CASE("String hash and equality tests", "[single-file]")
+{
+    //  #################### hash ####################
+
+    //  Every length up to and past the 16 and 48 byte boundaries
+    std::string _text = "The quick brown fox jumps over the lazy dog, again and again and again.";
+    std::unordered_set<std::size_t> _seen;
+    for (std::size_t _len = 0; _len <= _text.size(); _len++) {
+        String _prefix(_text.c_str(), _len);
+        REQUIRE(_prefix.hash() == String::hash(std::string_view(_text.data(), _len)));
+        REQUIRE(_prefix.hash() != 0);
+        _seen.insert(_prefix.hash());
+    }
+    REQUIRE(_seen.size() == _text.size() + 1);
+
+    REQUIRE(String("abc").hash() != String("abd").hash());
+    REQUIRE(String("abc").hash() != String("ABC").hash());
+    REQUIRE(String("abc").ihash() == String("ABC").ihash());
+    REQUIRE(std::hash<String>()(String("key")) == String::hash("key"));
+
+    //  The cached hash follows every change to the contents
+    String _key = "Host";
+    const std::size_t _before = _key.hash();
+    _key.to_lower_inplace();
+    REQUIRE(_key.hash() != _before);
+    REQUIRE(_key.hash() == String::hash("host"));
+    _key += "name";
+    REQUIRE(_key.hash() == String::hash("hostname"));
+    _key[0] = 'H';
+    REQUIRE(_key.hash() == String::hash("Hostname"));
+    _key = "other";
+    REQUIRE(_key.hash() == String::hash("other"));
+    _key.replace_inplace('o', '0');
+    REQUIRE(_key.hash() == String::hash("0ther"));
+    String _moved = std::move(_key);
+    REQUIRE(_moved.hash() == String::hash("0ther"));
+    REQUIRE(_key.hash() == String::hash(""));
+
+    //  A String shared between threads can be hashed from each at once
+    const String _shared = "shared key";
+    std::size_t _hashes[2] = { 0, 0 };
+    std::thread _other([&]() { _hashes[1] = _shared.hash(); });
+    _hashes[0] = _shared.hash();
+    _other.join();
+    REQUIRE(_hashes[0] == String::hash("shared key"));
+    REQUIRE(_hashes[1] == _hashes[0]);
+
+    //  #################### operator == ####################
+
+    String _a = "value";
+    String _b = "value";
+    REQUIRE(_a == _b);
+    REQUIRE(_a == "value");
+    REQUIRE("value" == _a);
+    REQUIRE(_a == std::string("value"));
+    REQUIRE(std::string("value") == _a);
+    REQUIRE(_a == std::string_view("value"));
+    REQUIRE(_a != "values");
+    REQUIRE(_a != String("valuE"));
+    _a.hash();
+    _b.hash();
+    REQUIRE(_a == _b);
+
+    //  A write through a held pointer leaves the cached hash stale, but
+    //  equality still compares the chars
+    String _c = "valuX";
+    char* _held = _c;
+    _c.hash();
+    _held[4] = 'e';
+    REQUIRE(_a == _c);
+
+    std::unordered_map<String, int> _options;
+    _options[String("--port")] = 8080;
+    _options[String("--host")] = 1;
+    REQUIRE(_options.size() == 2);
+    REQUIRE(_options.count(String("--port")) == 1);
+    REQUIRE(_options[String("--port")] == 8080);
+    REQUIRE(_options.count(String("--PORT")) == 0);
+}
+
+TEST_CASE("String iterator tests", "[single-file]")
+{
+    //  #################### iterator traits ####################
+
+    static_assert(std::is_same_v<std::iterator_traits<String::iterator>::iterator_category,
+                                 std::random_access_iterator_tag>, "random access");
+    static_assert(std::is_same_v<std::iterator_traits<String::const_iterator>::value_type, char>, "value type");
+#if __cplusplus >= 202002L
+    static_assert(std::contiguous_iterator<String::iterator>, "contiguous");
+    static_assert(std::contiguous_iterator<String::const_iterator>, "contiguous");
+#endif
+
+    //  #################### standard algorithms ####################
+
+    String _request = "GET /index.html HTTP/1.1\r\nHost: example.com\r\n\r\nbody";
+    const String& _const = _request;
+    const std::string _headerEnd = "\r\n\r\n";
+
+    String::const_iterator _end = std::search(_const.begin(), _const.end(), _headerEnd.begin(), _headerEnd.end());
+    REQUIRE(_end != _const.end());
+    REQUIRE(std::distance(_const.begin(), _end) == 43);
+    REQUIRE(_end - _const.begin() == 43);
+    REQUIRE(_const.begin() + 43 == _end);
+    REQUIRE(_end[4] == 'b');
+    REQUIRE(_const.end() - _const.begin() == static_cast<std::ptrdiff_t>(_request.size()));
+
+    String::const_iterator _space = std::find(_const.begin(), _const.end(), ' ');
+    REQUIRE(*_space == ' ');
+    REQUIRE(_space < _end);
+    REQUIRE(std::lower_bound(_const.begin(), _const.begin(), 'a') == _const.begin());
+
+    //  A mutable iterator converts to a const one and compares with it
+    String::iterator _mutable = _request.begin();
+    String::const_iterator _converted = _mutable;
+    REQUIRE(_converted == _request.cbegin());
+    REQUIRE(_mutable == _request.cbegin());
+
+    String _letters = "dcba";
+    std::sort(_letters.begin(), _letters.end());
+    REQUIRE(strcmp(_letters.c_str(), "abcd") == 0);
+    REQUIRE(_letters.hash() == String::hash("abcd"));
+
+    //  #################### reverse iterators ####################
+
+    std::string _reversed(_letters.rbegin(), _letters.rend());
+    REQUIRE(_reversed == "dcba");
+    REQUIRE(*_const.crbegin() == 'y');
+    REQUIRE(std::string(_letters.data(), _letters.size()) == "abcd");
+
+    String _empty;
+    REQUIRE(_empty.begin() == _empty.end());
+    REQUIRE(_empty.rbegin() == _empty.rend());
+}
+
+TEST_CASE("String case-insensitive comparison and hash tests", "[single-file]")
+{
+    //  ################ block case folding ################
+
+    //  Every byte value, so each block width and the boundary chars are covered
+    std::string _allBytes;
+    for (int c = 1; c < 256; c++) _allBytes += static_cast<char>(c);
+    String _lower = String(_allBytes).to_lower();
+    String _upper = String(_allBytes).to_upper();
+    REQUIRE(_lower.size() == 255);
+    for (int c = 1; c < 256; c++) {
+        const char _original = static_cast<char>(c);
+        const char _expectedLower = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : _original;
+        const char _expectedUpper = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 32) : _original;
+        REQUIRE(_lower[c - 1] == _expectedLower);
+        REQUIRE(_upper[c - 1] == _expectedUpper);
+    }
+
+    //  #################### iequals ####################
+
+    String _header = "Content-Length";
+    REQUIRE(_header.iequals("content-length"));
+    REQUIRE(_header.iequals(std::string("CONTENT-LENGTH")));
+    REQUIRE(_header.iequals(String("cOnTeNt-LeNgTh")));
+    REQUIRE_FALSE(_header.iequals("content-lengths"));
+    REQUIRE_FALSE(_header.iequals("content_length"));
+    REQUIRE(String::iequals("Transfer-Encoding: Chunked; q=1", "transfer-encoding: CHUNKED; Q=1"));
+    REQUIRE_FALSE(String::iequals("@[`{", "`{@["));
+    REQUIRE(String::iequals("", ""));
+
+    //  #################### istarts_with ####################
+
+    REQUIRE(_header.istarts_with("CONTENT-"));
+    REQUIRE(_header.istarts_with(""));
+    REQUIRE_FALSE(_header.istarts_with("content-length-and-more"));
+    REQUIRE_FALSE(_header.istarts_with("type"));
+
+    //  #################### ihash ####################
+
+    REQUIRE(_header.ihash() == String("CONTENT-LENGTH").ihash());
+    REQUIRE(_header.ihash() == String::ihash("content-length"));
+    REQUIRE(_header.ihash() != String::ihash("content-type"));
+
+    std::unordered_map<String, int, String::IHash, String::IEqual> _fields;
+    _fields[String("Host")] = 1;
+    _fields[String("HOST")] = 2;
+    REQUIRE(_fields.size() == 1);
+    REQUIRE(_fields[String("host")] == 2);
+}
+
 TEST_CASE("String to int, double, float and long conversions", "[single-file]")
 {
     String _int_string = "1";
@@ -404,3 +667,260 @@ TEST_CASE("String to int, double, float and long conversions", "[single-file]")
     i = _int_string.to_int();
     REQUIRE(i == 1);
 }
+
+TEST_CASE("String exception-free numeric conversions", "[single-file]")
+{
+    //  #################### try_to_* ####################
+
+    REQUIRE(String("42").try_to_int().ok());
+    REQUIRE(String("42").try_to_int()._value == 42);
+    REQUIRE(String("-7").try_to_long()._value == -7);
+    REQUIRE(String("2.5").try_to_double()._value == 2.5);
+    REQUIRE(String("4.5").try_to_float()._value == 4.5f);
+
+    //  Unlike to_int, partial and invalid input is reported, not truncated
+    REQUIRE(String("1.234").try_to_int()._error == std::errc::invalid_argument);
+    REQUIRE(String("12abc").try_to_int()._error == std::errc::invalid_argument);
+    REQUIRE(String(" 12").try_to_int()._error == std::errc::invalid_argument);
+    REQUIRE(String("").try_to_int()._error == std::errc::invalid_argument);
+    REQUIRE(String("abc").try_to_double()._error == std::errc::invalid_argument);
+    REQUIRE(String("99999999999").try_to_int()._error == std::errc::result_out_of_range);
+    REQUIRE_FALSE(String("nope").try_to_long());
+
+    //  #################### to_number ####################
+
+    REQUIRE(String("65535").to_number<std::uint16_t>()._value == 65535);
+    REQUIRE(String("65536").to_number<std::uint16_t>()._error == std::errc::result_out_of_range);
+    REQUIRE(String("-1").to_number<unsigned int>()._error == std::errc::invalid_argument);
+    REQUIRE(String("101").to_number<int>(2)._value == 5);
+
+    REQUIRE(String("404").to_number_in_range<int>(100, 599)._value == 404);
+    REQUIRE(String("700").to_number_in_range<int>(100, 599)._error == std::errc::result_out_of_range);
+
+    REQUIRE(String("1a").to_hex()._value == 26);
+    REQUIRE(String("0xFF").to_hex<int>()._value == 255);
+    REQUIRE(String("0x").to_hex()._error == std::errc::invalid_argument);
+    REQUIRE(String("fg").to_hex()._error == std::errc::invalid_argument);
+
+    const char* _chunk = "1f;name=value";
+    REQUIRE(String::parse_number<std::size_t>(_chunk, _chunk + 2, 16)._value == 31);
+    REQUIRE_FALSE(String::parse_number<std::size_t>(_chunk, _chunk + 4, 16));
+
+    //  #################### from_number ####################
+
+    REQUIRE(strcmp(String::from_number(0).c_str(), "0") == 0);
+    REQUIRE(strcmp(String::from_number(-1234).c_str(), "-1234") == 0);
+    REQUIRE(strcmp(String::from_number(255, 16).c_str(), "ff") == 0);
+    REQUIRE(strcmp(String::from_number(2.5).c_str(), "2.5") == 0);
+    REQUIRE(String::from_number(0.1).try_to_double()._value == 0.1);
+    REQUIRE(String::from_number(9223372036854775807L).try_to_long()._value == 9223372036854775807L);
+}
+
+/**
+ * Returns true if FORMAT is a valid format string for ARGS, the check
+ * 'String::format' makes at compile time under C++20.
+ */
+template < typename... Args >
+constexpr bool FormatIsValid(const std::string_view format) {
+    constexpr StringFormat::Kind _kinds[] = { StringFormat::KindOf<Args>()..., StringFormat::Kind::text };
+    return StringFormat::Walk(format, _kinds, sizeof...(Args),
+        [](std::string_view) {}, [](std::size_t, const StringFormat::Spec&) {}) == nullptr;
+}
+
+TEST_CASE("String format tests", "[single-file]")
+{
+    //  #################### format ####################
+
+    const std::string _host = "example.com";
+    REQUIRE(String::format("{}:{}", _host, 8080) == "example.com:8080");
+    REQUIRE(String::format("no placeholders") == "no placeholders");
+    REQUIRE(String::format("") == "");
+    REQUIRE(String::format("{{{}}} {{}}", 1) == "{1} {}");
+    REQUIRE(String::format("{}{}{}{}", 'a', true, false, -12) == "atruefalse-12");
+    REQUIRE(String::format("{} {} {}", "text", std::string_view("view"), String("string")) == "text view string");
+    REQUIRE(String::format("{}", static_cast<const char*>(nullptr)) == "");
+    REQUIRE(String::format("0x{:x} 0x{:X}", 48879, 48879u) == "0xbeef 0xBEEF");
+    REQUIRE(String::format("{} {}", 0.1, 2.5f) == "0.1 2.5");
+    REQUIRE(String::format("{:.2} {:.0} {:.6}", 3.14159, 2.5, 1.0) == "3.14 2 1.000000");
+    REQUIRE(String::format("{:.6}", 1e300) == "1e+300");
+    REQUIRE(String::format("{}", std::numeric_limits<std::int64_t>::min()) == "-9223372036854775808");
+
+    //  #################### format_to ####################
+
+    String _line("GET");
+    String::format_to(_line, " {} HTTP/{}.{}", "/index.html", 1, 1);
+    REQUIRE(_line == "GET /index.html HTTP/1.1");
+    REQUIRE(_line.hash() == String::hash("GET /index.html HTTP/1.1"));
+
+    std::pmr::monotonic_buffer_resource _arena;
+    String _pooled(&_arena);
+    String::format_to(_pooled, "{}-{}", 1, 2);
+    REQUIRE(_pooled == "1-2");
+    REQUIRE(_pooled.resource() == &_arena);
+
+    //  #################### format string checks ####################
+
+    static_assert(FormatIsValid<int, std::string>("{}:{}"));
+    static_assert(FormatIsValid<>("{{}}"));
+    static_assert(!FormatIsValid<int>("{} {}"));
+    static_assert(!FormatIsValid<int, int>("{}"));
+    static_assert(!FormatIsValid<int>("{"));
+    static_assert(!FormatIsValid<int>("{}}"));
+    static_assert(!FormatIsValid<int>("{0}"));
+    static_assert(!FormatIsValid<double>("{:x}"));
+    static_assert(!FormatIsValid<int>("{:.2}"));
+    static_assert(!FormatIsValid<double>("{:.21}"));
+    static_assert(!FormatIsValid<double>("{:e}"));
+
+#if !defined(STRING_FORMAT_COMPILE_TIME_CHECKS)
+    REQUIRE_THROWS_AS(String::format("{} {}", 1), std::invalid_argument);
+#endif
+}
+
+TEST_CASE("String in-place and temporary reusing transformations", "[single-file]")
+{
+    //  ################ in-place variants ################
+
+    String _string = "  MiXeD Case qq  ";
+    _string.trim_inplace();
+    REQUIRE(strcmp(_string.c_str(), "MiXeD Case qq") == 0);
+
+    _string.to_lower_inplace();
+    REQUIRE(strcmp(_string.c_str(), "mixed case qq") == 0);
+
+    _string.to_upper_inplace();
+    REQUIRE(strcmp(_string.c_str(), "MIXED CASE QQ") == 0);
+
+    _string.replace_inplace('Q', 'w');
+    REQUIRE(strcmp(_string.c_str(), "MIXED CASE ww") == 0);
+
+    _string = "\t\n left only";
+    _string.ltrim_inplace();
+    REQUIRE(strcmp(_string.c_str(), "left only") == 0);
+
+    _string = "right only \r\n";
+    _string.rtrim_inplace();
+    REQUIRE(strcmp(_string.c_str(), "right only") == 0);
+
+    _string = "    ";
+    _string.trim_inplace();
+    REQUIRE(strcmp(_string.c_str(), "") == 0);
+
+    _string = "";
+    _string.trim_inplace();
+    REQUIRE(strcmp(_string.c_str(), "") == 0);
+
+    //  ################ temporary (rvalue) chains ################
+
+    String _header = " Content-Length ";
+    String _result = _header.trim().to_lower();
+    REQUIRE(strcmp(_result.c_str(), "content-length") == 0);
+    REQUIRE(strcmp(_header.c_str(), " Content-Length ") == 0);
+
+    _result = String("  a-b-c  ").rtrim().ltrim().replace('-', '+').to_upper();
+    REQUIRE(strcmp(_result.c_str(), "A+B+C") == 0);
+
+    //  The buffer of a temporary is reused rather than reallocated
+    String _temporary = "  REUSED  ";
+    const char* _buffer = _temporary.c_str();
+    _result = std::move(_temporary).trim().to_lower();
+    REQUIRE(_result.c_str() == _buffer);
+    REQUIRE(strcmp(_result.c_str(), "reused") == 0);
+}
+
+/**
+ * A memory resource that counts the bytes it hands out, passing the work on
+ * to the default resource.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    std::size_t _allocations = 0;
+    std::size_t _outstanding = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        _allocations++;
+        _outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        _outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_CASE("String memory resource tests", "[single-file]")
+{
+    //  ################ allocation source ################
+
+    CountingResource _counter;
+    {
+        String _string("Header-Name: some value", &_counter);
+        REQUIRE(_string.resource() == &_counter);
+        REQUIRE(_counter._allocations == 1);
+
+        //  Derived Strings come from the same resource
+        std::vector<String> _parts = _string.split(':');
+        REQUIRE(_parts.size() == 2);
+        REQUIRE(_parts[0].resource() == &_counter);
+        String _trimmed = _parts[1].trim();
+        REQUIRE(_trimmed.resource() == &_counter);
+        REQUIRE(strcmp(_trimmed.c_str(), "some value") == 0);
+
+        //  Copies go back to the default resource
+        String _copy = _trimmed;
+        REQUIRE(_copy.resource() == std::pmr::get_default_resource());
+    }
+    REQUIRE(_counter._outstanding == 0);
+
+    //  Repeated format_to calls grow the buffer geometrically, and may
+    //  format the output into itself
+    {
+        String _log(&_counter);
+        for (int i = 0; i < 1000; i++)
+            String::format_to(_log, "{},", i);
+        REQUIRE(_log.size() == 3890);
+        REQUIRE(_counter._allocations < 32);
+        String::format_to(_log, "|{}", _log);
+        REQUIRE(_log.size() == 3890 * 2 + 1);
+        REQUIRE(_log[3890] == '|');
+        REQUIRE(memcmp(_log.c_str(), _log.c_str() + 3891, 3890) == 0);
+    }
+    REQUIRE(_counter._outstanding == 0);
+
+    //  A monotonic arena releases everything in one go
+    {
+        std::pmr::monotonic_buffer_resource _arena;
+        String _line("HTTP/1.1 200 OK", &_arena);
+        std::vector<String> _words = _line.split(' ');
+        REQUIRE(_words.size() == 3);
+        REQUIRE(strcmp(_words[2].c_str(), "OK") == 0);
+        REQUIRE(_words[1].resource() == &_arena);
+    }
+
+    //  ################ blank, moved-from and self-append ################
+
+    String _blank;
+    REQUIRE(_blank.empty());
+    REQUIRE(strcmp(_blank.c_str(), "") == 0);
+
+    String _source = "moved";
+    String _target = std::move(_source);
+    REQUIRE(strcmp(_target.c_str(), "moved") == 0);
+    REQUIRE(strcmp(_source.c_str(), "") == 0);
+    REQUIRE(_source.length() == 0);
+
+    _target += _target;
+    REQUIRE(strcmp(_target.c_str(), "movedmoved") == 0);
+    REQUIRE(_target.size() == 10);
+
+    //  Split edge cases keep the trailing empty substring
+    String _csv = "a,b,";
+    REQUIRE(_csv.split(',').size() == 3);
+    REQUIRE(_csv.split("").size() == 1);
+}
@@ -0,0 +1,362 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/tcp_client.h"
+#include "../src/tcp_coroutine.h"
+
+#include <stdexcept>
+#include <thread>
+
+const int PORT = 51500;
+
+LogSettings LOG_SETTINGS;
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+    llog << "Logger initialised";
+}
+
+Task<int> Add(TcpScheduler& scheduler, const int a, const int b)
+{
+    co_await scheduler.SleepFor(std::chrono::milliseconds(20));
+    co_return a + b;
+}
+
+Task<> Throw(TcpScheduler& scheduler)
+{
+    co_await scheduler.SleepFor(std::chrono::milliseconds(1));
+    throw std::runtime_error("task failed");
+}
+
+Task<> Sum(TcpScheduler& scheduler, int& result, bool& caught)
+{
+    result = co_await Add(scheduler, 1, 2) + co_await Add(scheduler, 3, 4);
+    try {
+        co_await Throw(scheduler);
+    }
+    catch (std::runtime_error& err) {
+        caught = (std::string(err.what()) == "task failed");
+    }
+}
+
+TEST_CASE("Scheduler tasks", "[single-file]")
+{
+    TcpScheduler _scheduler;
+    REQUIRE(_scheduler.TaskCount() == 0);
+    REQUIRE(_scheduler.Run());
+
+    //  #### Awaited tasks return values and throw to the awaiter ####
+    int _result = 0;
+    bool _caught = false;
+    const auto _start = std::chrono::steady_clock::now();
+    _scheduler.Spawn(Sum(_scheduler, _result, _caught));
+    REQUIRE(_scheduler.TaskCount() == 1);
+    REQUIRE(_result == 0);
+    REQUIRE(_scheduler.Run());
+    REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(40));
+    REQUIRE(_scheduler.TaskCount() == 0);
+    REQUIRE(_result == 10);
+    REQUIRE(_caught);
+
+    //  #### Spawned tasks run side by side, and a throw is only logged ####
+    std::vector<int> _order;
+    auto _sleeper = [&](const int id, const int ms) -> Task<> {
+        co_await _scheduler.SleepFor(std::chrono::milliseconds(ms));
+        _order.push_back(id);
+    };
+    _scheduler.Spawn(_sleeper(1, 60));
+    _scheduler.Spawn(_sleeper(2, 20));
+    _scheduler.Spawn(_sleeper(3, 40));
+    _scheduler.Spawn(Throw(_scheduler));
+    REQUIRE(_scheduler.TaskCount() == 4);
+    REQUIRE(_scheduler.Run());
+    REQUIRE(_order == std::vector<int>({ 2, 3, 1 }));
+
+    //  #### A task that never suspends finishes inside Spawn ####
+    auto _immediate = [&]() -> Task<> {
+        _order.push_back(4);
+        co_return;
+    };
+    _scheduler.Spawn(_immediate());
+    REQUIRE(_scheduler.TaskCount() == 0);
+    REQUIRE(_order.back() == 4);
+
+    //  #### Stop from another thread ####
+    auto _forever = [&]() -> Task<> {
+        while (true)
+            co_await _scheduler.SleepFor(std::chrono::milliseconds(10));
+    };
+    _scheduler.Spawn(_forever());
+    std::thread _stopper([&]() {
+        usleep(50000);
+        _scheduler.Stop();
+    });
+    REQUIRE(_scheduler.Run());
+    _stopper.join();
+    REQUIRE(_scheduler.TaskCount() == 1);
+}
+
+/**
+ * Echo every byte read from CONN back to it.
+ */
+Task<> Echo(AsyncConnection conn)
+{
+    char buff[4096];
+    int n;
+    while ((n = co_await conn.Read(buff, sizeof(buff))) > 0) {
+        if (!co_await conn.Write(buff, static_cast<std::size_t>(n)))
+            break;
+    }
+}
+
+/**
+ * Accept connections from SERVER for ever, echoing each.
+ */
+Task<> Serve(TcpScheduler& scheduler, TcpServer& server)
+{
+    while (true)
+        scheduler.Spawn(Echo(co_await scheduler.Accept(server)));
+}
+
+/**
+ * Read exactly N_BYTES from CONN into OUT, returning false if it closed first.
+ */
+Task<bool> ReadExactly(AsyncConnection& conn, std::string& out, const std::size_t n_bytes)
+{
+    char buff[4096];
+    while (out.size() < n_bytes) {
+        const int n = co_await conn.Read(buff, std::min(sizeof(buff), n_bytes - out.size()));
+        if (n <= 0)
+            co_return false;
+        out.append(buff, static_cast<std::size_t>(n));
+    }
+    co_return true;
+}
+
+TEST_CASE("Scheduler echo server", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT));
+
+    TcpScheduler _scheduler;
+    _scheduler.Spawn(Serve(_scheduler, _server));
+
+    //  #### Many coroutine clients on the one thread ####
+    //  Assertions are made outside the tasks, as Catch cannot follow one
+    //  across a suspension
+    const int _count = 50;
+    int _done = 0;
+    int _matched = 0;
+    auto _client = [&](const int id) -> Task<> {
+        AsyncConnection _conn = co_await _scheduler.Connect(PORT);
+        for (int round = 0; round < 3 && _conn; round++) {
+            const std::string _msg = "client " + std::to_string(id) + " round " + std::to_string(round) + "\n";
+            std::string _echoed;
+            const bool _written = co_await _conn.Write(_msg);
+            const bool _read = co_await ReadExactly(_conn, _echoed, _msg.size());
+            _matched += (_written && _read && _echoed == _msg);
+        }
+        if (++_done == _count)
+            _scheduler.Stop();
+    };
+    for (int i = 0; i < _count; i++)
+        _scheduler.Spawn(_client(i));
+
+    REQUIRE(_scheduler.Run());
+    REQUIRE(_done == _count);
+    REQUIRE(_matched == _count * 3);
+
+    //  #### A blocking client talks to the same server ####
+    TcpClient _blocking;
+    REQUIRE(_blocking.Connect(PORT));
+    REQUIRE(_blocking.Send("hello") == 5);
+    for (int i = 0; i < 100 && _blocking.BytesAvailable() < 5; i++)
+        _scheduler.RunOnce(10);
+    char _buff[16];
+    REQUIRE(_blocking.Read(_buff, sizeof(_buff)) == 5);
+    REQUIRE(std::string(_buff, 5) == "hello");
+
+    //  #### A peer close ends its echo task, leaving only the server ####
+    _blocking.Close();
+    for (int i = 0; i < 100 && _scheduler.TaskCount() > 1; i++)
+        _scheduler.RunOnce(10);
+    REQUIRE(_scheduler.TaskCount() == 1);
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Scheduler connections", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT + 1));
+
+    //  #### Failed connects give an empty connection ####
+    {
+        TcpScheduler _scheduler;
+        bool _refused = false;
+        bool _invalid = false;
+        int _read = 0;
+        bool _written = true;
+        auto _connect = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler.Connect(PORT + 9);
+            _refused = !_conn && _scheduler.ERR_NO() == 12000 + ECONNREFUSED;
+            AsyncConnection _bad = co_await _scheduler.Connect(PORT, "not an address");
+            _invalid = !_bad && _scheduler.ERR_NO() / 1000 == 11;
+            _read = co_await _bad.Read(nullptr, 0);
+            _written = co_await _bad.Write("x", 1);
+        };
+        _scheduler.Spawn(_connect());
+        REQUIRE(_scheduler.Run());
+        REQUIRE(_refused);
+        REQUIRE(_invalid);
+        REQUIRE(_read == -1);
+        REQUIRE_FALSE(_written);
+        REQUIRE(_scheduler.Loop().ConnectionCount() == 0);
+    }
+
+    //  #### A writer waits for a slow reader to drain ####
+    {
+        TcpScheduler _scheduler;
+        _scheduler.Loop().SetWriteWatermarks(64 * 1024, 256 * 1024);
+
+        const std::size_t _total = 8 * 1024 * 1024;
+        std::size_t _sent = 0;
+        int _resumed = 0;
+        auto _writer = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler.Accept(_server);
+            std::vector<char> _chunk(64 * 1024);
+            while (_sent < _total) {
+                for (std::size_t i = 0; i < _chunk.size(); i++)
+                    _chunk[i] = static_cast<char>((_sent + i) % 251);
+                if (!co_await _conn.Write(_chunk.data(), _chunk.size()))
+                    break;
+                _sent += _chunk.size();
+                //  Only resumed this close to empty after waiting for a drain
+                _resumed += (_conn.Connection()->QueuedBytes() <= 64 * 1024 && _sent > 512 * 1024);
+            }
+            //  Closing drops what is still queued, so wait for the reader
+            char _done;
+            co_await _conn.Read(&_done, 1);
+        };
+        bool _intact = true;
+        std::size_t _read = 0;
+        auto _reader = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler.Connect(PORT + 1);
+            std::vector<char> _buff(4096);
+            while (_read < _total) {
+                const int n = co_await _conn.Read(_buff.data(), _buff.size());
+                if (n <= 0)
+                    break;
+                for (int i = 0; i < n; i++)
+                    _intact = _intact && _buff[i] == static_cast<char>((_read + i) % 251);
+                _read += static_cast<std::size_t>(n);
+                //  Read slowly to start with, so the writer fills its queue
+                if (_read < 1024 * 1024)
+                    co_await _scheduler.SleepFor(std::chrono::milliseconds(1));
+            }
+        };
+        _scheduler.Spawn(_writer());
+        _scheduler.Spawn(_reader());
+        REQUIRE(_scheduler.Run());
+        REQUIRE(_sent == _total);
+        REQUIRE(_read == _total);
+        REQUIRE(_intact);
+        REQUIRE(_resumed > 0);
+    }
+
+    //  #### Connections and suspended tasks go with the scheduler ####
+    {
+        std::unique_ptr<TcpScheduler> _scheduler(new TcpScheduler());
+        bool _accepted = false;
+        auto _hold = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler->Accept(_server);
+            _accepted = true;
+            char _buff[16];
+            co_await _conn.Read(_buff, sizeof(_buff));
+        };
+        _scheduler->Spawn(_hold());
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        for (int i = 0; i < 100 && !_accepted; i++)
+            _scheduler->RunOnce(10);
+        REQUIRE(_accepted);
+        REQUIRE(_scheduler->TaskCount() == 1);
+        _scheduler.reset();
+
+        char _buff[16];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+    }
+
+    //  #### An accept that is never awaited leaves the connection for the next ####
+    {
+        TcpScheduler _scheduler;
+        REQUIRE(_scheduler.Listen(_server));
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        for (int i = 0; i < 100 && _scheduler.Loop().ConnectionCount() == 0; i++)
+            _scheduler.RunOnce(10);
+        REQUIRE(_scheduler.Loop().ConnectionCount() == 1);
+        {
+            TcpScheduler::AcceptAwaiter _unused = _scheduler.Accept(_server);
+        }
+
+        bool _accepted = false;
+        auto _take = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler.Accept(_server);
+            _accepted = _conn.IsOpen();
+        };
+        _scheduler.Spawn(_take());
+        REQUIRE(_accepted);
+        REQUIRE(_scheduler.RunOnce(10) >= 0);
+
+        char _buff[16];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+    }
+
+    //  #### A connect that is never awaited closes its connection ####
+    {
+        TcpScheduler _scheduler;
+        {
+            TcpScheduler::ConnectAwaiter _unused = _scheduler.Connect(PORT + 1);
+        }
+        TcpClient _peer(_server.NextConnection());
+        REQUIRE(_peer.Send("data") == 4);
+        for (int i = 0; i < 5; i++)
+            REQUIRE(_scheduler.RunOnce(10) >= 0);
+        REQUIRE(_scheduler.Loop().ConnectionCount() == 0);
+
+        char _buff[16];
+        REQUIRE(_peer.Read(_buff, sizeof(_buff)) <= 0);
+    }
+
+    //  #### A read timeout closes the connection under the reader ####
+    {
+        TcpScheduler _scheduler;
+        int _result = 0;
+        int _error = 0;
+        bool _open = true;
+        auto _timed = [&]() -> Task<> {
+            AsyncConnection _conn = co_await _scheduler.Accept(_server);
+            _conn.Connection()->SetIdleTimeout(std::chrono::milliseconds(50));
+            char _buff[16];
+            _result = co_await _conn.Read(_buff, sizeof(_buff));
+            _error = _conn.ERR_NO();
+            _open = _conn.IsOpen();
+        };
+        _scheduler.Spawn(_timed());
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        REQUIRE(_scheduler.Run());
+        REQUIRE(_result == -1);
+        REQUIRE(_error == 13000 + ETIMEDOUT);
+        REQUIRE_FALSE(_open);
+    }
+
+    _server.Shutdown();
+}
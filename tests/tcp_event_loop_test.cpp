@@ -0,0 +1,513 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/tcp_client.h"
+#include "../src/tcp_event_loop.h"
+
+#include <thread>
+
+const int PORT = 51100;
+
+LogSettings LOG_SETTINGS;
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+    llog << "Logger initialised";
+}
+
+/**
+ * Run LOOP until CONDITION holds, or give up after a few seconds.
+ */
+template<typename Condition>
+bool RunUntil(TcpEventLoop& loop, Condition condition)
+{
+    for (int i = 0; i < 500 && !condition(); i++)
+        loop.RunOnce(10);
+    return condition();
+}
+
+TEST_CASE("Event loop echo server", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT));
+
+    TcpEventLoop _loop;
+    REQUIRE(_loop.Listen(_server));
+
+    int _accepted = 0;
+    int _closed = 0;
+    _loop.OnAccept([&](TcpConnection& conn) {
+        REQUIRE(conn.GetSocketFd() > -1);
+        _accepted++;
+    });
+    _loop.OnReadable([](TcpConnection& conn) {
+        char buff[4096];
+        int n;
+        while ((n = conn.Read(buff, sizeof(buff))) > 0)
+            conn.Send(buff, n);
+        if (n == 0 || !conn.WouldBlock())
+            conn.Close();
+    });
+    _loop.OnClose([&](TcpConnection&) { _closed++; });
+
+    //  #### Many connections on the one thread ####
+    const int _count = 200;
+    std::vector<std::unique_ptr<TcpClient>> _clients;
+    for (int i = 0; i < _count; i++) {
+        _clients.emplace_back(new TcpClient());
+        REQUIRE(_clients.back()->Connect(PORT));
+        //  Keep the server's small accept queue from filling
+        _loop.RunOnce(0);
+    }
+
+    REQUIRE(RunUntil(_loop, [&]() { return _accepted == _count; }));
+    REQUIRE(_loop.ConnectionCount() == static_cast<std::size_t>(_count));
+
+    for (int i = 0; i < _count; i++) {
+        const std::string _msg = "message " + std::to_string(i);
+        REQUIRE(_clients[i]->Send(_msg.c_str()) == static_cast<int>(_msg.size()));
+    }
+
+    REQUIRE(RunUntil(_loop, [&]() {
+        for (std::unique_ptr<TcpClient>& client : _clients) {
+            if (client->BytesAvailable() == 0)
+                return false;
+        }
+        return true;
+    }));
+
+    for (int i = 0; i < _count; i++) {
+        const std::string _msg = "message " + std::to_string(i);
+        char _buff[64];
+        REQUIRE(_clients[i]->Read(_buff, sizeof(_buff)) == static_cast<int>(_msg.size()));
+        REQUIRE(std::string(_buff, _msg.size()) == _msg);
+    }
+
+    //  #### Peer closes are seen and handled ####
+    for (int i = 0; i < _count / 2; i++)
+        _clients[i]->Close();
+
+    REQUIRE(RunUntil(_loop, [&]() { return _closed == _count / 2; }));
+    REQUIRE(_loop.ConnectionCount() == static_cast<std::size_t>(_count - _count / 2));
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Event loop handlers and stop", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT + 1));
+
+    //  #### Connections closed from the accept handler ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+
+        int _closed = 0;
+        _loop.OnAccept([](TcpConnection& conn) { conn.Close(); });
+        _loop.OnClose([&](TcpConnection&) { _closed++; });
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        REQUIRE(RunUntil(_loop, [&]() { return _closed == 1; }));
+        REQUIRE(_loop.ConnectionCount() == 0);
+
+        char _buff[16];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+    }
+
+    //  #### Writable is reported once a connection is added ####
+    {
+        std::unique_ptr<TcpEventLoop> _loop(new TcpEventLoop());
+        REQUIRE(_loop->Listen(_server));
+
+        int _writable = 0;
+        _loop->OnWritable([&](TcpConnection&) { _writable++; });
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        REQUIRE(RunUntil(*_loop, [&]() { return _writable == 1; }));
+
+        //  #### Remaining connections are closed with the loop ####
+        int _closed = 0;
+        _loop->OnClose([&](TcpConnection&) { _closed++; });
+        REQUIRE(_loop->ConnectionCount() == 1);
+        _loop.reset();
+        REQUIRE(_closed == 1);
+    }
+
+    //  #### Connection objects and read buffers are reused ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetReadBufferSize(BufferPool::SMALL_BUFFER_SIZE);
+        REQUIRE_THROWS_AS(_loop.SetReadBufferSize(BufferPool::LARGE_BUFFER_SIZE + 1), std::invalid_argument);
+
+        std::vector<TcpConnection*> _objects;
+        std::vector<char*> _buffers;
+        _loop.OnAccept([&](TcpConnection& conn) {
+            REQUIRE(conn.ReadBuffer().size() == BufferPool::SMALL_BUFFER_SIZE);
+            REQUIRE(conn.GetUserData() == nullptr);
+            conn.SetUserData(&_objects);
+            _objects.push_back(&conn);
+            _buffers.push_back(conn.ReadBuffer().data());
+        });
+        _loop.OnReadable([](TcpConnection& conn) {
+            IoBuffer& buff = conn.ReadBuffer();
+            int n;
+            while ((n = conn.Read(buff.data(), buff.size())) > 0) {}
+            if (n == 0 || !conn.WouldBlock())
+                conn.Close();
+        });
+
+        for (int i = 0; i < 3; i++) {
+            TcpClient _client;
+            REQUIRE(_client.Connect(PORT + 1));
+            REQUIRE(RunUntil(_loop, [&]() { return _objects.size() == static_cast<std::size_t>(i + 1); }));
+            _client.Close();
+            REQUIRE(RunUntil(_loop, [&]() { return _loop.ConnectionCount() == 0; }));
+        }
+
+        REQUIRE(_loop.ConnectionObjectCount() == 1);
+        REQUIRE(_objects[0] == _objects[2]);
+        REQUIRE(_buffers[0] == _buffers[2]);
+    }
+
+    //  #### Adopting a connected socket ####
+    {
+        TcpEventLoop _loop;
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+        TcpConnection* _conn = _loop.Adopt(_server.NextConnection());
+        REQUIRE(_conn != nullptr);
+        REQUIRE(_loop.ConnectionCount() == 1);
+
+        REQUIRE(_conn->Send("ping", 4) == 4);
+        char _buff[16];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 4);
+
+        REQUIRE(_conn->Read(_buff, sizeof(_buff)) == -1);
+        REQUIRE(_conn->WouldBlock());
+        REQUIRE(_conn->ERR_NO() == 0);
+    }
+
+    //  #### Stop from another thread ####
+    {
+        TcpEventLoop _loop;
+        std::thread _stopper([&]() {
+            usleep(50000);
+            _loop.Stop();
+        });
+        REQUIRE(_loop.Run());
+        _stopper.join();
+    }
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Event loop accept batches and overload", "[single-file]")
+{
+    TcpServer _server;
+    _server.SetMaximumQueueSize(1000000);
+    REQUIRE(_server.GetMaximumQueueSize() == TcpServer::MaximumQueueSizeLimit());
+    REQUIRE(_server.StartListening(PORT + 2));
+
+    //  #### One connection accepted per wakeup ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetAcceptBatchSize(1);
+
+        std::vector<std::unique_ptr<TcpClient>> _clients;
+        for (int i = 0; i < 4; i++) {
+            _clients.emplace_back(new TcpClient());
+            REQUIRE(_clients.back()->Connect(PORT + 2));
+        }
+
+        for (int i = 1; i <= 4; i++) {
+            _loop.RunOnce(1000);
+            REQUIRE(_loop.ConnectionCount() == static_cast<std::size_t>(i));
+        }
+    }
+
+    //  #### Connections beyond the limit are reset ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetConnectionLimit(2, TcpEventLoop::OverloadPolicy::reject);
+
+        std::vector<std::unique_ptr<TcpClient>> _clients;
+        for (int i = 0; i < 4; i++) {
+            _clients.emplace_back(new TcpClient());
+            REQUIRE(_clients.back()->Connect(PORT + 2));
+        }
+
+        REQUIRE(RunUntil(_loop, [&]() { return _loop.RejectedCount() == 2; }));
+        REQUIRE(_loop.ConnectionCount() == 2);
+
+        char _buff[16];
+        REQUIRE(_clients[2]->Read(_buff, sizeof(_buff)) == -1);
+        REQUIRE(_clients[2]->ERR_NO() == 13000 + ECONNRESET);
+    }
+
+    //  #### Connections beyond the limit wait in the queue ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetConnectionLimit(2, TcpEventLoop::OverloadPolicy::shed);
+
+        int _accepted = 0;
+        _loop.OnAccept([&](TcpConnection&) { _accepted++; });
+        _loop.OnReadable([](TcpConnection& conn) {
+            char buff[16];
+            if (conn.Read(buff, sizeof(buff)) == 0)
+                conn.Close();
+        });
+
+        std::vector<std::unique_ptr<TcpClient>> _clients;
+        for (int i = 0; i < 4; i++) {
+            _clients.emplace_back(new TcpClient());
+            REQUIRE(_clients.back()->Connect(PORT + 2));
+        }
+
+        for (int i = 0; i < 10; i++)
+            _loop.RunOnce(10);
+        REQUIRE(_accepted == 2);
+        REQUIRE(_loop.RejectedCount() == 0);
+
+        //  Room is made by closing connections, then the queue is drained
+        _clients[0]->Close();
+        _clients[1]->Close();
+        REQUIRE(RunUntil(_loop, [&]() { return _accepted == 4; }));
+        REQUIRE(_loop.ConnectionCount() == 2);
+    }
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Event loop write queues and watermarks", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT + 3));
+
+    //  #### A slow reader pauses writes and reads, and resumes them ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetWriteWatermarks(64 * 1024, 256 * 1024);
+
+        TcpConnection* _conn = nullptr;
+        int _readable = 0;
+        int _drained = 0;
+        std::string _received;
+        _loop.OnAccept([&](TcpConnection& conn) { _conn = &conn; });
+        _loop.OnReadable([&](TcpConnection& conn) {
+            _readable++;
+            char buff[64];
+            int n;
+            while ((n = conn.Read(buff, sizeof(buff))) > 0)
+                _received.append(buff, n);
+        });
+        _loop.OnDrain([&](TcpConnection& conn) {
+            REQUIRE_FALSE(conn.IsWritePaused());
+            REQUIRE(conn.QueuedBytes() <= 64 * 1024);
+            _drained++;
+        });
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 3));
+        REQUIRE(RunUntil(_loop, [&]() { return _conn != nullptr; }));
+
+        //  Write until the client's socket buffers are full and the queue
+        //  passes the high watermark
+        std::vector<char> _chunk(64 * 1024);
+        std::size_t _written = 0;
+        bool _accepted = true;
+        while (_accepted && _written < 256 * 1024 * 1024) {
+            for (std::size_t i = 0; i < _chunk.size(); i++)
+                _chunk[i] = static_cast<char>((_written + i) % 251);
+            _accepted = _conn->Write(_chunk.data(), _chunk.size());
+            _written += _chunk.size();
+        }
+        REQUIRE_FALSE(_accepted);
+        REQUIRE(_conn->IsWritePaused());
+        REQUIRE(_conn->QueuedBytes() > 256 * 1024);
+
+        //  Requests from a client not reading its responses are held back
+        REQUIRE(_client.Send("ping") == 4);
+        for (int i = 0; i < 10; i++)
+            _loop.RunOnce(10);
+        REQUIRE(_readable == 0);
+
+        std::size_t _read = 0;
+        bool _intact = true;
+        std::vector<char> _buff(64 * 1024);
+        REQUIRE(RunUntil(_loop, [&]() {
+            while (_client.BytesAvailable() > 0) {
+                const int _n = _client.Read(_buff.data(), _buff.size());
+                if (_n <= 0)
+                    break;
+                for (int i = 0; i < _n; i++)
+                    _intact = _intact && _buff[i] == static_cast<char>((_read + i) % 251);
+                _read += static_cast<std::size_t>(_n);
+            }
+            return _read == _written;
+        }));
+        REQUIRE(_intact);
+        REQUIRE(_conn->QueuedBytes() == 0);
+        REQUIRE(_drained == 1);
+        REQUIRE(_readable == 1);
+        REQUIRE(_received == "ping");
+    }
+
+    //  #### Closing one connection from another's handler ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+
+        std::vector<TcpConnection*> _conns;
+        int _closed = 0;
+        _loop.OnAccept([&](TcpConnection& conn) { _conns.push_back(&conn); });
+        _loop.OnReadable([&](TcpConnection& conn) {
+            char buff[16];
+            while (conn.Read(buff, sizeof(buff)) > 0) {}
+            for (TcpConnection* other : _conns) {
+                if (other != &conn)
+                    other->Close();
+            }
+        });
+        _loop.OnClose([&](TcpConnection&) { _closed++; });
+
+        TcpClient _first, _second;
+        REQUIRE(_first.Connect(PORT + 3));
+        REQUIRE(_second.Connect(PORT + 3));
+        REQUIRE(RunUntil(_loop, [&]() { return _conns.size() == 2; }));
+
+        REQUIRE(_first.Send("x") == 1);
+        REQUIRE(RunUntil(_loop, [&]() { return _closed == 1; }));
+        REQUIRE(_loop.ConnectionCount() == 1);
+        char _buff[16];
+        REQUIRE(_second.Read(_buff, sizeof(_buff)) == 0);
+    }
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Event loop timeouts", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT + 4));
+
+    //  #### Idle connections are closed, busy ones are not ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetIdleTimeout(std::chrono::milliseconds(200));
+
+        std::vector<int> _timedOut;
+        _loop.OnReadable([](TcpConnection& conn) {
+            char buff[16];
+            while (conn.Read(buff, sizeof(buff)) > 0) {}
+        });
+        _loop.OnClose([&](TcpConnection& conn) {
+            REQUIRE(conn.ERR_NO() == 13000 + ETIMEDOUT);
+            _timedOut.push_back(conn.GetSocketFd());
+        });
+
+        TcpClient _idle, _busy;
+        REQUIRE(_idle.Connect(PORT + 4));
+        REQUIRE(_busy.Connect(PORT + 4));
+        REQUIRE(RunUntil(_loop, [&]() { return _loop.ConnectionCount() == 2; }));
+        REQUIRE(_loop.Timers().TimerCount() == 2);
+
+        //  The busy client sends every 50 milliseconds for half a second
+        const auto _start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - _start < std::chrono::milliseconds(500)) {
+            REQUIRE(_busy.Send("x") == 1);
+            for (int i = 0; i < 5; i++)
+                _loop.RunOnce(10);
+        }
+        REQUIRE(_timedOut.size() == 1);
+        REQUIRE(_loop.ConnectionCount() == 1);
+        char _buff[16];
+        REQUIRE(_idle.Read(_buff, sizeof(_buff)) == 0);
+
+        //  Once it stops sending, it is closed too
+        REQUIRE(RunUntil(_loop, [&]() { return _timedOut.size() == 2; }));
+        REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(600));
+        REQUIRE(_loop.ConnectionCount() == 0);
+        REQUIRE(_loop.Timers().TimerCount() == 0);
+    }
+
+    //  #### Read deadlines close unless cleared in time ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+
+        int _closed = 0;
+        _loop.OnAccept([](TcpConnection& conn) { conn.SetReadDeadline(std::chrono::milliseconds(100)); });
+        _loop.OnReadable([](TcpConnection& conn) {
+            char buff[16];
+            int n;
+            while ((n = conn.Read(buff, sizeof(buff))) > 0) {
+                if (std::string(buff, n).find('\n') != std::string::npos)
+                    conn.SetReadDeadline(std::chrono::milliseconds(0));
+            }
+        });
+        _loop.OnClose([&](TcpConnection&) { _closed++; });
+
+        TcpClient _slow, _prompt;
+        REQUIRE(_slow.Connect(PORT + 4));
+        REQUIRE(_prompt.Connect(PORT + 4));
+        REQUIRE(RunUntil(_loop, [&]() { return _loop.ConnectionCount() == 2; }));
+        REQUIRE(_slow.Send("partial") == 7);
+        REQUIRE(_prompt.Send("whole\n") == 6);
+
+        REQUIRE(RunUntil(_loop, [&]() { return _closed == 1; }));
+        for (int i = 0; i < 20; i++)
+            _loop.RunOnce(10);
+        REQUIRE(_closed == 1);
+        REQUIRE(_loop.ConnectionCount() == 1);
+        char _buff[16];
+        REQUIRE(_slow.Read(_buff, sizeof(_buff)) == 0);
+    }
+
+    //  #### Write deadlines close while bytes are still queued ####
+    {
+        TcpEventLoop _loop;
+        REQUIRE(_loop.Listen(_server));
+        _loop.SetWriteWatermarks(64 * 1024, 256 * 1024);
+
+        TcpConnection* _conn = nullptr;
+        int _closed = 0;
+        _loop.OnAccept([&](TcpConnection& conn) { _conn = &conn; });
+        _loop.OnClose([&](TcpConnection& conn) {
+            REQUIRE(conn.ERR_NO() == 13000 + ETIMEDOUT);
+            _closed++;
+        });
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 4));
+        REQUIRE(RunUntil(_loop, [&]() { return _conn != nullptr; }));
+
+        //  A deadline with nothing queued passes quietly
+        _conn->SetWriteDeadline(std::chrono::milliseconds(50));
+        for (int i = 0; i < 10; i++)
+            _loop.RunOnce(10);
+        REQUIRE(_closed == 0);
+
+        //  A client that never reads does not drain the queue in time
+        std::vector<char> _chunk(64 * 1024, 'x');
+        while (_conn->Write(_chunk.data(), _chunk.size())) {}
+        REQUIRE(_conn->QueuedBytes() > 0);
+        _conn->SetWriteDeadline(std::chrono::milliseconds(100));
+        REQUIRE(RunUntil(_loop, [&]() { return _closed == 1; }));
+        REQUIRE(_loop.ConnectionCount() == 0);
+    }
+
+    _server.Shutdown();
+}
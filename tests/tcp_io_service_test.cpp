@@ -0,0 +1,297 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/tcp_client.h"
+#include "../src/tcp_io_service.h"
+
+#include <thread>
+
+const int PORT = 51400;
+
+LogSettings LOG_SETTINGS;
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+    llog << "Logger initialised";
+}
+
+/**
+ * Run SERVICE until CONDITION holds, or give up after a few seconds.
+ */
+template<typename Condition>
+bool RunUntil(TcpIoService& service, Condition condition)
+{
+    for (int i = 0; i < 500 && !condition(); i++)
+        service.RunOnce(10);
+    return condition();
+}
+
+/**
+ * The backends to test: always epoll, and io_uring where the kernel has it.
+ */
+std::vector<TcpIoService::Backend> Backends()
+{
+    std::vector<TcpIoService::Backend> backends = { TcpIoService::Backend::epoll };
+    if (TcpIoService::UringSupported())
+        backends.push_back(TcpIoService::Backend::io_uring);
+    else
+        wlog << "io_uring is not supported, only testing epoll.";
+    return backends;
+}
+
+TEST_CASE("IO service backend selection", "[single-file]")
+{
+    TcpIoService _automatic;
+    REQUIRE(_automatic.GetBackend() == (TcpIoService::UringSupported()
+        ? TcpIoService::Backend::io_uring : TcpIoService::Backend::epoll));
+
+    TcpIoService _epoll(TcpIoService::Backend::epoll);
+    REQUIRE(_epoll.GetBackend() == TcpIoService::Backend::epoll);
+}
+
+TEST_CASE("IO service echo server", "[single-file]")
+{
+    int _port = PORT;
+    for (const TcpIoService::Backend _backend : Backends()) {
+        TcpServer _server;
+        REQUIRE(_server.StartListening(_port));
+
+        TcpIoService _service(_backend);
+        REQUIRE(_service.GetBackend() == _backend);
+        REQUIRE(_service.Listen(_server));
+
+        int _accepted = 0;
+        int _closed = 0;
+        _service.OnAccept([&](IoConnection& conn) {
+            REQUIRE(conn.GetSocketFd() > -1);
+            REQUIRE(conn.GetUserData() == nullptr);
+            _accepted++;
+        });
+        _service.OnData([](IoConnection& conn, const char* data, std::size_t n) {
+            REQUIRE(conn.Send(data, n));
+        });
+        _service.OnClose([&](IoConnection& conn) {
+            REQUIRE(conn.IsClosing());
+            _closed++;
+        });
+
+        //  #### Many connections on the one thread ####
+        const int _count = 100;
+        std::vector<std::unique_ptr<TcpClient>> _clients;
+        for (int i = 0; i < _count; i++) {
+            _clients.emplace_back(new TcpClient());
+            REQUIRE(_clients.back()->Connect(_port));
+            //  Keep the server's small accept queue from filling
+            _service.RunOnce(0);
+        }
+
+        REQUIRE(RunUntil(_service, [&]() { return _accepted == _count; }));
+        REQUIRE(_service.ConnectionCount() == static_cast<std::size_t>(_count));
+
+        for (int i = 0; i < _count; i++) {
+            const std::string _msg = "message " + std::to_string(i);
+            REQUIRE(_clients[i]->Send(_msg.c_str()) == static_cast<int>(_msg.size()));
+        }
+
+        REQUIRE(RunUntil(_service, [&]() {
+            for (std::unique_ptr<TcpClient>& client : _clients) {
+                if (client->BytesAvailable() == 0)
+                    return false;
+            }
+            return true;
+        }));
+
+        for (int i = 0; i < _count; i++) {
+            const std::string _msg = "message " + std::to_string(i);
+            char _buff[64];
+            REQUIRE(_clients[i]->Read(_buff, sizeof(_buff)) == static_cast<int>(_msg.size()));
+            REQUIRE(std::string(_buff, _msg.size()) == _msg);
+        }
+
+        //  #### More than one receive buffer's worth ####
+        const std::string _large(TcpIoService::RECV_BUFFER_SIZE * 4 + 123, 'x');
+        std::thread _sender([&]() { _clients[0]->Send(_large.c_str()); });
+        std::string _echoed;
+        REQUIRE(RunUntil(_service, [&]() {
+            char _buff[8192];
+            while (_clients[0]->BytesAvailable() > 0) {
+                const int _n = _clients[0]->Read(_buff, sizeof(_buff));
+                if (_n <= 0)
+                    break;
+                _echoed.append(_buff, _n);
+            }
+            return _echoed.size() == _large.size();
+        }));
+        _sender.join();
+        REQUIRE(_echoed == _large);
+
+        //  #### Peer closes are seen and handled ####
+        for (int i = 0; i < _count / 2; i++)
+            _clients[i]->Close();
+
+        REQUIRE(RunUntil(_service, [&]() { return _closed == _count / 2; }));
+        REQUIRE(_service.ConnectionCount() == static_cast<std::size_t>(_count - _count / 2));
+
+        _server.Shutdown();
+        _port++;
+    }
+}
+
+TEST_CASE("IO service handlers and stop", "[single-file]")
+{
+    int _port = PORT + 10;
+    for (const TcpIoService::Backend _backend : Backends()) {
+        TcpServer _server;
+        REQUIRE(_server.StartListening(_port));
+
+        //  #### Connections closed from the accept handler ####
+        {
+            TcpIoService _service(_backend);
+            REQUIRE(_service.Listen(_server));
+
+            int _closed = 0;
+            _service.OnAccept([](IoConnection& conn) {
+                conn.Close();
+                REQUIRE(conn.IsClosing());
+                REQUIRE_FALSE(conn.Send("late", 4));
+            });
+            _service.OnClose([&](IoConnection&) { _closed++; });
+
+            TcpClient _client;
+            REQUIRE(_client.Connect(_port));
+            REQUIRE(RunUntil(_service, [&]() { return _closed == 1; }));
+            REQUIRE(_service.ConnectionCount() == 0);
+
+            char _buff[16];
+            REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+        }
+
+        //  #### A reply sent on accept, and closing after data ####
+        {
+            TcpIoService _service(_backend);
+            REQUIRE(_service.Listen(_server));
+
+            _service.OnAccept([](IoConnection& conn) { REQUIRE(conn.Send(std::string_view("hello"))); });
+            _service.OnData([](IoConnection& conn, const char*, std::size_t) { conn.Close(); });
+
+            TcpClient _client;
+            REQUIRE(_client.Connect(_port));
+            REQUIRE(RunUntil(_service, [&]() { return _client.BytesAvailable() == 5; }));
+            char _buff[16];
+            REQUIRE(_client.Read(_buff, sizeof(_buff)) == 5);
+            REQUIRE(std::string(_buff, 5) == "hello");
+
+            REQUIRE(_client.Send("bye") == 3);
+            REQUIRE(RunUntil(_service, [&]() { return _service.ConnectionCount() == 0; }));
+            REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+        }
+
+        //  #### Remaining connections are closed with the service ####
+        {
+            std::unique_ptr<TcpIoService> _service(new TcpIoService(_backend));
+            REQUIRE(_service->Listen(_server));
+
+            int _closed = 0;
+            _service->OnClose([&](IoConnection&) { _closed++; });
+
+            TcpClient _client;
+            REQUIRE(_client.Connect(_port));
+            REQUIRE(RunUntil(*_service, [&]() { return _service->ConnectionCount() == 1; }));
+            _service.reset();
+            REQUIRE(_closed == 1);
+
+            char _buff[16];
+            REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+        }
+
+        //  #### Stop from another thread ####
+        {
+            TcpIoService _service(_backend);
+            std::thread _stopper([&]() {
+                usleep(50000);
+                _service.Stop();
+            });
+            REQUIRE(_service.Run());
+            _stopper.join();
+        }
+
+        _server.Shutdown();
+        _port++;
+    }
+}
+
+TEST_CASE("IO service write watermarks", "[single-file]")
+{
+    int _port = PORT + 20;
+    for (const TcpIoService::Backend _backend : Backends()) {
+        TcpServer _server;
+        REQUIRE(_server.StartListening(_port));
+
+        TcpIoService _service(_backend);
+        REQUIRE(_service.Listen(_server));
+        _service.SetWriteWatermarks(64 * 1024, 256 * 1024);
+
+        IoConnection* _conn = nullptr;
+        int _drained = 0;
+        std::string _received;
+        _service.OnAccept([&](IoConnection& conn) { _conn = &conn; });
+        _service.OnData([&](IoConnection&, const char* data, std::size_t n) { _received.append(data, n); });
+        _service.OnDrain([&](IoConnection& conn) {
+            REQUIRE_FALSE(conn.IsWritePaused());
+            _drained++;
+        });
+
+        TcpClient _client;
+        REQUIRE(_client.Connect(_port));
+        REQUIRE(RunUntil(_service, [&]() { return _conn != nullptr; }));
+
+        //  #### A slow reader pauses sending and receiving ####
+        std::vector<char> _chunk(64 * 1024);
+        std::size_t _written = 0;
+        bool _accepted = true;
+        while (_accepted && _written < 256 * 1024 * 1024) {
+            for (std::size_t i = 0; i < _chunk.size(); i++)
+                _chunk[i] = static_cast<char>((_written + i) % 251);
+            _accepted = _conn->Send(_chunk.data(), _chunk.size());
+            _written += _chunk.size();
+            //  Let io_uring start sending before the queue fills
+            _service.RunOnce(0);
+        }
+        REQUIRE_FALSE(_accepted);
+        REQUIRE(_conn->IsWritePaused());
+        REQUIRE(_conn->PendingBytes() > 256 * 1024);
+
+        for (int i = 0; i < 10; i++)
+            _service.RunOnce(10);
+        REQUIRE(_client.Send("ping") == 4);
+        for (int i = 0; i < 10; i++)
+            _service.RunOnce(10);
+        REQUIRE(_received.empty());
+
+        //  #### Draining resumes both ####
+        std::size_t _read = 0;
+        bool _intact = true;
+        std::vector<char> _buff(64 * 1024);
+        REQUIRE(RunUntil(_service, [&]() {
+            while (_client.BytesAvailable() > 0) {
+                const int _n = _client.Read(_buff.data(), _buff.size());
+                if (_n <= 0)
+                    break;
+                for (int i = 0; i < _n; i++)
+                    _intact = _intact && _buff[i] == static_cast<char>((_read + i) % 251);
+                _read += static_cast<std::size_t>(_n);
+            }
+            return _read == _written && _received == "ping";
+        }));
+        REQUIRE(_intact);
+        REQUIRE(_conn->PendingBytes() == 0);
+        REQUIRE(_drained == 1);
+
+        _server.Shutdown();
+        _port++;
+    }
+}
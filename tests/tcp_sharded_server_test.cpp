@@ -0,0 +1,177 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/tcp_client.h"
+#include "../src/tcp_sharded_server.h"
+
+#include <sys/resource.h>
+#include <atomic>
+
+const int PORT = 51200;
+
+LogSettings LOG_SETTINGS;
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+    llog << "Logger initialised";
+}
+
+/**
+ * Set LOOP up as an echo server counting its connections in ACCEPTED.
+ */
+void EchoSetup(TcpEventLoop& loop, std::atomic<int>& accepted)
+{
+    loop.OnAccept([&accepted](TcpConnection&) { accepted++; });
+    loop.OnReadable([](TcpConnection& conn) {
+        char buff[1024];
+        int n;
+        while ((n = conn.Read(buff, sizeof(buff))) > 0)
+            conn.Send(buff, n);
+        if (n == 0 || !conn.WouldBlock())
+            conn.Close();
+    });
+}
+
+/**
+ * Connect COUNT clients to PORT_NUMBER and check each is echoed back.
+ */
+void EchoClients(const int portNumber, const int count)
+{
+    for (int i = 0; i < count; i++) {
+        TcpClient _client;
+        REQUIRE(_client.Connect(portNumber));
+
+        const std::string _msg = "worker message " + std::to_string(i);
+        REQUIRE(_client.Send(_msg.c_str()) == static_cast<int>(_msg.size()));
+
+        char _buff[64];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == static_cast<int>(_msg.size()));
+        REQUIRE(std::string(_buff, _msg.size()) == _msg);
+    }
+}
+
+TEST_CASE("Sharded server workers", "[single-file]")
+{
+    const int _count = 40;
+
+    //  #### Connections are served by the workers ####
+    {
+        std::atomic<int> _accepted[3] = { {0}, {0}, {0} };
+        TcpShardedServer _server(3);
+        REQUIRE(_server.WorkerCount() == 3);
+        REQUIRE(_server.StartListening(PORT, [&](TcpEventLoop& loop, std::size_t worker) {
+            EchoSetup(loop, _accepted[worker]);
+        }));
+
+        EchoClients(PORT, _count);
+        _server.Stop();
+
+        REQUIRE(_accepted[0] + _accepted[1] + _accepted[2] == _count);
+    }
+
+    //  #### Starting twice is a usage error ####
+    {
+        TcpShardedServer _server(2);
+        REQUIRE(_server.StartListening(PORT + 1, nullptr));
+        REQUIRE_FALSE(_server.StartListening(PORT + 1, nullptr));
+        REQUIRE(_server.ERR_NO() == 102);
+    }
+
+    //  #### Sockets without SO_REUSEPORT keep the port ####
+    {
+        TcpServer _plain;
+        REQUIRE(_plain.StartListening(PORT + 2));
+
+        TcpShardedServer _server(2);
+        REQUIRE_FALSE(_server.StartListening(PORT + 2, nullptr));
+        REQUIRE(_server.ERR_NO() / 1000 == 15);
+    }
+
+    //  #### A worker that cannot be created reports its own code ####
+    {
+        //  Room for the listening socket, but not the loop's descriptors
+        const int _next = dup(0);
+        close(_next);
+        rlimit _limit;
+        REQUIRE(getrlimit(RLIMIT_NOFILE, &_limit) == 0);
+        rlimit _lowered = _limit;
+        _lowered.rlim_cur = static_cast<rlim_t>(_next + 1);
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_lowered) == 0);
+
+        TcpShardedServer _server(1);
+        const bool _started = _server.StartListening(PORT + 4, nullptr);
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_limit) == 0);
+        REQUIRE_FALSE(_started);
+        REQUIRE(_server.ERR_NO() == 30000 + EMFILE);
+
+        //  With no room for the socket either, the server's constructor
+        //  throws its code
+        _lowered.rlim_cur = static_cast<rlim_t>(_next);
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_lowered) == 0);
+        int _thrown = 0;
+        try {
+            TcpServer _unusable;
+        }
+        catch (TcpError& err) {
+            _thrown = err.ERR_NO();
+        }
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_limit) == 0);
+        REQUIRE(_thrown == 10000 + EMFILE);
+    }
+}
+
+TEST_CASE("Sharded server CPU steering", "[single-file]")
+{
+    const int _count = 20;
+    std::atomic<int> _accepted[2] = { {0}, {0} };
+    std::atomic<int> _wrongCpu{0};
+
+    TcpShardedServer _server(2);
+    _server.SetCpuSteering(true);
+    REQUIRE(_server.StartListening(PORT + 3, [&](TcpEventLoop& loop, std::size_t worker) {
+        EchoSetup(loop, _accepted[worker]);
+        loop.OnWritable([&_wrongCpu](TcpConnection&) {
+            cpu_set_t _set;
+            if (sched_getaffinity(0, sizeof(_set), &_set) != 0 || CPU_COUNT(&_set) != 1
+                || !CPU_ISSET(sched_getcpu(), &_set))
+                _wrongCpu++;
+        });
+    }));
+
+    EchoClients(PORT + 3, _count);
+    _server.Stop();
+
+    REQUIRE(_accepted[0] + _accepted[1] == _count);
+    //  Every worker only ever ran on the one CPU it was pinned to
+    REQUIRE(_wrongCpu == 0);
+
+    //  #### A table sends each CPU's connections to the socket it names ####
+    {
+        TcpServer _first;
+        TcpServer _second;
+        _first.SetNonBlocking();
+        _second.SetNonBlocking();
+        REQUIRE(_first.SetReusePort());
+        REQUIRE(_first.StartListening(PORT + 5));
+        REQUIRE(_second.SetReusePort());
+        REQUIRE(_second.StartListening(PORT + 5));
+        const std::vector<unsigned int> _table(std::max(1u, std::thread::hardware_concurrency()), 1);
+        REQUIRE(_first.AttachCpuSteering(_table));
+
+        std::vector<std::unique_ptr<TcpClient>> _clients;
+        for (int i = 0; i < 5; i++) {
+            _clients.emplace_back(new TcpClient());
+            REQUIRE(_clients.back()->Connect(PORT + 5));
+        }
+
+        std::vector<int> _fds;
+        REQUIRE(_first.NextConnections(_fds, 10) == 0);
+        REQUIRE(_second.NextConnections(_fds, 10) == 5);
+        for (const int fd : _fds)
+            close(fd);
+    }
+}
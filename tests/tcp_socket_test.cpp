@@ -87,3 +87,155 @@ TEST_CASE("Send data across a server and socket object", "[single=file]")
 
     REQUIRE(strcmp(output_buffer, server_msg.c_str()) == 0);
 }
+
+TEST_CASE("Accept a batch of connections", "[single-file]")
+{
+    TcpServer _server;
+    _server.SetMaximumQueueSize(0);
+    REQUIRE(_server.GetMaximumQueueSize() == 1);
+    _server.SetMaximumQueueSize(64);
+    REQUIRE(_server.StartListening(PORT + 1));
+
+    TcpClient _clients[5];
+    for (TcpClient& client : _clients)
+        REQUIRE(client.Connect(PORT + 1));
+
+    //  #### Blocking socket, only queued connections after the first ####
+    std::vector<int> _fds;
+    REQUIRE(_server.NextConnections(_fds, 3) == 3);
+    REQUIRE(_server.NextConnections(_fds, 10) == 2);
+    REQUIRE(_fds.size() == 5);
+    for (int fd : _fds) {
+        REQUIRE((fcntl(fd, F_GETFL, 0) & O_NONBLOCK) != 0);
+        REQUIRE((fcntl(fd, F_GETFD, 0) & FD_CLOEXEC) != 0);
+        close(fd);
+    }
+
+    //  #### Non-blocking socket with an empty queue ####
+    _server.SetNonBlocking();
+    REQUIRE(_server.NextConnections(_fds, 10) == 0);
+    REQUIRE(_server.ERR_NO() == 0);
+
+    _server.Shutdown();
+}
+
+TEST_CASE("Client read and send timeouts", "[single-file]")
+{
+    TcpServer _server;
+    REQUIRE(_server.StartListening(PORT + 2));
+
+    TcpClient _client;
+    REQUIRE(_client.SetReadTimeout(100));
+    REQUIRE(_client.SetSendTimeout(100));
+    REQUIRE(_client.Connect(PORT + 2));
+    const int _fd = _server.NextConnection();
+    REQUIRE(_fd > -1);
+
+    //  #### A read with nothing to read gives up ####
+    char _buff[16];
+    const auto _start = std::chrono::steady_clock::now();
+    REQUIRE(_client.Read(_buff, sizeof(_buff)) == -1);
+    REQUIRE(_client.ERR_NO() == 13000 + EAGAIN);
+    REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(90));
+
+    //  #### Bytes that arrive in time are read ####
+    REQUIRE(send(_fd, "hello", 5, 0) == 5);
+    REQUIRE(_client.Read(_buff, sizeof(_buff)) == 5);
+    REQUIRE(_client.ERR_NO() == 0);
+
+    //  #### Without a timeout, reads wait again ####
+    REQUIRE(_client.SetReadTimeout(0));
+
+    TcpClient _closed;
+    _closed.Close();
+    REQUIRE_FALSE(_closed.SetReadTimeout(100));
+    REQUIRE(_closed.ERR_NO() == 101);
+
+    close(_fd);
+    _server.Shutdown();
+}
+
+TEST_CASE("Local socket transport", "[single-file]")
+{
+    const std::string _path = "/tmp/tcp_socket_test_" + std::to_string(getpid()) + ".sock";
+    const std::string _abstract = "@tcp_socket_test_" + std::to_string(getpid());
+
+    //  #### The same calls serve a filesystem and an abstract socket ####
+    for (const std::string& _endpoint : { _path, _abstract }) {
+        TcpServer _server(TcpServer::InternetProtocol::local);
+        REQUIRE(_server.GetProtocol() == TcpServer::InternetProtocol::local);
+        REQUIRE(_server.StartListening(_endpoint.c_str()));
+        REQUIRE(access(_path.c_str(), F_OK) == (_endpoint == _path ? 0 : -1));
+
+        TcpClient _client(TcpClient::InternetProtocol::local);
+        REQUIRE(_client.Connect(_endpoint.c_str()));
+        TcpClient _accepted(_server.NextConnection());
+        REQUIRE(_accepted.GetSocketFd() > -1);
+
+        char _buff[16];
+        REQUIRE(_client.Send("hello") == 5);
+        REQUIRE(_accepted.Read(_buff, sizeof(_buff)) == 5);
+        REQUIRE(std::string(_buff, 5) == "hello");
+        REQUIRE(_accepted.Send("world") == 5);
+        REQUIRE(_client.BytesAvailable() == 5);
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 5);
+        REQUIRE(std::string(_buff, 5) == "world");
+
+        _client.Close();
+        REQUIRE(_accepted.Read(_buff, sizeof(_buff)) == 0);
+        _server.Shutdown();
+        REQUIRE(access(_path.c_str(), F_OK) == -1);
+    }
+
+    //  #### A socket file left behind is replaced, anything else is not ####
+    {
+        TcpServer _first(TcpServer::InternetProtocol::local);
+        REQUIRE(_first.StartListening(_path.c_str()));
+        TcpServer _taken(TcpServer::InternetProtocol::local);
+        REQUIRE_FALSE(_taken.StartListening(_path.c_str()));
+        REQUIRE(_taken.ERR_NO() == 15000 + EADDRINUSE);
+
+        _first.Shutdown();
+
+        //  A socket closed without removing its file, as a crash would
+        sockaddr_un _address{};
+        _address.sun_family = AF_UNIX;
+        strcpy(_address.sun_path, _path.c_str());
+        const int _crashed = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(bind(_crashed, (sockaddr*) &_address, sizeof(_address)) == 0);
+        close(_crashed);
+        REQUIRE(access(_path.c_str(), F_OK) == 0);
+        TcpServer _restarted(TcpServer::InternetProtocol::local);
+        REQUIRE(_restarted.StartListening(_path.c_str()));
+        TcpClient _client(TcpClient::InternetProtocol::local);
+        REQUIRE(_client.Connect(_path.c_str()));
+        _restarted.Shutdown();
+
+        std::ofstream(_path) << "not a socket";
+        TcpServer _blocked(TcpServer::InternetProtocol::local);
+        REQUIRE_FALSE(_blocked.StartListening(_path.c_str()));
+        REQUIRE(_blocked.ERR_NO() == 15000 + EADDRINUSE);
+        unlink(_path.c_str());
+    }
+
+    //  #### Ports and paths are not mixed up ####
+    TcpServer _local(TcpServer::InternetProtocol::local);
+    REQUIRE_FALSE(_local.StartListening(PORT + 3));
+    REQUIRE(_local.ERR_NO() == 102);
+    REQUIRE_FALSE(_local.StartListening(std::string(200, 'x').c_str()));
+    REQUIRE(_local.ERR_NO() == 15000 + ENAMETOOLONG);
+    TcpServer _tcp;
+    REQUIRE_FALSE(_tcp.StartListening(_path.c_str()));
+    REQUIRE(_tcp.ERR_NO() == 102);
+
+    TcpClient _localClient(TcpClient::InternetProtocol::local);
+    REQUIRE_FALSE(_localClient.Connect(PORT));
+    REQUIRE(_localClient.ERR_NO() == 102);
+    REQUIRE_FALSE(_localClient.Connect(std::string(200, 'x').c_str()));
+    REQUIRE(_localClient.ERR_NO() == 11000 + ENAMETOOLONG);
+    REQUIRE_FALSE(_localClient.Connect(_path.c_str()));
+    REQUIRE(_localClient.ERR_NO() == 12000 + ENOENT);
+    TcpClient _tcpClient;
+    REQUIRE_FALSE(_tcpClient.Connect(_path.c_str()));
+    REQUIRE(_tcpClient.ERR_NO() == 102);
+}
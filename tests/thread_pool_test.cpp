@@ -0,0 +1,219 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/tcp_client.h"
+#include "../src/tcp_server.h"
+#include "../src/thread_pool.h"
+
+#include <sys/resource.h>
+#include <future>
+
+const int PORT = 51300;
+
+LogSettings LOG_SETTINGS;
+
+//  THIS TEST CASE MUST BE FIRST
+TEST_CASE("Initialise Logger", "[single-file]")
+{
+    LOG_SETTINGS.ls_print_to_file = false;
+    LOG_SETTINGS.ls_selected_level = LogType::LT_INFO;
+    TestLogInit;
+    llog << "Logger initialised";
+}
+
+/**
+ * Count the leaves of a binary tree of DEPTH, one task per node, so every
+ * task submits its children from a worker.
+ */
+void CountLeaves(ThreadPool& pool, std::atomic<int>& leaves, const int depth)
+{
+    if (depth == 0) {
+        leaves++;
+        return;
+    }
+    pool.Submit([&pool, &leaves, depth]() { CountLeaves(pool, leaves, depth - 1); });
+    pool.Submit([&pool, &leaves, depth]() { CountLeaves(pool, leaves, depth - 1); });
+}
+
+TEST_CASE("Thread pool tasks", "[single-file]")
+{
+    //  #### Tasks from outside the pool ####
+    {
+        ThreadPool _pool(4);
+        REQUIRE(_pool.WorkerCount() == 4);
+        REQUIRE(ThreadPool::CurrentWorker() == -1);
+
+        std::atomic<long> _sum{0};
+        std::atomic<int> _outside{0};
+        for (int i = 1; i <= 10000; i++) {
+            REQUIRE(_pool.Submit([&_sum, &_outside, i]() {
+                _sum += i;
+                if (ThreadPool::CurrentWorker() < 0)
+                    _outside++;
+            }));
+        }
+        _pool.WaitIdle();
+        REQUIRE(_sum == 50005000);
+        REQUIRE(_outside == 0);
+    }
+
+    //  #### Tasks that submit tasks all run ####
+    {
+        ThreadPool _pool(4, true);
+        std::atomic<int> _leaves{0};
+        _pool.Submit([&]() { CountLeaves(_pool, _leaves, 12); });
+        _pool.WaitIdle();
+        REQUIRE(_leaves == 4096);
+    }
+
+    //  #### A blocked worker's tasks are stolen ####
+    {
+        //  The parent waits on its worker until the child it queued there has
+        //  run, which only another worker stealing it can do
+        ThreadPool _pool(2);
+        std::promise<void> _childRan;
+        std::atomic<int> _parentWorker{-1};
+        std::atomic<int> _childWorker{-1};
+        std::atomic<bool> _unblocked{false};
+        _pool.Submit([&]() {
+            _parentWorker = ThreadPool::CurrentWorker();
+            _pool.Submit([&]() {
+                _childWorker = ThreadPool::CurrentWorker();
+                _childRan.set_value();
+            });
+            _unblocked = (_childRan.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        });
+        _pool.WaitIdle();
+        REQUIRE(_unblocked);
+        REQUIRE(_childWorker != _parentWorker);
+        REQUIRE(_pool.StolenCount() > 0);
+    }
+
+    //  #### Exceptions do not stop the worker ####
+    {
+        ThreadPool _pool(1);
+        std::atomic<int> _ran{0};
+        _pool.Submit([]() { throw std::runtime_error("task failed"); });
+        _pool.Submit([&]() { _ran++; });
+        _pool.WaitIdle();
+        REQUIRE(_ran == 1);
+    }
+
+    //  #### Stopping runs the queued tasks first ####
+    {
+        std::atomic<int> _ran{0};
+        ThreadPool _pool(2);
+        for (int i = 0; i < 100; i++)
+            _pool.Submit([&]() { _ran++; });
+        _pool.Stop();
+        REQUIRE(_ran == 100);
+        REQUIRE_FALSE(_pool.Submit([&]() { _ran++; }));
+    }
+}
+
+TEST_CASE("Dispatch connections onto a thread pool", "[single-file]")
+{
+    TcpServer _server;
+    _server.SetMaximumQueueSize(64);
+    REQUIRE(_server.StartListening(PORT));
+
+    ThreadPool _pool(4);
+    std::atomic<int> _handled{0};
+    std::size_t _dispatched = 0;
+    std::thread _acceptor([&]() {
+        _dispatched = _server.DispatchConnections(_pool, [&_handled](int fd) {
+            //  The handler is a plain blocking one, so make the socket blocking
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+            TcpClient connection(fd);
+            char buff[64];
+            const int n = connection.Read(buff, sizeof(buff));
+            if (n > 0)
+                connection.Send(buff, n);
+            _handled++;
+        });
+    });
+
+    const int _count = 20;
+    for (int i = 0; i < _count; i++) {
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT));
+        const std::string _msg = "request " + std::to_string(i);
+        REQUIRE(_client.Send(_msg.c_str()) == static_cast<int>(_msg.size()));
+
+        char _buff[64];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == static_cast<int>(_msg.size()));
+        REQUIRE(std::string(_buff, _msg.size()) == _msg);
+    }
+
+    _server.Shutdown();
+    _acceptor.join();
+    _pool.WaitIdle();
+    REQUIRE(_dispatched == static_cast<std::size_t>(_count));
+    REQUIRE(_handled == _count);
+
+    //  #### A pool that refuses the connection stops dispatching ####
+    {
+        TcpServer _refusing;
+        REQUIRE(_refusing.StartListening(PORT + 1));
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 1));
+
+        ThreadPool _stopped(1);
+        _stopped.Stop();
+        REQUIRE(_refusing.DispatchConnections(_stopped, [](int fd) { close(fd); }) == 0);
+        REQUIRE(_refusing.ERR_NO() == 103);
+
+        char _buff[8];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 0);
+        _refusing.Shutdown();
+    }
+
+    //  #### Running out of descriptors pauses dispatching until there are some ####
+    {
+        TcpServer _limited;
+        REQUIRE(_limited.StartListening(PORT + 2));
+        TcpClient _client;
+        REQUIRE(_client.Connect(PORT + 2));
+        REQUIRE(_client.SetReadTimeout(5000));
+        REQUIRE(_client.Send("again") == 5);
+
+        //  No room for the accepted socket
+        const int _next = dup(0);
+        close(_next);
+        rlimit _limit;
+        REQUIRE(getrlimit(RLIMIT_NOFILE, &_limit) == 0);
+        rlimit _lowered = _limit;
+        _lowered.rlim_cur = static_cast<rlim_t>(_next);
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_lowered) == 0);
+
+        ThreadPool _echoPool(1);
+        std::atomic<int> _echoed{0};
+        std::size_t _limitedDispatched = 0;
+        std::thread _limitedAcceptor([&]() {
+            _limitedDispatched = _limited.DispatchConnections(_echoPool, [&_echoed](int fd) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+                TcpClient connection(fd);
+                char buff[64];
+                const int n = connection.Read(buff, sizeof(buff));
+                if (n > 0)
+                    connection.Send(buff, n);
+                _echoed++;
+            });
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const int _echoedWhileLimited = _echoed;
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &_limit) == 0);
+        REQUIRE(_echoedWhileLimited == 0);
+
+        char _buff[8];
+        REQUIRE(_client.Read(_buff, sizeof(_buff)) == 5);
+        REQUIRE(std::string(_buff, 5) == "again");
+
+        _limited.Shutdown();
+        _limitedAcceptor.join();
+        _echoPool.WaitIdle();
+        REQUIRE(_limitedDispatched == 1);
+        REQUIRE(_echoed == 1);
+    }
+}
@@ -0,0 +1,179 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/timing_wheel.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Advance WHEEL until CONDITION holds, or give up after LIMIT.
+ */
+template<typename Condition>
+bool AdvanceUntil(TimingWheel& wheel, Condition condition,
+    const std::chrono::milliseconds limit = std::chrono::seconds(5))
+{
+    const auto until = std::chrono::steady_clock::now() + limit;
+    while (!condition() && std::chrono::steady_clock::now() < until) {
+        const int next = wheel.NextTimeout();
+        std::this_thread::sleep_for(std::chrono::milliseconds(next >= 0 && next < 5 ? next : 5));
+        wheel.Advance();
+    }
+    return condition();
+}
+
+TEST_CASE("Timing wheel arm and cancel", "[single-file]")
+{
+    TimingWheel _wheel(1);
+    REQUIRE(_wheel.Tick() == std::chrono::milliseconds(1));
+    REQUIRE(_wheel.TimerCount() == 0);
+    REQUIRE(_wheel.NextTimeout() == -1);
+    REQUIRE(_wheel.Advance() == 0);
+
+    //  #### Timers fire once, in order, and never early ####
+    std::vector<int> _fired;
+    WheelTimer _first([&]() { _fired.push_back(1); });
+    WheelTimer _second([&]() { _fired.push_back(2); });
+    WheelTimer _cancelled([&]() { _fired.push_back(3); });
+
+    const auto _start = std::chrono::steady_clock::now();
+    _wheel.Arm(_second, std::chrono::milliseconds(40));
+    _wheel.Arm(_first, std::chrono::milliseconds(20));
+    _wheel.Arm(_cancelled, std::chrono::milliseconds(30));
+    REQUIRE(_wheel.TimerCount() == 3);
+    REQUIRE(_first.IsArmed());
+    REQUIRE(_wheel.NextTimeout() >= 0);
+    //  Counted from the clock, so the part of a tick already gone is a tick
+    //  more to wait
+    REQUIRE(_wheel.NextTimeout() <= 21);
+
+    _wheel.Cancel(_cancelled);
+    REQUIRE_FALSE(_cancelled.IsArmed());
+    REQUIRE(_wheel.TimerCount() == 2);
+    _wheel.Cancel(_cancelled);
+    REQUIRE(_wheel.TimerCount() == 2);
+
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _fired.size() == 1; }));
+    REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(20));
+    REQUIRE(_fired[0] == 1);
+    REQUIRE_FALSE(_first.IsArmed());
+
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _fired.size() == 2; }));
+    REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(40));
+    REQUIRE(_fired[1] == 2);
+    REQUIRE(_wheel.TimerCount() == 0);
+    REQUIRE(_wheel.NextTimeout() == -1);
+
+    //  #### A timer armed while the wheel lags the clock is not early ####
+    {
+        WheelTimer _holder;
+        _wheel.Arm(_holder, std::chrono::seconds(60));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        std::chrono::steady_clock::time_point _firedAt;
+        WheelTimer _timer([&]() { _firedAt = std::chrono::steady_clock::now(); });
+        const auto _armed = std::chrono::steady_clock::now();
+        _wheel.Arm(_timer, std::chrono::milliseconds(20));
+        REQUIRE(AdvanceUntil(_wheel, [&]() { return !_timer.IsArmed(); }));
+        REQUIRE(_firedAt - _armed >= std::chrono::milliseconds(20));
+        _wheel.Cancel(_holder);
+        REQUIRE(_wheel.TimerCount() == 0);
+    }
+
+    //  #### Re-arming moves a timer rather than adding it twice ####
+    _wheel.Arm(_first, std::chrono::seconds(60));
+    _wheel.Arm(_first, std::chrono::milliseconds(5));
+    REQUIRE(_wheel.TimerCount() == 1);
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _fired.size() == 3; }));
+    REQUIRE(_fired[2] == 1);
+
+    //  #### A destroyed timer leaves the wheel ####
+    {
+        WheelTimer _scoped([&]() { _fired.push_back(4); });
+        _wheel.Arm(_scoped, std::chrono::milliseconds(5));
+        REQUIRE(_wheel.TimerCount() == 1);
+    }
+    REQUIRE(_wheel.TimerCount() == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(_wheel.Advance() == 0);
+    REQUIRE(_fired.size() == 3);
+}
+
+TEST_CASE("Timing wheel callbacks", "[single-file]")
+{
+    TimingWheel _wheel(1);
+
+    //  #### A timer re-arms itself from its own callback ####
+    int _ticks = 0;
+    WheelTimer _periodic;
+    _periodic.SetCallback([&]() {
+        if (++_ticks < 3)
+            _wheel.Arm(_periodic, std::chrono::milliseconds(2));
+    });
+    _wheel.Arm(_periodic, std::chrono::milliseconds(2));
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _ticks == 3; }));
+    REQUIRE_FALSE(_periodic.IsArmed());
+
+    //  #### A callback cancels a timer due on the same tick ####
+    int _fired = 0;
+    WheelTimer _victim([&]() { _fired++; });
+    WheelTimer _killer([&]() {
+        _fired++;
+        _wheel.Cancel(_victim);
+    });
+    _wheel.Arm(_killer, std::chrono::milliseconds(3));
+    _wheel.Arm(_victim, std::chrono::milliseconds(3));
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _wheel.TimerCount() == 0; }));
+    REQUIRE(_fired == 1);
+
+    //  #### Destroying the wheel disarms what is left ####
+    std::unique_ptr<TimingWheel> _owned(new TimingWheel());
+    WheelTimer _left;
+    _owned->Arm(_left, std::chrono::minutes(1));
+    REQUIRE(_left.IsArmed());
+    _owned.reset();
+    REQUIRE_FALSE(_left.IsArmed());
+}
+
+TEST_CASE("Timing wheel levels", "[single-file]")
+{
+    //  #### Timers on every level cascade down and fire in order ####
+    TimingWheel _wheel(1);
+    std::vector<int> _order;
+    const int _delays[] = { 3, 70, 300, 5000 };
+    std::vector<std::unique_ptr<WheelTimer>> _timers;
+    for (int i = 3; i >= 0; i--) {
+        _timers.emplace_back(new WheelTimer([&, i]() { _order.push_back(i); }));
+        _wheel.Arm(*_timers.back(), std::chrono::milliseconds(_delays[i]));
+    }
+    REQUIRE(_wheel.TimerCount() == 4);
+
+    const auto _start = std::chrono::steady_clock::now();
+    REQUIRE(AdvanceUntil(_wheel, [&]() { return _order.size() == 4; }, std::chrono::seconds(10)));
+    REQUIRE(std::chrono::steady_clock::now() - _start >= std::chrono::milliseconds(4990));
+    REQUIRE(_order == std::vector<int>({ 0, 1, 2, 3 }));
+
+    //  #### Beyond the top level's span is held until it comes round ####
+    TimingWheel _coarse;
+    WheelTimer _distant;
+    _coarse.Arm(_distant, std::chrono::hours(24 * 365));
+    REQUIRE(_coarse.TimerCount() == 1);
+    REQUIRE(_coarse.NextTimeout() > 0);
+    REQUIRE(_coarse.NextTimeout() <= 640);
+    REQUIRE(_coarse.Advance() == 0);
+
+    //  #### Many timers arm, cancel and fire ####
+    TimingWheel _busy(1);
+    std::size_t _count = 0;
+    std::vector<std::unique_ptr<WheelTimer>> _many;
+    for (int i = 0; i < 10000; i++) {
+        _many.emplace_back(new WheelTimer([&]() { _count++; }));
+        _busy.Arm(*_many.back(), std::chrono::milliseconds(1 + i % 200));
+    }
+    for (int i = 0; i < 10000; i += 2)
+        _busy.Cancel(*_many[i]);
+    REQUIRE(_busy.TimerCount() == 5000);
+    REQUIRE(AdvanceUntil(_busy, [&]() { return _busy.TimerCount() == 0; }));
+    REQUIRE(_count == 5000);
+}
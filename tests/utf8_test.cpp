@@ -0,0 +1,111 @@
+#define CATCH_CONFIG_MAIN
+
+#include "../src/catch2/catch.hpp"
+#include "../src/string.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Encode CODEPOINT as UTF-8, for building test input.
+ */
+std::string Encode(const char32_t codePoint)
+{
+    std::string out;
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    return out;
+}
+
+TEST_CASE("UTF-8 validation tests", "[single-file]")
+{
+    //  #################### valid input ####################
+
+    REQUIRE(Utf8::is_valid("", 0));
+    REQUIRE(String("plain ascii that is longer than one sixteen byte block").is_valid_utf8());
+    REQUIRE(String("{\"name\": \"Zo\xC3\xAB\", \"city\": \"\xE6\x9D\xB1\xE4\xBA\xAC\", \"emoji\": \"\xF0\x9F\x98\x80\"}").is_valid_utf8());
+
+    //  Every scalar value round trips, in blocks so the fast path is crossed
+    std::string _all;
+    for (char32_t _cp = 0; _cp <= 0x10FFFF; _cp++) {
+        if (_cp >= 0xD800 && _cp <= 0xDFFF) continue;
+        const std::string _encoded = Encode(_cp);
+        REQUIRE(Utf8::is_valid(_encoded.data(), _encoded.size()));
+        _all += _encoded;
+        if (_cp % 0x1000 == 0) _all += "sixteen ascii bytes.";
+    }
+    REQUIRE(Utf8::is_valid(_all.data(), _all.size()));
+
+    //  #################### invalid input ####################
+
+    const std::vector<std::string> _invalid = {
+        "\x80",                     //  lone continuation
+        "\xC0\xAF",                 //  overlong '/'
+        "\xC1\xBF",                 //  overlong
+        "\xE0\x80\xAF",             //  overlong 3 byte
+        "\xED\xA0\x80",             //  surrogate U+D800
+        "\xF0\x8F\xBF\xBF",         //  overlong 4 byte
+        "\xF4\x90\x80\x80",         //  above U+10FFFF
+        "\xF5\x80\x80\x80",         //  invalid lead
+        "\xFF",
+        "\xC3",                     //  truncated
+        "\xE6\x9D",                 //  truncated
+        "\xC3\x41",                 //  missing continuation
+    };
+    for (const std::string& _bytes : _invalid) {
+        REQUIRE_FALSE(Utf8::is_valid(_bytes.data(), _bytes.size()));
+        const std::string _padded = std::string(37, 'a') + _bytes + std::string(20, 'b');
+        REQUIRE(Utf8::find_invalid(_padded.data(), _padded.size()) == 37);
+    }
+
+    String _body = "valid \xC3\xAB then \xED\xA0\x80";
+    REQUIRE_FALSE(_body.is_valid_utf8());
+    REQUIRE(_body.find_invalid_utf8() == 14);
+}
+
+TEST_CASE("UTF-8 code point tests", "[single-file]")
+{
+    //  #################### code_point_count ####################
+
+    String _text = "a\xC3\xAB\xE6\x9D\xB1\xF0\x9F\x98\x80z";
+    REQUIRE(_text.size() == 11);
+    REQUIRE(_text.code_point_count() == 5);
+
+    std::string _long;
+    for (int i = 0; i < 50; i++) _long += "\xE6\x9D\xB1x";
+    REQUIRE(Utf8::count(_long.data(), _long.size()) == 100);
+
+    //  #################### code_points ####################
+
+    std::vector<char32_t> _decoded;
+    for (char32_t _cp : _text.code_points()) _decoded.push_back(_cp);
+    REQUIRE(_decoded == std::vector<char32_t>{ U'a', 0xEB, 0x6771, 0x1F600, U'z' });
+
+    //  Ill-formed sequences give U+FFFD and decoding carries on after them
+    String _bad = "a\xE6\x9D" "b\x80" "c\xF0\x9F\x98";
+    _decoded.clear();
+    for (char32_t _cp : _bad.code_points()) _decoded.push_back(_cp);
+    REQUIRE(_decoded == std::vector<char32_t>{ U'a', 0xFFFD, U'b', 0xFFFD, U'c', 0xFFFD });
+
+    String _empty;
+    REQUIRE(_empty.code_points().begin() == _empty.code_points().end());
+
+    char32_t _cp = 0;
+    const std::string _euro = "\xE2\x82\xAC";
+    const char* _next = Utf8::decode(_euro.data(), _euro.data() + _euro.size(), _cp);
+    REQUIRE(_cp == 0x20AC);
+    REQUIRE(_next == _euro.data() + 3);
+}